@@ -0,0 +1,173 @@
+// Loudness analysis benchmark
+//
+// Checks the meter against the EBU Tech 3341 test signals (1 kHz stereo
+// sines whose integrated loudness is known), then writes a long WAV file
+// and measures it the way a custom sound is analyzed: decoded, converted
+// to the output format and metered block by block. Reports the speed and
+// how much the process's peak memory grew, which should not depend on the
+// length of the file.
+//
+// Usage: bench_loudness [minutes]
+
+#define _GNU_SOURCE
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include "loudness_meter.h"
+#include "sound_decoder.h"
+#include "wav_file.h"
+
+#define RATE 48000
+#define OUTPUT_RATE 44100
+#define BLOCK_FRAMES 4800
+
+typedef struct {
+    double level_db;        // dBFS per channel
+    double seconds;
+} Segment;
+
+typedef struct {
+    const char *name;
+    double expected;
+    Segment segments[5];
+    int count;
+} TestSignal;
+
+static const TestSignal tests[] = {
+    {"3341 #1: -23 dBFS", -23.0, {{-23, 20}}, 1},
+    {"3341 #2: -33 dBFS", -33.0, {{-33, 20}}, 1},
+    {"3341 #3: relative gate", -23.0, {{-36, 10}, {-23, 60}, {-36, 10}}, 3},
+    {"3341 #4: both gates", -23.0, {{-72, 10}, {-36, 10}, {-23, 60}, {-36, 10}, {-72, 10}}, 5},
+    {"200 ms chime, -20 dBFS", -20.0, {{-20, 0.2}}, 1}
+};
+
+static long max_rss_kb(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Stereo 1 kHz sine, both channels alike, continuing the phase
+static void fill_sine(float *out, gsize frames, double level_db, guint64 position) {
+    double amplitude = pow(10.0, level_db / 20.0);
+    for (gsize i = 0; i < frames; i++) {
+        float value = (float)(amplitude * sin(2.0 * G_PI * 1000.0 * (position + i) / RATE));
+        out[i * 2] = value;
+        out[i * 2 + 1] = value;
+    }
+}
+
+static void bench_accuracy(void) {
+    float *block = g_malloc(BLOCK_FRAMES * 2 * sizeof(float));
+    
+    printf("%-26s | %8s | %8s | %s\n", "test signal", "expected", "measured", "error LU");
+    printf("---------------------------+----------+----------+---------\n");
+    
+    for (guint t = 0; t < G_N_ELEMENTS(tests); t++) {
+        LoudnessMeter *meter = loudness_meter_new(RATE, 2);
+        guint64 position = 0;
+        
+        for (int s = 0; s < tests[t].count; s++) {
+            guint64 end = position + (guint64)(tests[t].segments[s].seconds * RATE);
+            while (position < end) {
+                gsize frames = MIN((guint64)BLOCK_FRAMES, end - position);
+                fill_sine(block, frames, tests[t].segments[s].level_db, position);
+                loudness_meter_add(meter, block, frames);
+                position += frames;
+            }
+        }
+        
+        double measured = loudness_meter_get_integrated(meter);
+        printf("%-26s | %8.1f | %8.2f | %+.2f\n", tests[t].name, tests[t].expected, measured, measured - tests[t].expected);
+        loudness_meter_free(meter);
+    }
+    
+    printf("\n");
+    g_free(block);
+}
+
+static gboolean write_long_file(const char *path, int minutes) {
+    WavWriter *writer = wav_writer_new(path, RATE, 2);
+    if (!writer) return FALSE;
+    
+    float *block = g_malloc(BLOCK_FRAMES * 2 * sizeof(float));
+    gint16 *samples = g_malloc(BLOCK_FRAMES * 2 * sizeof(gint16));
+    guint64 total = (guint64)minutes * 60 * RATE;
+    gboolean ok = TRUE;
+    
+    // Alternating loud and quiet passages, so the gates have work to do
+    for (guint64 position = 0; ok && position < total; position += BLOCK_FRAMES) {
+        double level = (position / (10 * RATE)) % 2 ? -35.0 : -15.0;
+        fill_sine(block, BLOCK_FRAMES, level, position);
+        for (int i = 0; i < BLOCK_FRAMES * 2; i++) samples[i] = (gint16)lrintf(block[i] * 32767.0f);
+        ok = wav_writer_write(writer, samples, BLOCK_FRAMES);
+    }
+    
+    g_free(block);
+    g_free(samples);
+    if (!ok) {
+        wav_writer_abort(writer);
+        return FALSE;
+    }
+    return wav_writer_finish(writer);
+}
+
+static void bench_streaming(const char *path, const char *output, int minutes) {
+    printf("%d min %d Hz stereo WAV (%.0f MB)\n\n", minutes, RATE, minutes * 60.0 * RATE * 4 / 1e6);
+    printf("%-26s | %9s | %11s | %8s | %s\n", "analysis", "LUFS", "x real time", "ns/frame", "peak RSS growth");
+    printf("---------------------------+-----------+-------------+----------+----------------\n");
+    
+    for (int pass = 0; pass < 2; pass++) {
+        SoundDecoder *decoder = sound_decoder_open(path);
+        if (!decoder) {
+            fprintf(stderr, "Cannot open %s\n", path);
+            return;
+        }
+        
+        long rss_before = max_rss_kb();
+        gint64 start = g_get_monotonic_time();
+        LoudnessMeter *meter;
+        
+        if (pass == 0) {
+            // The meter alone, at the file's format
+            meter = loudness_meter_new(RATE, 2);
+            sound_decoder_measure(decoder, meter);
+        } else {
+            // What a new custom sound goes through: converted into the cache
+            meter = loudness_meter_new(OUTPUT_RATE, 1);
+            sound_decoder_convert(decoder, output, OUTPUT_RATE, 1, G_MAXSIZE, meter);
+        }
+        
+        double seconds = (g_get_monotonic_time() - start) / 1e6;
+        double frames = minutes * 60.0 * RATE;
+        printf("%-26s | %9.2f | %11.0f | %8.2f | %ld kB\n", pass == 0 ? "decode + meter" : "decode + convert + meter",
+               loudness_meter_get_integrated(meter), minutes * 60.0 / seconds, seconds * 1e9 / frames,
+               max_rss_kb() - rss_before);
+        
+        loudness_meter_free(meter);
+        sound_decoder_free(decoder);
+    }
+}
+
+int main(int argc, char **argv) {
+    int minutes = argc > 1 ? atoi(argv[1]) : 10;
+    if (minutes <= 0) minutes = 10;
+    
+    char *path = g_build_filename(g_get_tmp_dir(), "commodoro-bench-loudness.wav", NULL);
+    char *output = g_build_filename(g_get_tmp_dir(), "commodoro-bench-loudness-out.wav", NULL);
+    
+    bench_accuracy();
+    if (write_long_file(path, minutes)) {
+        bench_streaming(path, output, minutes);
+    } else {
+        fprintf(stderr, "Cannot write %s\n", path);
+    }
+    
+    remove(path);
+    remove(output);
+    g_free(path);
+    g_free(output);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Playback pipeline benchmark without a sound card
+//
+// Runs the audio engine on the null and capture sinks:
+//   - first-sample latency on a paced null sink (same buffer geometry as
+//     the ALSA sink), from an idle device and while another sound plays
+//   - mixing throughput on an unpaced null sink, with 1 and 8 voices
+//   - a scheduled sequence recorded by the capture sink, checking that the
+//     sounds land the requested distance apart, to the frame
+//
+// Usage: bench_playback [capture.wav]
+
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "audio_engine.h"
+#include "wav_file.h"
+
+#define RATE 44100
+#define THROUGHPUT_SECONDS 60
+#define SEQUENCE_SPACING_MS 250
+
+// Cosine tone, so the first sample is loud and onsets are easy to find
+static GBytes* make_tone(double frequency, double seconds) {
+    gsize frames = (gsize)(seconds * RATE);
+    gint16 *samples = g_malloc(frames * sizeof(gint16));
+    for (gsize i = 0; i < frames; i++) {
+        samples[i] = (gint16)lrint(12000.0 * cos(2.0 * G_PI * frequency * i / RATE));
+    }
+    return g_bytes_new_take(samples, frames * sizeof(gint16));
+}
+
+static AudioEngine* start_engine(AudioSink *sink) {
+    AudioEngine *engine = audio_engine_new(sink, RATE, 1);
+    while (audio_engine_get_status(engine) == AUDIO_ENGINE_STARTING) g_usleep(1000);
+    
+    if (audio_engine_get_status(engine) != AUDIO_ENGINE_READY) {
+        fprintf(stderr, "Sink failed to open\n");
+        exit(1);
+    }
+    return engine;
+}
+
+static void print_latency(const char *name, AudioEngine *engine) {
+    AudioLatencyStats stats;
+    AudioSinkStats sink_stats;
+    audio_engine_get_latency_stats(engine, &stats);
+    audio_sink_get_stats(audio_engine_get_sink(engine), &sink_stats);
+    
+    printf("%-26s | %5u | %8.2f | %8.2f | %8.2f | %u\n", name, stats.plays,
+           stats.plays ? stats.total_us / 1000.0 / stats.plays : 0.0,
+           stats.min_us / 1000.0, stats.max_us / 1000.0, sink_stats.underruns);
+}
+
+static void bench_latency(GBytes *chime, GBytes *drone) {
+    printf("%-26s | %5s | %8s | %8s | %8s | %s\n", "first-sample latency", "plays", "avg ms", "min ms", "max ms", "underruns");
+    printf("---------------------------+-------+----------+----------+----------+----------\n");
+    
+    // Every sound starts from a drained, idle device
+    AudioEngine *engine = start_engine(audio_sink_new_null(TRUE));
+    for (int i = 0; i < 10; i++) {
+        audio_engine_play(engine, chime, AUDIO_GAIN_UNITY);
+        g_usleep(300000);
+    }
+    print_latency("idle device", engine);
+    audio_engine_free(engine);
+    
+    // Sounds join a stream that is already playing
+    engine = start_engine(audio_sink_new_null(TRUE));
+    audio_engine_play(engine, drone, AUDIO_GAIN_UNITY / 4);
+    g_usleep(100000);
+    for (int i = 0; i < 20; i++) {
+        audio_engine_play(engine, chime, AUDIO_GAIN_UNITY / 4);
+        g_usleep(50000);
+    }
+    print_latency("mixing into a playing one", engine);
+    audio_engine_free(engine);
+    printf("\n");
+}
+
+static void bench_throughput(void) {
+    GBytes *tone = make_tone(440.0, THROUGHPUT_SECONDS);
+    guint64 frames = (guint64)THROUGHPUT_SECONDS * RATE;
+    
+    printf("%-26s | %12s | %s\n", "mixing throughput", "Mframes/s", "x real time");
+    printf("---------------------------+--------------+------------\n");
+    
+    static const int voice_counts[] = {1, 8};
+    for (guint v = 0; v < G_N_ELEMENTS(voice_counts); v++) {
+        AudioEngine *engine = start_engine(audio_sink_new_null(FALSE));
+        AudioSinkStats stats;
+        
+        gint64 start = g_get_monotonic_time();
+        for (int i = 0; i < voice_counts[v]; i++) {
+            audio_engine_play(engine, tone, AUDIO_GAIN_UNITY / 8);
+        }
+        do {
+            g_usleep(1000);
+            audio_sink_get_stats(audio_engine_get_sink(engine), &stats);
+        } while (stats.frames < frames);
+        double seconds = (g_get_monotonic_time() - start) / 1e6;
+        
+        char name[32];
+        g_snprintf(name, sizeof(name), "%d voice%s", voice_counts[v], voice_counts[v] > 1 ? "s" : "");
+        printf("%-26s | %12.1f | %10.0f\n", name, stats.frames / seconds / 1e6, THROUGHPUT_SECONDS / seconds);
+        audio_engine_free(engine);
+    }
+    printf("\n");
+    g_bytes_unref(tone);
+}
+
+// Starts of sounds in the capture: loud samples after at least 10 ms of silence
+static int find_onsets(const gint16 *samples, gsize frames, gsize *onsets, int max) {
+    int count = 0;
+    gsize quiet = RATE;
+    
+    for (gsize i = 0; i < frames && count < max; i++) {
+        if (abs(samples[i]) > 1000) {
+            if (quiet >= RATE / 100) onsets[count++] = i;
+            quiet = 0;
+        } else {
+            quiet++;
+        }
+    }
+    return count;
+}
+
+static void bench_capture(const char *path, GBytes *chime) {
+    AudioEngine *engine = start_engine(audio_sink_new_capture(path, TRUE));
+    
+    // The sequence the manager plays for sounds requested back to back
+    gint64 start_us = g_get_monotonic_time() + 50000;
+    for (int i = 0; i < 3; i++) {
+        audio_engine_play_at(engine, chime, AUDIO_GAIN_UNITY, start_us + i * SEQUENCE_SPACING_MS * 1000);
+    }
+    g_usleep(1000000);
+    audio_engine_free(engine);
+    
+    WavFormat format;
+    GBytes *capture = wav_file_map(path, &format);
+    if (!capture) {
+        fprintf(stderr, "Cannot read capture %s\n", path);
+        return;
+    }
+    
+    gsize size = 0;
+    const gint16 *samples = g_bytes_get_data(capture, &size);
+    gsize onsets[3];
+    int found = find_onsets(samples, size / sizeof(gint16), onsets, 3);
+    
+    printf("capture: %s (+ .timestamps)\n", path);
+    printf("sequence spaced %d ms = %d frames apart:", SEQUENCE_SPACING_MS, SEQUENCE_SPACING_MS * RATE / 1000);
+    for (int i = 1; i < found; i++) {
+        printf(" %" G_GSIZE_FORMAT, onsets[i] - onsets[i - 1]);
+    }
+    printf(found == 3 ? "\n" : " (found %d of 3 sounds)\n", found);
+    g_bytes_unref(capture);
+}
+
+int main(int argc, char **argv) {
+    char *path = argc > 1 ? g_strdup(argv[1]) : g_build_filename(g_get_tmp_dir(), "commodoro-bench-capture.wav", NULL);
+    GBytes *chime = make_tone(880.0, 0.1);
+    GBytes *drone = make_tone(220.0, 5.0);
+    
+    printf("Audio engine at %d Hz mono\n\n", RATE);
+    bench_latency(chime, drone);
+    bench_throughput();
+    bench_capture(path, chime);
+    
+    g_bytes_unref(chime);
+    g_bytes_unref(drone);
+    g_free(path);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Custom sound resampler benchmark
+//
+// Converts a two-tone test signal (1 kHz + 7 kHz) between common rates
+// with the previous linear interpolator and with each polyphase kernel, and
+// reports output samples/second and the SNR against the exact signal at
+// the output rate.
+//
+// Usage: bench_resample [iterations]
+
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_resampler.h"
+
+#define SECONDS 5
+#define BLOCK 4096
+
+static const double tones[2][2] = {{1000.0, 0.4}, {7000.0, 0.4}};
+
+static double signal_at(double t) {
+    double v = 0.0;
+    for (int i = 0; i < 2; i++) v += tones[i][1] * sin(2.0 * G_PI * tones[i][0] * t);
+    return v;
+}
+
+// The interpolator sound_decoder.c used before the polyphase resampler,
+// kept for reference (mono, the downmix was a separate step)
+static gsize resample_linear(const float *in, gsize frames, unsigned int in_rate, unsigned int out_rate, float *out) {
+    double step = (double)in_rate / out_rate;
+    double position = 0.0;
+    float previous = 0.0f;
+    gsize count = 0;
+    
+    for (gsize start = 0; start < frames; start += BLOCK) {
+        gsize n = MIN((gsize)BLOCK, frames - start);
+        const float *block = in + start;
+        
+        while (position < (double)(n - 1)) {
+            double whole = floor(position);
+            float frac = (float)(position - whole);
+            long i = (long)whole;
+            float a = i < 0 ? previous : block[i];
+            out[count++] = a + frac * (block[i + 1] - a);
+            position += step;
+        }
+        position -= (double)n;
+        previous = block[n - 1];
+    }
+    return count;
+}
+
+static gsize resample_polyphase(const float *in, gsize frames, unsigned int in_rate, int in_channels,
+                                unsigned int out_rate, AudioResamplerKernel kernel, float *out) {
+    AudioResampler *resampler = audio_resampler_new(in_rate, in_channels, out_rate, 1, kernel);
+    gsize count = 0;
+    
+    for (gsize start = 0; start < frames; start += BLOCK) {
+        gsize n = MIN((gsize)BLOCK, frames - start);
+        count += audio_resampler_process(resampler, in + start * in_channels, n, out + count);
+    }
+    count += audio_resampler_drain(resampler, out + count);
+    
+    audio_resampler_free(resampler);
+    return count;
+}
+
+// Error against the exact signal, skipping the edges
+static double measure_snr(const float *out, gsize count, unsigned int out_rate) {
+    double signal = 0.0, noise = 0.0;
+    gsize edge = out_rate / 10;
+    
+    for (gsize i = edge; i + edge < count; i++) {
+        double ideal = signal_at((double)i / out_rate);
+        double error = out[i] - ideal;
+        signal += ideal * ideal;
+        noise += error * error;
+    }
+    return 10.0 * log10(signal / MAX(noise, 1e-30));
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    if (iterations <= 0) iterations = 5;
+    
+    static const struct { unsigned int in_rate; int channels; unsigned int out_rate; } cases[] = {
+        {48000, 2, 44100},
+        {44100, 1, 48000},
+        {22050, 1, 48000},
+        {96000, 1, 44100}
+    };
+    
+    static const struct { const char *name; int kernel; } kernels[] = {
+        {"linear", -1},
+        {"scalar", AUDIO_RESAMPLER_KERNEL_SCALAR},
+        {"sse2", AUDIO_RESAMPLER_KERNEL_SSE2},
+        {"avx2", AUDIO_RESAMPLER_KERNEL_AVX2}
+    };
+    
+    printf("Resampling %d s of 1 kHz + 7 kHz to mono, %d iterations\n\n", SECONDS, iterations);
+    printf("%-22s | %-7s | %12s | %s\n", "conversion", "kernel", "Msamples/s", "SNR (dB)");
+    printf("-----------------------+---------+--------------+---------\n");
+    
+    for (guint c = 0; c < G_N_ELEMENTS(cases); c++) {
+        unsigned int in_rate = cases[c].in_rate;
+        unsigned int out_rate = cases[c].out_rate;
+        int channels = cases[c].channels;
+        gsize frames = (gsize)in_rate * SECONDS;
+        
+        // Stereo input carries the same signal on both channels
+        float *in = g_malloc(frames * channels * sizeof(float));
+        float *mono = g_malloc(frames * sizeof(float));
+        for (gsize i = 0; i < frames; i++) {
+            mono[i] = (float)signal_at((double)i / in_rate);
+            for (int ch = 0; ch < channels; ch++) in[i * channels + ch] = mono[i];
+        }
+        float *out = g_malloc(((gsize)out_rate * SECONDS + 1024) * sizeof(float));
+        
+        char name[32];
+        g_snprintf(name, sizeof(name), "%u/%d -> %u/1", in_rate, channels, out_rate);
+        
+        for (guint k = 0; k < G_N_ELEMENTS(kernels); k++) {
+            if (kernels[k].kernel >= 0 && !audio_resampler_kernel_supported((AudioResamplerKernel)kernels[k].kernel)) {
+                printf("%-22s | %-7s | %12s |\n", name, kernels[k].name, "unsupported");
+                continue;
+            }
+            
+            gsize count = 0;
+            gint64 start = g_get_monotonic_time();
+            for (int it = 0; it < iterations; it++) {
+                if (kernels[k].kernel < 0) {
+                    count = resample_linear(mono, frames, in_rate, out_rate, out);
+                } else {
+                    count = resample_polyphase(in, frames, in_rate, channels, out_rate,
+                                               (AudioResamplerKernel)kernels[k].kernel, out);
+                }
+            }
+            double seconds = (g_get_monotonic_time() - start) / 1e6;
+            
+            printf("%-22s | %-7s | %12.1f | %8.1f\n", name, kernels[k].name,
+                   (double)count * iterations / MAX(seconds, 1e-9) / 1e6, measure_snr(out, count, out_rate));
+        }
+        
+        g_free(in);
+        g_free(mono);
+        g_free(out);
+    }
+    
+    return 0;
+}
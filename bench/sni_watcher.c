@@ -0,0 +1,235 @@
+// Stub StatusNotifierWatcher
+//
+// Owns org.kde.StatusNotifierWatcher on the session bus and plays the part of
+// a tray host: every item that registers gets its IconPixmap fetched once on
+// registration and again on each NewIcon signal. Run it on a private bus next
+// to commodoro (see test_status_notifier.sh) to check that icons arrive and
+// that NewIcon is only emitted when the frame actually changes.
+//
+// Usage: sni_watcher [seconds]
+// Exits 0 if at least one non-empty pixmap was received.
+
+#include <gio/gio.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    GMainLoop *loop;
+    GDBusConnection *connection;
+    char *item_service;
+    guint new_icon_subscription;
+    
+    guint new_icon_signals;
+    guint new_tooltip_signals;
+    guint fetches;
+    guint empty_fetches;
+    guint64 distinct_hash;
+    guint distinct_icons;
+    gint64 fetch_total_us;
+    int last_width;
+    int last_height;
+    gsize last_bytes;
+} Watcher;
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='org.kde.StatusNotifierWatcher'>"
+    "    <method name='RegisterStatusNotifierItem'>"
+    "      <arg type='s' name='service' direction='in'/>"
+    "    </method>"
+    "    <method name='RegisterStatusNotifierHost'>"
+    "      <arg type='s' name='service' direction='in'/>"
+    "    </method>"
+    "    <property name='RegisteredStatusNotifierItems' type='as' access='read'/>"
+    "    <property name='IsStatusNotifierHostRegistered' type='b' access='read'/>"
+    "    <property name='ProtocolVersion' type='i' access='read'/>"
+    "    <signal name='StatusNotifierItemRegistered'>"
+    "      <arg type='s' name='service'/>"
+    "    </signal>"
+    "  </interface>"
+    "</node>";
+
+static void fetch_icon(Watcher *watcher) {
+    GError *error = NULL;
+    gint64 start = g_get_monotonic_time();
+    GVariant *reply = g_dbus_connection_call_sync(watcher->connection,
+                                                  watcher->item_service,
+                                                  "/StatusNotifierItem",
+                                                  "org.freedesktop.DBus.Properties",
+                                                  "Get",
+                                                  g_variant_new("(ss)", "org.kde.StatusNotifierItem", "IconPixmap"),
+                                                  G_VARIANT_TYPE("(v)"),
+                                                  G_DBUS_CALL_FLAGS_NONE,
+                                                  -1, NULL, &error);
+    if (!reply) {
+        g_printerr("IconPixmap fetch failed: %s\n", error->message);
+        g_error_free(error);
+        return;
+    }
+    watcher->fetch_total_us += g_get_monotonic_time() - start;
+    watcher->fetches++;
+    
+    GVariant *value;
+    g_variant_get(reply, "(v)", &value);
+    
+    if (g_variant_n_children(value) == 0) {
+        watcher->empty_fetches++;
+    } else {
+        // Only the first (largest) pixmap matters for this check
+        GVariant *bytes;
+        g_variant_get_child(value, 0, "(ii@ay)", &watcher->last_width, &watcher->last_height, &bytes);
+        
+        gsize size;
+        const guint8 *data = g_variant_get_fixed_array(bytes, &size, 1);
+        guint64 hash = G_GUINT64_CONSTANT(0xcbf29ce484222325);
+        for (gsize i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * G_GUINT64_CONSTANT(0x100000001b3);
+        }
+        if (hash != watcher->distinct_hash) {
+            watcher->distinct_icons++;
+            watcher->distinct_hash = hash;
+        }
+        watcher->last_bytes = size;
+        g_variant_unref(bytes);
+    }
+    
+    g_variant_unref(value);
+    g_variant_unref(reply);
+}
+
+static void on_item_signal(GDBusConnection *connection, const gchar *sender_name, const gchar *object_path, const gchar *interface_name, const gchar *signal_name, GVariant *parameters, gpointer user_data) {
+    (void)connection;     // Suppress unused parameter warning
+    (void)sender_name;    // Suppress unused parameter warning
+    (void)object_path;    // Suppress unused parameter warning
+    (void)interface_name; // Suppress unused parameter warning
+    (void)parameters;     // Suppress unused parameter warning
+    Watcher *watcher = (Watcher*)user_data;
+    
+    if (g_strcmp0(signal_name, "NewIcon") == 0) {
+        watcher->new_icon_signals++;
+        fetch_icon(watcher);
+    } else if (g_strcmp0(signal_name, "NewToolTip") == 0) {
+        watcher->new_tooltip_signals++;
+    }
+}
+
+static void handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *method_name, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer user_data) {
+    (void)object_path;    // Suppress unused parameter warning
+    (void)interface_name; // Suppress unused parameter warning
+    Watcher *watcher = (Watcher*)user_data;
+    
+    if (g_strcmp0(method_name, "RegisterStatusNotifierItem") == 0) {
+        const gchar *service;
+        g_variant_get(parameters, "(&s)", &service);
+        
+        // Items may pass an object path instead of a bus name
+        g_free(watcher->item_service);
+        watcher->item_service = g_strdup(service[0] == '/' ? sender : service);
+        
+        if (watcher->new_icon_subscription) {
+            g_dbus_connection_signal_unsubscribe(connection, watcher->new_icon_subscription);
+        }
+        watcher->new_icon_subscription = g_dbus_connection_signal_subscribe(connection,
+                                                                           watcher->item_service,
+                                                                           "org.kde.StatusNotifierItem",
+                                                                           NULL,
+                                                                           "/StatusNotifierItem",
+                                                                           NULL,
+                                                                           G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                           on_item_signal,
+                                                                           watcher,
+                                                                           NULL);
+        g_dbus_method_invocation_return_value(invocation, NULL);
+        g_print("Item registered: %s\n", watcher->item_service);
+        
+        g_dbus_connection_emit_signal(connection, NULL, "/StatusNotifierWatcher", "org.kde.StatusNotifierWatcher",
+                                      "StatusNotifierItemRegistered", g_variant_new("(s)", watcher->item_service), NULL);
+        fetch_icon(watcher);
+    } else if (g_strcmp0(method_name, "RegisterStatusNotifierHost") == 0) {
+        g_dbus_method_invocation_return_value(invocation, NULL);
+    } else {
+        g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.UnknownMethod", "Method does not exist");
+    }
+}
+
+static GVariant* handle_get_property(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *property_name, GError **error, gpointer user_data) {
+    (void)connection;     // Suppress unused parameter warning
+    (void)sender;         // Suppress unused parameter warning
+    (void)object_path;    // Suppress unused parameter warning
+    (void)interface_name; // Suppress unused parameter warning
+    Watcher *watcher = (Watcher*)user_data;
+    
+    if (g_strcmp0(property_name, "RegisteredStatusNotifierItems") == 0) {
+        const gchar *items[] = {watcher->item_service, NULL};
+        return g_variant_new_strv(items, watcher->item_service ? 1 : 0);
+    } else if (g_strcmp0(property_name, "IsStatusNotifierHostRegistered") == 0) {
+        return g_variant_new_boolean(TRUE);
+    } else if (g_strcmp0(property_name, "ProtocolVersion") == 0) {
+        return g_variant_new_int32(0);
+    }
+    
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY, "Unknown property %s", property_name);
+    return NULL;
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+    .method_call = handle_method_call,
+    .get_property = handle_get_property
+};
+
+static void on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    (void)name; // Suppress unused parameter warning
+    Watcher *watcher = (Watcher*)user_data;
+    GError *error = NULL;
+    
+    watcher->connection = connection;
+    
+    GDBusNodeInfo *introspection_data = g_dbus_node_info_new_for_xml(introspection_xml, &error);
+    g_assert_no_error(error);
+    g_dbus_connection_register_object(connection, "/StatusNotifierWatcher", introspection_data->interfaces[0],
+                                      &interface_vtable, watcher, NULL, &error);
+    g_assert_no_error(error);
+    g_dbus_node_info_unref(introspection_data);
+}
+
+static void on_name_lost(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    (void)connection; // Suppress unused parameter warning
+    (void)user_data;  // Suppress unused parameter warning
+    
+    g_printerr("Could not own %s (is a tray host already running on this bus?)\n", name);
+    exit(2);
+}
+
+static gboolean on_timeout(gpointer user_data) {
+    Watcher *watcher = (Watcher*)user_data;
+    g_main_loop_quit(watcher->loop);
+    return G_SOURCE_REMOVE;
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : 30;
+    Watcher watcher = {0};
+    
+    watcher.loop = g_main_loop_new(NULL, FALSE);
+    guint owner_id = g_bus_own_name(G_BUS_TYPE_SESSION, "org.kde.StatusNotifierWatcher",
+                                    G_BUS_NAME_OWNER_FLAGS_NONE, on_bus_acquired, NULL, on_name_lost,
+                                    &watcher, NULL);
+    g_timeout_add_seconds(seconds > 0 ? seconds : 30, on_timeout, &watcher);
+    g_main_loop_run(watcher.loop);
+    
+    printf("Item:              %s\n", watcher.item_service ? watcher.item_service : "(none registered)");
+    printf("NewIcon signals:   %u\n", watcher.new_icon_signals);
+    printf("NewToolTip:        %u\n", watcher.new_tooltip_signals);
+    printf("Pixmap fetches:    %u (%u empty), %u distinct\n", watcher.fetches, watcher.empty_fetches, watcher.distinct_icons);
+    if (watcher.fetches > 0) {
+        printf("Avg fetch:         %.1f us\n", (double)watcher.fetch_total_us / watcher.fetches);
+    }
+    printf("Last pixmap:       %dx%d, %zu bytes\n", watcher.last_width, watcher.last_height, watcher.last_bytes);
+    
+    gboolean ok = watcher.last_bytes > 0 && watcher.last_bytes == (gsize)watcher.last_width * watcher.last_height * 4;
+    
+    g_bus_unown_name(owner_id);
+    g_free(watcher.item_service);
+    g_main_loop_unref(watcher.loop);
+    return ok ? 0 : 1;
+}
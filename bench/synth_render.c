@@ -0,0 +1,185 @@
+// Chime synthesis benchmark
+//
+// Renders the seven notification chimes (3 partials) and a 12-partial bell
+// with the previous per-sample generator (sinf per partial, ADSR branches)
+// and with each wavetable kernel, and reports samples/second, the speedup
+// over the previous generator and the largest sample difference from it.
+//
+// Usage: bench_synth_render [iterations]
+
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "audio_synth.h"
+
+#define RATE 44100
+
+// The generator audio.c used before the wavetable synth, kept for reference
+static void render_legacy(const AudioSynthPatch *patch, unsigned int rate, gint16 *out) {
+    int samples = audio_synth_get_length(patch, rate);
+    const AudioSynthPoint *pt = patch->envelope;
+    int attack_samples = (int)(pt[1].time * rate);
+    int decay_samples = (int)((pt[2].time - pt[1].time) * rate);
+    int release_samples = (int)((pt[4].time - pt[3].time) * rate);
+    float sustain = pt[2].level;
+    float total_amp = 0.0f;
+    
+    for (int p = 0; p < patch->partial_count; p++) total_amp += patch->partials[p].amp;
+    
+    for (int i = 0; i < samples; i++) {
+        float t = (float)i / rate;
+        float envelope;
+        if (i < attack_samples) {
+            envelope = (float)i / attack_samples;
+        } else if (i < attack_samples + decay_samples) {
+            float decay_progress = (float)(i - attack_samples) / decay_samples;
+            envelope = 1.0f - decay_progress * (1.0f - sustain);
+        } else if (i < samples - release_samples) {
+            envelope = sustain;
+        } else {
+            float release_progress = (float)(i - (samples - release_samples)) / release_samples;
+            envelope = sustain * (1.0f - release_progress);
+        }
+        
+        float sample = 0.0f;
+        for (int p = 0; p < patch->partial_count; p++) {
+            sample += patch->partials[p].amp * sinf(2.0f * G_PI * patch->partials[p].freq * t);
+        }
+        sample = (sample / total_amp) * envelope * patch->gain;
+        out[i] = (gint16)(sample * 32767.0f);
+    }
+}
+
+static void make_patch(AudioSynthPatch *patch, const float *freq, const float *amp, int partials) {
+    const AudioSynthPoint adsr[] = {
+        {0.0f, 0.0f}, {0.01f, 1.0f}, {0.06f, 0.3f}, {0.3f, 0.3f}, {0.5f, 0.0f}
+    };
+    
+    memset(patch, 0, sizeof(AudioSynthPatch));
+    patch->duration = 0.5f;
+    patch->gain = 0.3f;
+    patch->partial_count = partials;
+    for (int p = 0; p < partials; p++) {
+        patch->partials[p].freq = freq[p];
+        patch->partials[p].amp = amp[p];
+    }
+    patch->point_count = G_N_ELEMENTS(adsr);
+    memcpy(patch->envelope, adsr, sizeof(adsr));
+}
+
+typedef struct {
+    const char *name;
+    AudioSynthPatch patches[7];
+    int count;
+} PatchSet;
+
+static double run(const PatchSet *set, int kernel, int iterations, gint16 *out, int *max_diff, gint16 *reference) {
+    gint64 start = g_get_monotonic_time();
+    gint64 samples = 0;
+    
+    for (int it = 0; it < iterations; it++) {
+        for (int i = 0; i < set->count; i++) {
+            if (kernel < 0) {
+                render_legacy(&set->patches[i], RATE, out);
+            } else {
+                audio_synth_render(&set->patches[i], RATE, out, (AudioSynthKernel)kernel);
+            }
+            samples += audio_synth_get_length(&set->patches[i], RATE);
+        }
+    }
+    double seconds = (g_get_monotonic_time() - start) / 1e6;
+    
+    // Accuracy against the legacy output of the last patch
+    int n = audio_synth_get_length(&set->patches[set->count - 1], RATE);
+    *max_diff = 0;
+    for (int i = 0; reference && i < n; i++) {
+        int diff = abs(out[i] - reference[i]);
+        if (diff > *max_diff) *max_diff = diff;
+    }
+    
+    return samples / MAX(seconds, 1e-9);
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    if (iterations <= 0) iterations = 50;
+    
+    static const float chimes[7][3][2] = {
+        {{261.63f, 1.0f}, {329.63f, 0.8f}, {392.00f, 0.6f}},
+        {{220.00f, 1.0f}, {261.63f, 0.8f}, {329.63f, 0.6f}},
+        {{261.63f, 1.0f}, {392.00f, 0.8f}, {523.25f, 0.5f}},
+        {{220.00f, 1.2f}, {261.63f, 1.0f}, {329.63f, 0.8f}},
+        {{440.00f, 1.0f}, {880.00f, 0.5f}, {0.0f, 0.0f}},
+        {{349.23f, 0.8f}, {293.66f, 0.6f}, {0.0f, 0.0f}},
+        {{293.66f, 0.6f}, {349.23f, 0.8f}, {0.0f, 0.0f}}
+    };
+    
+    PatchSet sets[2];
+    sets[0].name = "chimes (2-3 partials)";
+    sets[0].count = 7;
+    for (int i = 0; i < 7; i++) {
+        float freq[3], amp[3];
+        int partials = 0;
+        for (int p = 0; p < 3; p++) {
+            if (chimes[i][p][0] <= 0) continue;
+            freq[partials] = chimes[i][p][0];
+            amp[partials++] = chimes[i][p][1];
+        }
+        make_patch(&sets[0].patches[i], freq, amp, partials);
+    }
+    
+    // Inharmonic bell: 12 partials with decaying amplitudes
+    sets[1].name = "bell (12 partials)";
+    sets[1].count = 1;
+    {
+        static const float ratios[12] = {0.56f, 0.92f, 1.0f, 1.19f, 1.71f, 2.0f, 2.74f, 3.0f, 3.76f, 4.07f, 4.5f, 5.2f};
+        float freq[12], amp[12];
+        for (int p = 0; p < 12; p++) {
+            freq[p] = 440.0f * ratios[p];
+            amp[p] = 1.0f / (1.0f + p * 0.5f);
+        }
+        make_patch(&sets[1].patches[0], freq, amp, 12);
+    }
+    
+    int max_len = audio_synth_get_length(&sets[0].patches[0], RATE);
+    gint16 *out = g_malloc0(max_len * sizeof(gint16));
+    gint16 *reference = g_malloc0(max_len * sizeof(gint16));
+    
+    printf("Chime synthesis at %d Hz, %d iterations\n\n", RATE, iterations);
+    printf("%-22s | %-7s | %12s | %7s | %s\n", "sounds", "kernel", "Msamples/s", "speedup", "max diff vs legacy");
+    printf("-----------------------+---------+--------------+---------+-------------------\n");
+    
+    static const struct { const char *name; int kernel; } kernels[] = {
+        {"legacy", -1},
+        {"scalar", AUDIO_SYNTH_KERNEL_SCALAR},
+        {"sse2", AUDIO_SYNTH_KERNEL_SSE2},
+        {"avx2", AUDIO_SYNTH_KERNEL_AVX2}
+    };
+    
+    for (int s = 0; s < 2; s++) {
+        const PatchSet *set = &sets[s];
+        int diff = 0;
+        double legacy_rate = 0.0;
+        
+        render_legacy(&set->patches[set->count - 1], RATE, reference);
+        
+        for (guint k = 0; k < G_N_ELEMENTS(kernels); k++) {
+            if (kernels[k].kernel >= 0 && !audio_synth_kernel_supported((AudioSynthKernel)kernels[k].kernel)) {
+                printf("%-22s | %-7s | %12s |\n", set->name, kernels[k].name, "unsupported");
+                continue;
+            }
+            
+            double rate = run(set, kernels[k].kernel, iterations, out, &diff, reference);
+            if (kernels[k].kernel < 0) legacy_rate = rate;
+            
+            printf("%-22s | %-7s | %12.1f | %6.1fx | %d\n",
+                   set->name, kernels[k].name, rate / 1e6, rate / MAX(legacy_rate, 1.0), diff);
+        }
+    }
+    
+    g_free(out);
+    g_free(reference);
+    return 0;
+}
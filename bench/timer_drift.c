@@ -0,0 +1,146 @@
+// Timer drift benchmark
+//
+// Runs the Timer through a few short work/break cycles on a main loop that is
+// kept busy by a CPU-hogging idle source, and reports how far each phase
+// transition lands from its ideal end time. A naive per-second decrement
+// counter runs on the same loop for comparison.
+//
+// Usage: bench_timer_drift [work_seconds] [cycles] [max_load_ms]
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timer.h"
+
+typedef struct {
+    GMainLoop *loop;
+    Timer *timer;
+    int work_seconds;
+    int break_seconds;
+    int cycles_left;
+    int max_load_ms;
+    
+    gint64 phase_start_us;      // Ideal start of the current phase
+    int phase_seconds;          // Duration of the current phase
+    double max_error_ms;
+    double total_error_ms;
+    int phases;
+    
+    // Naive counter for comparison: decremented once per 1000 ms timeout
+    int naive_remaining;
+    gint64 naive_start_us;
+    double naive_error_ms;
+    guint naive_id;
+} DriftBench;
+
+static gboolean burn_cpu(gpointer user_data) {
+    DriftBench *bench = (DriftBench*)user_data;
+    
+    // Hold the main loop for a random slice to delay other dispatches
+    gint64 until = g_get_monotonic_time() + g_random_int_range(0, bench->max_load_ms + 1) * 1000;
+    while (g_get_monotonic_time() < until) {
+        // Busy wait
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean naive_tick(gpointer user_data) {
+    DriftBench *bench = (DriftBench*)user_data;
+    
+    if (--bench->naive_remaining > 0) {
+        return G_SOURCE_CONTINUE;
+    }
+    
+    gint64 ideal_us = bench->naive_start_us + (gint64)bench->work_seconds * G_USEC_PER_SEC;
+    bench->naive_error_ms = (g_get_monotonic_time() - ideal_us) / 1000.0;
+    bench->naive_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+static void on_session_complete(Timer *timer, TimerState completed_state, gpointer user_data) {
+    (void)timer;
+    DriftBench *bench = (DriftBench*)user_data;
+    
+    gint64 ideal_us = bench->phase_start_us + (gint64)bench->phase_seconds * G_USEC_PER_SEC;
+    double error_ms = (g_get_monotonic_time() - ideal_us) / 1000.0;
+    
+    g_print("  %-11s ended %+8.3f ms from deadline\n",
+            completed_state == TIMER_STATE_WORK ? "work" : "break", error_ms);
+    
+    if (error_ms > bench->max_error_ms) bench->max_error_ms = error_ms;
+    bench->total_error_ms += error_ms;
+    bench->phases++;
+    
+    // The next phase ideally starts at this phase's deadline
+    bench->phase_start_us = ideal_us;
+}
+
+static void on_state_changed(Timer *timer, TimerState state, gpointer user_data) {
+    DriftBench *bench = (DriftBench*)user_data;
+    
+    switch (state) {
+        case TIMER_STATE_WORK:
+            bench->phase_seconds = bench->work_seconds;
+            break;
+        case TIMER_STATE_SHORT_BREAK:
+        case TIMER_STATE_LONG_BREAK:
+            bench->phase_seconds = bench->break_seconds;
+            break;
+        case TIMER_STATE_IDLE:
+            if (--bench->cycles_left > 0) {
+                bench->phase_start_us = g_get_monotonic_time();
+                timer_start(timer);
+            } else {
+                g_main_loop_quit(bench->loop);
+            }
+            break;
+        case TIMER_STATE_PAUSED:
+            break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    DriftBench bench = {0};
+    bench.work_seconds = argc > 1 ? atoi(argv[1]) : 5;
+    bench.cycles_left = argc > 2 ? atoi(argv[2]) : 3;
+    bench.max_load_ms = argc > 3 ? atoi(argv[3]) : 40;
+    bench.break_seconds = MAX(1, bench.work_seconds / 2);
+    
+    if (bench.work_seconds <= 0 || bench.cycles_left <= 0 || bench.max_load_ms < 0) {
+        g_printerr("Usage: %s [work_seconds] [cycles] [max_load_ms]\n", argv[0]);
+        return 1;
+    }
+    
+    g_print("Timer drift: %ds work / %ds break, %d cycles, up to %d ms main loop stalls\n",
+            bench.work_seconds, bench.break_seconds, bench.cycles_left, bench.max_load_ms);
+    
+    bench.loop = g_main_loop_new(NULL, FALSE);
+    bench.timer = timer_new();
+    timer_set_duration_mode(bench.timer, TRUE);
+    timer_set_durations(bench.timer, bench.work_seconds, bench.break_seconds, bench.break_seconds, 2);
+    timer_set_callbacks(bench.timer, on_state_changed, NULL, on_session_complete, &bench);
+    
+    g_idle_add(burn_cpu, &bench);
+    
+    bench.naive_remaining = bench.work_seconds;
+    bench.naive_start_us = g_get_monotonic_time();
+    bench.naive_id = g_timeout_add(1000, naive_tick, &bench);
+    
+    bench.phase_start_us = g_get_monotonic_time();
+    timer_start(bench.timer);
+    
+    g_main_loop_run(bench.loop);
+    
+    g_print("Deadline timer: %d phases, mean %+.3f ms, max %+.3f ms\n",
+            bench.phases, bench.phases ? bench.total_error_ms / bench.phases : 0.0, bench.max_error_ms);
+    if (bench.naive_id == 0) {
+        g_print("Per-second decrement (first work phase): %+.3f ms\n", bench.naive_error_ms);
+    }
+    
+    if (bench.naive_id > 0) {
+        g_source_remove(bench.naive_id);
+    }
+    timer_free(bench.timer);
+    g_main_loop_unref(bench.loop);
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Tray icon rendering benchmark
+//
+// Plays a 25-minute work session second by second through TrayIcon for a
+// range of tray sizes, two ways:
+//   native:  the icon is rendered at the tray's size
+//   rescale: the icon is rendered at 64 px and every changed frame is
+//            bilinearly scaled down to the tray's size, which is what the
+//            tray host did for us before
+// and reports the frames rendered per session and the cost per frame.
+//
+// Usage: bench_tray_render [sessions]
+
+#include <glib.h>
+#include <cairo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "tray_icon.h"
+
+#define SESSION_SECONDS (25 * 60)
+
+typedef struct {
+    guint frames;               // Frames rendered (and rescaled) per session
+    gint64 total_us;            // Time for all sessions
+} RenderResult;
+
+// Scales a frame the way a tray host would before displaying it
+static void rescale_frame(cairo_surface_t *source, cairo_surface_t *target, int size) {
+    cairo_t *cr = cairo_create(target);
+    double factor = (double)size / cairo_image_surface_get_width(source);
+    
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_scale(cr, factor, factor);
+    cairo_set_source_surface(cr, source, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_BILINEAR);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    cairo_surface_flush(target);
+}
+
+static RenderResult run_sessions(int size, gboolean rescale, int sessions) {
+    RenderResult result = {0, 0};
+    TrayIcon *icon = tray_icon_new();
+    cairo_surface_t *target = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    
+    if (!rescale) {
+        tray_icon_set_size(icon, size);
+    }
+    
+    gint64 start = g_get_monotonic_time();
+    for (int s = 0; s < sessions; s++) {
+        guint frames = 0;
+        for (int remaining = SESSION_SECONDS; remaining >= 0; remaining--) {
+            if (!tray_icon_update(icon, TIMER_STATE_WORK, remaining, SESSION_SECONDS)) {
+                continue;
+            }
+            frames++;
+            if (rescale) {
+                rescale_frame(tray_icon_get_surface(icon), target, size);
+            }
+        }
+        result.frames = frames;
+    }
+    result.total_us = g_get_monotonic_time() - start;
+    
+    cairo_surface_destroy(target);
+    tray_icon_free(icon);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int sessions = argc > 1 ? atoi(argv[1]) : 20;
+    static const int sizes[] = {16, 22, 24, 32, 48};
+    
+    if (sessions <= 0) sessions = 20;
+    
+    printf("Tray rendering: %d x %d-minute work session, 1 update/s\n\n", sessions, SESSION_SECONDS / 60);
+    printf("size | native: frames  ns/frame  us/session | 64px+rescale: frames  ns/frame  us/session | speedup\n");
+    printf("-----+-----------------------------------------+-----------------------------------------------+--------\n");
+    
+    for (guint i = 0; i < G_N_ELEMENTS(sizes); i++) {
+        RenderResult native = run_sessions(sizes[i], FALSE, sessions);
+        RenderResult scaled = run_sessions(sizes[i], TRUE, sessions);
+        
+        double native_session_us = (double)native.total_us / sessions;
+        double scaled_session_us = (double)scaled.total_us / sessions;
+        
+        printf("%4d | %14u  %8.0f  %10.0f | %20u  %8.0f  %10.0f | %6.2fx\n",
+               sizes[i],
+               native.frames, native_session_us * 1000.0 / MAX(native.frames, 1), native_session_us,
+               scaled.frames, scaled_session_us * 1000.0 / MAX(scaled.frames, 1), scaled_session_us,
+               scaled_session_us / MAX(native_session_us, 1.0));
+    }
+    
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include "ambient_noise.h"
+#include <math.h>
+#include <string.h>
+
+#include "simd_dispatch.h"
+
+G_STATIC_ASSERT((int)AMBIENT_NOISE_KERNEL_AUTO == (int)SIMD_KERNEL_AUTO && (int)AMBIENT_NOISE_KERNEL_AVX2 == (int)SIMD_KERNEL_AVX2);
+
+// Independent xorshift32 generators, interleaved: sample i comes from
+// lane i % NOISE_LANES, so every kernel draws the same sequence
+#define NOISE_LANES 8
+
+// Frames rendered per step; a multiple of NOISE_LANES
+#define NOISE_BLOCK 256
+
+// Voss-McCartney: row k is redrawn every 2^(k+1) samples
+#define PINK_ROWS 16
+
+// Levels for about -25 dBFS RMS from uniform [-1, 1) input (RMS 1/sqrt(3)).
+// Pink sums PINK_ROWS + 1 uniform values; brown is a leaky integrator
+// whose steady-state RMS is step / sqrt(3 * (1 - leak^2)), about 0.29.
+#define WHITE_GAIN 0.1f
+#define PINK_GAIN (WHITE_GAIN / 4.1231f)   // sqrt(PINK_ROWS + 1)
+#define BROWN_LEAK 0.995f
+#define BROWN_STEP 0.05f
+#define BROWN_GAIN 0.2f
+
+// Clock tick: a short decaying sine, alternating pitch ("tick", "tock")
+#define TICK_SECONDS 0.008
+#define TICK_DECAY_SECONDS 0.0015
+#define TICK_LEVEL 0.25
+static const double tick_freqs[2] = {1800.0, 1500.0};
+
+struct _AmbientNoise {
+    AmbientNoiseType type;
+    unsigned int rate;
+    int channels;
+    AmbientNoiseKernel kernel;   // Resolved
+    
+    guint32 lanes[NOISE_LANES];
+    float white[2 * NOISE_BLOCK];  // Pink draws two values per sample
+    float shaped[NOISE_BLOCK];
+    gint16 mono[NOISE_BLOCK];
+    
+    // Pink
+    float rows[PINK_ROWS];
+    float row_sum;
+    guint32 counter;
+    
+    // Brown
+    float level;
+    
+    // Tick
+    float *ticks[2];
+    gsize tick_frames;
+    guint64 position;            // Frames rendered
+};
+
+static AmbientNoiseKernel resolve_kernel(AmbientNoiseKernel kernel);
+static void white_block(AmbientNoise *noise, float *out, gsize count);
+static void to_s16(AmbientNoise *noise, gint16 *out, const float *in, gsize count);
+static void shape_pink(AmbientNoise *noise, gsize count);
+static void shape_brown(AmbientNoise *noise, gsize count);
+static void render_ticks(AmbientNoise *noise, gsize count);
+
+static inline guint32 xorshift32(guint32 x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Signed 32-bit value scaled to [-1, 1); exact in every kernel
+#define TO_UNIT (1.0f / 2147483648.0f)
+
+static void white_scalar(guint32 *lanes, float *out, gsize count) {
+    for (gsize i = 0; i < count; i += NOISE_LANES) {
+        for (int l = 0; l < NOISE_LANES; l++) {
+            lanes[l] = xorshift32(lanes[l]);
+            out[i + l] = (float)(gint32)lanes[l] * TO_UNIT;
+        }
+    }
+}
+
+static void to_s16_scalar(gint16 *out, const float *in, gsize count) {
+    for (gsize i = 0; i < count; i++) {
+        long v = lrintf(in[i] * 32768.0f);
+        out[i] = (gint16)CLAMP(v, G_MININT16, G_MAXINT16);
+    }
+}
+
+#ifdef __SSE2__
+static inline __m128i xorshift_sse2(__m128i x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+static void white_sse2(guint32 *lanes, float *out, gsize count) {
+    __m128i a = _mm_loadu_si128((const __m128i*)lanes);
+    __m128i b = _mm_loadu_si128((const __m128i*)(lanes + 4));
+    __m128 scale = _mm_set1_ps(TO_UNIT);
+    
+    for (gsize i = 0; i < count; i += NOISE_LANES) {
+        a = xorshift_sse2(a);
+        b = xorshift_sse2(b);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(a), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scale));
+    }
+    
+    _mm_storeu_si128((__m128i*)lanes, a);
+    _mm_storeu_si128((__m128i*)(lanes + 4), b);
+}
+
+// cvtps rounds to nearest even like lrintf, and packs saturates like CLAMP
+static void to_s16_sse2(gint16 *out, const float *in, gsize count) {
+    __m128 scale = _mm_set1_ps(32768.0f);
+    gsize i = 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+    
+    to_s16_scalar(out + i, in + i, count - i);
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNEL
+__attribute__((target("avx2")))
+static void white_avx2(guint32 *lanes, float *out, gsize count) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)lanes);
+    __m256 scale = _mm256_set1_ps(TO_UNIT);
+    
+    for (gsize i = 0; i < count; i += NOISE_LANES) {
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    
+    _mm256_storeu_si256((__m256i*)lanes, x);
+}
+#endif
+
+AmbientNoise* ambient_noise_new(AmbientNoiseType type, unsigned int rate, int channels, AmbientNoiseKernel kernel) {
+    if (rate == 0 || channels <= 0) return NULL;
+    
+    AmbientNoise *noise = g_malloc0(sizeof(AmbientNoise));
+    noise->type = type;
+    noise->rate = rate;
+    noise->channels = channels;
+    noise->kernel = resolve_kernel(kernel);
+    
+    // Fixed, distinct non-zero seeds: the noise is the same every session
+    for (int l = 0; l < NOISE_LANES; l++) {
+        noise->lanes[l] = 0x9e3779b9u * (guint32)(l + 1);
+    }
+    
+    if (type == AMBIENT_NOISE_TICK) {
+        noise->tick_frames = (gsize)(TICK_SECONDS * rate);
+        for (int t = 0; t < 2; t++) {
+            noise->ticks[t] = g_malloc(noise->tick_frames * sizeof(float));
+            for (gsize i = 0; i < noise->tick_frames; i++) {
+                double time = (double)i / rate;
+                noise->ticks[t][i] = (float)(TICK_LEVEL * exp(-time / TICK_DECAY_SECONDS) *
+                                             sin(2.0 * G_PI * tick_freqs[t] * time));
+            }
+        }
+    }
+    
+    return noise;
+}
+
+void ambient_noise_free(AmbientNoise *noise) {
+    if (!noise) return;
+    
+    g_free(noise->ticks[0]);
+    g_free(noise->ticks[1]);
+    g_free(noise);
+}
+
+void ambient_noise_render(AmbientNoise *noise, gint16 *out, gsize frames) {
+    if (!noise || !out) return;
+    
+    while (frames > 0) {
+        gsize count = MIN(frames, (gsize)NOISE_BLOCK);
+        
+        switch (noise->type) {
+            case AMBIENT_NOISE_WHITE:
+                white_block(noise, noise->shaped, count);
+                for (gsize i = 0; i < count; i++) noise->shaped[i] *= WHITE_GAIN;
+                break;
+            case AMBIENT_NOISE_PINK:
+                shape_pink(noise, count);
+                break;
+            case AMBIENT_NOISE_BROWN:
+                shape_brown(noise, count);
+                break;
+            case AMBIENT_NOISE_TICK:
+                render_ticks(noise, count);
+                break;
+        }
+        noise->position += count;
+        
+        if (noise->channels == 1) {
+            to_s16(noise, out, noise->shaped, count);
+        } else {
+            to_s16(noise, noise->mono, noise->shaped, count);
+            for (gsize i = 0; i < count; i++) {
+                for (int c = 0; c < noise->channels; c++) out[i * noise->channels + c] = noise->mono[i];
+            }
+        }
+        
+        out += count * noise->channels;
+        frames -= count;
+    }
+}
+
+gboolean ambient_noise_parse_type(const char *name, AmbientNoiseType *type) {
+    static const struct { const char *name; AmbientNoiseType type; } types[] = {
+        {"white", AMBIENT_NOISE_WHITE},
+        {"pink", AMBIENT_NOISE_PINK},
+        {"brown", AMBIENT_NOISE_BROWN},
+        {"tick", AMBIENT_NOISE_TICK}
+    };
+    
+    for (guint i = 0; i < G_N_ELEMENTS(types); i++) {
+        if (g_strcmp0(name, types[i].name) == 0) {
+            if (type) *type = types[i].type;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+gboolean ambient_noise_kernel_supported(AmbientNoiseKernel kernel) {
+    return simd_kernel_supported((SimdKernel)kernel, 0);
+}
+
+static AmbientNoiseKernel resolve_kernel(AmbientNoiseKernel kernel) {
+    return (AmbientNoiseKernel)simd_resolve_kernel((SimdKernel)kernel, 0);
+}
+
+const char* ambient_noise_kernel_name(AmbientNoiseKernel kernel) {
+    return simd_kernel_name((SimdKernel)kernel, 0);
+}
+
+// Draws count values, rounded up to whole lane groups
+static void white_block(AmbientNoise *noise, float *out, gsize count) {
+    count = (count + NOISE_LANES - 1) / NOISE_LANES * NOISE_LANES;
+    
+    switch (noise->kernel) {
+#ifdef HAVE_AVX2_KERNEL
+        case AMBIENT_NOISE_KERNEL_AVX2:
+            white_avx2(noise->lanes, out, count);
+            break;
+#endif
+#ifdef __SSE2__
+        case AMBIENT_NOISE_KERNEL_SSE2:
+            white_sse2(noise->lanes, out, count);
+            break;
+#endif
+        default:
+            white_scalar(noise->lanes, out, count);
+            break;
+    }
+}
+
+static void to_s16(AmbientNoise *noise, gint16 *out, const float *in, gsize count) {
+#ifdef __SSE2__
+    if (noise->kernel != AMBIENT_NOISE_KERNEL_SCALAR) {
+        to_s16_sse2(out, in, count);
+        return;
+    }
+#else
+    (void)noise; // Suppress unused parameter warning
+#endif
+    to_s16_scalar(out, in, count);
+}
+
+// Each sample redraws the row picked by the lowest set bit of a counter, so
+// row k changes every 2^(k+1) samples, and adds a fresh white value
+static void shape_pink(AmbientNoise *noise, gsize count) {
+    white_block(noise, noise->white, 2 * count);
+    
+    for (gsize i = 0; i < count; i++) {
+        guint32 counter = ++noise->counter;
+        if (counter == 0) counter = noise->counter = 1;
+        
+        int row = __builtin_ctz(counter);
+        if (row < PINK_ROWS) {
+            float value = noise->white[2 * i];
+            noise->row_sum += value - noise->rows[row];
+            noise->rows[row] = value;
+        } else {
+            // Every 2^PINK_ROWS samples: drop the rounding error the running
+            // sum has picked up
+            noise->row_sum = 0.0f;
+            for (int r = 0; r < PINK_ROWS; r++) noise->row_sum += noise->rows[r];
+        }
+        noise->shaped[i] = (noise->row_sum + noise->white[2 * i + 1]) * PINK_GAIN;
+    }
+}
+
+static void shape_brown(AmbientNoise *noise, gsize count) {
+    white_block(noise, noise->white, count);
+    
+    float level = noise->level;
+    for (gsize i = 0; i < count; i++) {
+        level = level * BROWN_LEAK + noise->white[i] * BROWN_STEP;
+        noise->shaped[i] = level * BROWN_GAIN;
+    }
+    noise->level = level;
+}
+
+// Silence except for a tick at the start of every second
+static void render_ticks(AmbientNoise *noise, gsize count) {
+    memset(noise->shaped, 0, count * sizeof(float));
+    
+    for (gsize i = 0; i < count; i++) {
+        guint64 frame = noise->position + i;
+        gsize offset = (gsize)(frame % noise->rate);
+        if (offset < noise->tick_frames) {
+            noise->shaped[i] = noise->ticks[(frame / noise->rate) & 1][offset];
+        }
+    }
+}
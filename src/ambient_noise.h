@@ -0,0 +1,73 @@
+#ifndef AMBIENT_NOISE_H
+#define AMBIENT_NOISE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AmbientNoise AmbientNoise;
+
+typedef enum {
+    AMBIENT_NOISE_WHITE,
+    AMBIENT_NOISE_PINK,          // Voss-McCartney, -3 dB/octave
+    AMBIENT_NOISE_BROWN,         // Leaky integrator, -6 dB/octave
+    AMBIENT_NOISE_TICK           // Soft clock tick once a second
+} AmbientNoiseType;
+
+typedef enum {
+    AMBIENT_NOISE_KERNEL_AUTO,   // Best kernel the CPU supports
+    AMBIENT_NOISE_KERNEL_SCALAR,
+    AMBIENT_NOISE_KERNEL_SSE2,
+    AMBIENT_NOISE_KERNEL_AVX2
+} AmbientNoiseKernel;
+
+/**
+ * Creates an endless noise generator. Noise is rendered at a soft, fixed
+ * level (about -25 dBFS RMS); scale it on output for the volume.
+ * @param type Kind of noise
+ * @param rate Sample rate in Hz
+ * @param channels Number of interleaved channels, all carrying the same signal
+ * @param kernel Kernel to use; AUTO picks the fastest supported one
+ * @return New AmbientNoise instance
+ */
+AmbientNoise* ambient_noise_new(AmbientNoiseType type, unsigned int rate, int channels, AmbientNoiseKernel kernel);
+
+/**
+ * Frees a generator
+ * @param noise AmbientNoise instance to free
+ */
+void ambient_noise_free(AmbientNoise *noise);
+
+/**
+ * Renders the next frames. All kernels produce identical output.
+ * @param noise AmbientNoise instance
+ * @param out Destination for frames * channels signed 16-bit samples
+ * @param frames Number of frames
+ */
+void ambient_noise_render(AmbientNoise *noise, gint16 *out, gsize frames);
+
+/**
+ * Looks up a noise type by its settings name
+ * @param name "white", "pink", "brown" or "tick"
+ * @param type Filled with the type if found
+ * @return TRUE if name is a noise type
+ */
+gboolean ambient_noise_parse_type(const char *name, AmbientNoiseType *type);
+
+/**
+ * Checks whether a kernel can run on this CPU
+ * @param kernel Kernel to check
+ * @return TRUE if supported
+ */
+gboolean ambient_noise_kernel_supported(AmbientNoiseKernel kernel);
+
+/**
+ * Gets a kernel's name
+ * @param kernel Kernel, AUTO resolves to the one that would be used
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char* ambient_noise_kernel_name(AmbientNoiseKernel kernel);
+
+G_END_DECLS
+
+#endif // AMBIENT_NOISE_H
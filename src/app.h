@@ -4,7 +4,10 @@
 #include <gtk/gtk.h>
 #include "tray_icon.h"
 #include "timer.h"
+#include "timer_group.h"
+#include "timer_snapshot.h"
 #include "tray_status_icon.h"
+#include "status_notifier.h"
 #include "audio.h"
 #include "settings_dialog.h"
 #include "break_overlay.h"
@@ -20,6 +23,9 @@ typedef struct {
     gboolean test_mode;          // TRUE if custom durations provided
 } CmdLineArgs;
 
+// Name of the main pomodoro timer within GomodaroApp.timers
+#define APP_MAIN_TIMER_NAME "pomodoro"
+
 typedef struct {
     GtkWidget *window;
     GtkWidget *time_label;
@@ -33,7 +39,10 @@ typedef struct {
     
     TrayIcon *tray_icon;
     TrayStatusIcon *status_tray;
-    Timer *timer;
+    StatusNotifier *status_notifier; // StatusNotifierItem tray, preferred when a watcher is running
+    Timer *timer;                // Main pomodoro timer (owned by timers)
+    TimerGroup *timers;          // All named timers, sharing one timing wheel
+    TimerSnapshot *snapshot;     // Crash-safe copy of the main timer's state (NULL in test mode)
     AudioManager *audio;
     Settings *settings;
     BreakOverlay *break_overlay;
@@ -43,6 +52,11 @@ typedef struct {
     CmdLineArgs *args;           // Command line arguments
     guint idle_check_source;     // Idle detection timer source
     gboolean paused_by_idle;     // Track if timer was paused due to idle
+    gboolean restoring;          // Replaying a restored snapshot, suppress sounds
+    guint window_tick_subscription;  // 1 s timer ticks while the main window is shown
+    guint overlay_tick_subscription; // 1 s timer ticks while the break overlay is shown
+    guint tray_redraw_source;        // One-shot redraw when the tray icon next changes
+    gint64 tray_redraw_due_ms;       // Monotonic time tray_redraw_source fires at
 } GomodaroApp;
 
 #endif // APP_H
@@ -1,58 +1,175 @@
 #define _GNU_SOURCE
 #include "audio.h"
+#include "ambient_noise.h"
+#include "audio_synth.h"
+#include "audio_worker.h"
+#include "loudness_meter.h"
+#include "sound_cache.h"
+#include "sound_decoder.h"
 #include <glib.h>
-#include <math.h>
-#include <alsa/asoundlib.h>
-#include <pthread.h>
-#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 #include <unistd.h>
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
-#include <stdint.h>
+#include <math.h>
 
 #define SAMPLE_RATE 44100
 #define CHANNELS 1
-#define BUFFER_SIZE 4096
 
-// WAV file header structure
+// External players running at once when there is no device to play on
+#define MAX_EXTERNAL_PLAYERS 4
+
+// Background work: chime preparation and custom sound decoding. Every job
+// is keyed by what it prepares, so a newer request replaces a waiting one
+// and the queue holds at most one job per sound; the bound is a backstop.
+#define AUDIO_WORKERS 2
+#define AUDIO_WORK_QUEUE 16
+#define WORK_KEY_CHIMES 1
+#define WORK_KEY_CUSTOM(index) (2 + (guint64)(index))
+
+// How long background preparation waits for the engine to report its rate
+#define PREPARE_RATE_WAIT_MS 2000
+
+// Custom sounds are cut off after this long
+#define MAX_CUSTOM_SOUND_SECONDS 60
+
+// Custom sounds are normalized to the loudness of the built-in chimes
+// (-29 to -27 LUFS). Stored in the sound cache with each sound's gain, so
+// bump SOUND_CACHE_VERSION when changing these.
+#define LOUDNESS_TARGET_LUFS -28.0
+#define LOUDNESS_MAX_BOOST_DB 12.0
+
+// Spacing between the starts of sounds requested back to back, so that e.g.
+// session complete followed by break start plays as a short sequence
+#define SOUND_STAGGER_MS 250
+
+// Requests faster than the stagger, e.g. a hotkey toggling the timer, are
+// not queued up ever further ahead: nothing starts later than this
+#define SOUND_BACKLOG_MS 1000
+
+// Chime envelope shared by all generated sounds (seconds, sustain level)
 typedef struct {
-    char riff[4];           // "RIFF"
-    uint32_t size;          // File size - 8
-    char wave[4];           // "WAVE"
-    char fmt[4];            // "fmt "
-    uint32_t fmt_size;      // Format chunk size (16)
-    uint16_t format;        // Audio format (1 = PCM)
-    uint16_t channels;      // Number of channels
-    uint32_t sample_rate;   // Sample rate
-    uint32_t byte_rate;     // Bytes per second
-    uint16_t block_align;   // Bytes per sample * channels
-    uint16_t bits_per_sample; // Bits per sample
-    char data[4];           // "data"
-    uint32_t data_size;     // Data size
-} WavHeader;
+    float duration;
+    float attack;
+    float decay;
+    float sustain;
+    float release;
+    float headroom;         // Output scale that keeps the chord from clipping
+} ChimeEnvelope;
 
+// Everything that determines a generated sound's samples. Chimes are cached
+// under a hash of these (and the format), so editing them regenerates them.
 typedef struct {
-    short *buffer;
-    int samples;
-    double volume;
-} SoundData;
+    const char *name;
+    float freq[3];
+    float amp[3];
+} ChimeParams;
+
+static const ChimeEnvelope chime_envelope = {
+    0.5f,   // 500ms
+    0.01f,  // 10ms
+    0.05f,  // 50ms
+    0.3f,   // 30% level
+    0.2f,   // 200ms
+    0.3f
+};
+
+static const ChimeParams chime_params[] = {
+    // Major chord C4-E4-G4
+    {"work_start",       {261.63f, 329.63f, 392.00f}, {1.0f, 0.8f, 0.6f}},
+    // Minor chord A3-C4-E4
+    {"break_start",      {220.00f, 261.63f, 329.63f}, {1.0f, 0.8f, 0.6f}},
+    // Perfect fifth C4-G4-C5
+    {"session_complete", {261.63f, 392.00f, 523.25f}, {1.0f, 0.8f, 0.5f}},
+    // Same as break with different mix
+    {"long_break_start", {220.00f, 261.63f, 329.63f}, {1.2f, 1.0f, 0.8f}},
+    // Octave A4-A5
+    {"timer_finish",     {440.00f, 880.00f, 0.0f},    {1.0f, 0.5f, 0.0f}},
+    // Descending F4-D4
+    {"idle_pause",       {349.23f, 293.66f, 0.0f},    {0.8f, 0.6f, 0.0f}},
+    // Ascending D4-F4
+    {"idle_resume",      {293.66f, 349.23f, 0.0f},    {0.6f, 0.8f, 0.0f}}
+};
+
+#define CHIME_COUNT G_N_ELEMENTS(chime_params)
+
+// A generated sound at unit gain; volume is applied by the engine
+typedef struct {
+    GBytes *samples;        // Usually mapped from the sound cache
+    guint64 key;            // Sound cache key: parameters and format
+} ChimeCacheEntry;
+
+// A user-chosen sound file played instead of a chime
+typedef struct {
+    char *path;             // Source file, NULL to play the chime
+    GBytes *samples;        // Decoded at the output rate, NULL until ready
+    char *file;             // The decoded WAV file, for the external player
+    double gain;            // Loudness normalization, folded into the play gain
+    guint generation;       // Bumped on every change; older decodes are dropped
+} CustomSound;
+
+// A custom sound waiting to be decoded
+typedef struct {
+    int index;
+    char *path;
+    guint generation;
+} DecodeJob;
+
+// An external player process, reaped through a child watch
+typedef struct {
+    GPid pid;
+    guint watch;
+} ExternalPlayer;
 
 struct _AudioManager {
     double volume;
     gboolean enabled;
-    gboolean use_aplay;  // TRUE if aplay is available and should be used
+    AudioEngine *engine;  // Playback thread owning the ALSA device
+    SoundCache *sound_cache;
+    GMutex chimes_lock;   // chimes[] and custom[] are filled by background threads
+    ChimeCacheEntry chimes[CHIME_COUNT];
+    CustomSound custom[CHIME_COUNT];
+    AudioWorkerPool *workers;
+    gint stopping;
+    char *external_player;  // aplay, used only if the engine has no device
+    ExternalPlayer players[MAX_EXTERNAL_PLAYERS];
+    gint64 last_start_us;  // Scheduled start of the last sound played
+    gint64 sound_start_us[CHIME_COUNT];  // Scheduled start of each sound
+    guint plays;
+    guint plays_coalesced;
+    guint plays_dropped;
+    
+    // Background noise during work sessions
+    gboolean ambient_selected;
+    AmbientNoiseType ambient_type;
+    gboolean ambient_wanted;
+    gboolean ambient_playing;
+    AmbientNoiseType playing_type;  // What the engine's stream was started with
+    guint playing_gain;
 };
 
-static void* play_sound_thread(void *data);
-static void* play_sound_aplay_thread(void *data);
 static void play_sound_async(AudioManager *audio, const char *sound_type);
-static SoundData* generate_chime(const char *sound_type, double volume);
-static void free_sound_data(SoundData *data);
-static gboolean check_aplay_available(void);
-static void generate_wav_files(void);
-static void write_wav_file(const char *filename, short *buffer, int samples);
-static const char* get_wav_filename(const char *sound_type);
+static void update_ambient(AudioManager *audio);
+static void render_ambient(gint16 *out, gsize frames, gpointer user_data);
+static int find_chime(const char *sound_type);
+static void chime_to_patch(const ChimeParams *params, AudioSynthPatch *patch);
+static guint64 chime_key(int index, unsigned int rate);
+static unsigned int get_output_rate(AudioManager *audio);
+static GBytes* get_chime(AudioManager *audio, int index);
+static GBytes* load_chime(AudioManager *audio, int index, unsigned int rate, guint64 key, gboolean store);
+static void publish_chime(AudioManager *audio, int index, guint64 key, GBytes *samples);
+static void prepare_chimes(gpointer data, gpointer user_data);
+static gboolean wait_for_engine(AudioManager *audio);
+static GBytes* get_custom_sound(AudioManager *audio, int index, double *gain);
+static GBytes* load_custom_sound(AudioManager *audio, const char *path, unsigned int rate, char **file, double *gain);
+static double measure_gain(LoudnessMeter *meter, const char *path);
+static void decode_custom_sound(gpointer data, gpointer user_data);
+static void free_decode_job(gpointer data);
+static void play_external(AudioManager *audio, int index);
+static void on_external_player_exit(GPid pid, gint status, gpointer user_data);
 
 AudioManager* audio_manager_new(void) {
     AudioManager *audio = g_malloc0(sizeof(AudioManager));
@@ -61,21 +178,56 @@ AudioManager* audio_manager_new(void) {
     audio->volume = 0.7;  // 70% volume
     audio->enabled = TRUE;
     
-    // Check if aplay is available
-    audio->use_aplay = check_aplay_available();
-    if (audio->use_aplay) {
-        g_print("Audio: Using aplay for sound playback\n");
-        // Generate WAV files if using aplay
-        generate_wav_files();
-    } else {
-        g_print("Audio: Using ALSA for sound playback\n");
+    // Sounds play in-process; aplay is only a fallback without a device.
+    // COMMODORO_AUDIO_SINK replaces the device, e.g. "null" on hosts
+    // without a sound card or "capture:FILE" to record the output.
+    const char *sink_spec = g_getenv("COMMODORO_AUDIO_SINK");
+    AudioSink *sink = audio_sink_new_from_spec(sink_spec);
+    if (!sink) {
+        g_warning("Unknown audio sink '%s', using ALSA", sink_spec);
+        sink = audio_sink_new_alsa();
     }
+    g_print("Audio: Using %s for sound playback\n", audio_sink_get_name(sink));
+    audio->engine = audio_engine_new(sink, SAMPLE_RATE, CHANNELS);
+    audio->external_player = g_find_program_in_path("aplay");
+    audio->sound_cache = sound_cache_new();
+    g_mutex_init(&audio->chimes_lock);
+    
+    // Chimes are mapped from the cache, or rendered and stored, off the
+    // main thread so startup never waits for synthesis or disk writes
+    audio->workers = audio_worker_pool_new("audio-worker", AUDIO_WORKERS, AUDIO_WORK_QUEUE, AUDIO_WORK_DROP_NEWEST, audio);
+    audio_worker_pool_push(audio->workers, prepare_chimes, NULL, NULL, WORK_KEY_CHIMES);
     
     return audio;
 }
 
 void audio_manager_free(AudioManager *audio) {
     if (!audio) return;
+    
+    // Running jobs see stopping and return at once; waiting ones are dropped
+    g_atomic_int_set(&audio->stopping, TRUE);
+    audio_worker_pool_free(audio->workers);
+    
+    audio_engine_free(audio->engine);
+    for (guint i = 0; i < CHIME_COUNT; i++) {
+        if (audio->chimes[i].samples) g_bytes_unref(audio->chimes[i].samples);
+        if (audio->custom[i].samples) g_bytes_unref(audio->custom[i].samples);
+        g_free(audio->custom[i].path);
+        g_free(audio->custom[i].file);
+    }
+    g_mutex_clear(&audio->chimes_lock);
+    sound_cache_free(audio->sound_cache);
+    
+    // Stop and reap players still running; their watches die with us
+    for (int i = 0; i < MAX_EXTERNAL_PLAYERS; i++) {
+        ExternalPlayer *player = &audio->players[i];
+        if (!player->pid) continue;
+        g_source_remove(player->watch);
+        kill(player->pid, SIGTERM);
+        waitpid(player->pid, NULL, 0);
+        g_spawn_close_pid(player->pid);
+    }
+    g_free(audio->external_player);
     g_free(audio);
 }
 
@@ -124,337 +276,476 @@ void audio_manager_set_volume(AudioManager *audio, double volume) {
     g_print("Setting audio volume to %.2f (%.0f%%)\n", volume, volume * 100);
     
     audio->volume = volume;
+    update_ambient(audio);
 }
 
 void audio_manager_set_enabled(AudioManager *audio, gboolean enabled) {
     if (!audio) return;
     audio->enabled = enabled;
+    update_ambient(audio);
 }
 
-static void* play_sound_thread(void *data) {
-    SoundData *sound = (SoundData*)data;
+void audio_manager_set_ambient_noise(AudioManager *audio, const char *type) {
+    if (!audio) return;
     
-    snd_pcm_t *handle;
-    int err;
+    audio->ambient_selected = ambient_noise_parse_type(type, &audio->ambient_type);
+    if (!audio->ambient_selected && type && g_strcmp0(type, "off") != 0) {
+        g_warning("Unknown ambient noise: %s", type);
+    }
+    update_ambient(audio);
+}
+
+void audio_manager_set_ambient_playing(AudioManager *audio, gboolean playing) {
+    if (!audio) return;
     
-    // Open PCM device - try different devices in order of preference
-    const char* devices[] = {"pipewire", "plughw:0,0", "default", "dmix"};
-    int device_found = 0;
+    audio->ambient_wanted = playing;
+    update_ambient(audio);
+}
+
+void audio_manager_set_custom_sound(AudioManager *audio, const char *sound_name, const char *path) {
+    if (!audio) return;
     
-    for (int i = 0; i < 4; i++) {
-        if ((err = snd_pcm_open(&handle, devices[i], SND_PCM_STREAM_PLAYBACK, 0)) >= 0) {
-            device_found = 1;
-            break;
-        }
+    int index = find_chime(sound_name);
+    if (index < 0) {
+        g_warning("Unknown sound: %s", sound_name);
+        return;
     }
-    
-    if (!device_found) {
-        g_warning("Cannot open any audio device");
-        free_sound_data(sound);
-        return NULL;
+    if (path && !*path) path = NULL;
+    
+    CustomSound *custom = &audio->custom[index];
+    
+    g_mutex_lock(&audio->chimes_lock);
+    if (g_strcmp0(custom->path, path) != 0) {
+        // The chime plays until the new file is decoded
+        g_free(custom->path);
+        g_free(custom->file);
+        if (custom->samples) g_bytes_unref(custom->samples);
+        custom->path = g_strdup(path);
+        custom->file = NULL;
+        custom->samples = NULL;
+        custom->generation++;
     }
+    guint generation = custom->generation;
+    g_mutex_unlock(&audio->chimes_lock);
+    
+    if (!path) return;
+    
+    // Also for an unchanged path: the file may have been edited, and an
+    // unchanged file is found in the sound cache
+    DecodeJob *job = g_malloc0(sizeof(DecodeJob));
+    job->index = index;
+    job->path = g_strdup(path);
+    job->generation = generation;
+    if (!audio_worker_pool_push(audio->workers, decode_custom_sound, job, free_decode_job, WORK_KEY_CUSTOM(index))) {
+        g_warning("Audio work queue full, not decoding %s", path);
+    }
+}
+
+void audio_manager_get_latency_stats(AudioManager *audio, AudioLatencyStats *stats) {
+    audio_engine_get_latency_stats(audio ? audio->engine : NULL, stats);
+}
+
+void audio_manager_get_request_stats(AudioManager *audio, AudioRequestStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(AudioRequestStats));
+    if (!audio) return;
     
-    // Set parameters
-    snd_pcm_hw_params_t *params;
-    snd_pcm_hw_params_alloca(&params);
+    stats->plays = audio->plays;
+    stats->plays_coalesced = audio->plays_coalesced;
+    stats->plays_dropped = audio->plays_dropped;
+    audio_worker_pool_get_stats(audio->workers, &stats->work);
+}
+
+static void play_sound_async(AudioManager *audio, const char *sound_type) {
+    if (!audio) return;
     
-    if ((err = snd_pcm_hw_params_any(handle, params)) < 0) {
-        g_warning("Cannot initialize hardware parameters: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
+    int index = find_chime(sound_type);
+    if (index < 0) {
+        g_warning("Unknown sound: %s", sound_type);
+        return;
     }
     
-    // Set access type
-    if ((err = snd_pcm_hw_params_set_access(handle, params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0) {
-        g_warning("Cannot set access type: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
+    if (audio_engine_get_status(audio->engine) == AUDIO_ENGINE_NO_DEVICE) {
+        play_external(audio, index);
+        return;
     }
     
-    // Set sample format to S16_LE which is more widely supported
-    if ((err = snd_pcm_hw_params_set_format(handle, params, SND_PCM_FORMAT_S16_LE)) < 0) {
-        g_warning("Cannot set sample format: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
-    }
+    // The engine mixes overlapping sounds; offset the start only if the
+    // previous sound has only just begun. A repeat of a sound that hasn't
+    // started yet is merged into it, and a sound that would start too far
+    // ahead is dropped.
+    gint64 now = g_get_monotonic_time();
+    gint64 start_us = MAX(now, audio->last_start_us + SOUND_STAGGER_MS * 1000);
     
-    // Set channels
-    if ((err = snd_pcm_hw_params_set_channels(handle, params, CHANNELS)) < 0) {
-        g_warning("Cannot set channel count: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
+    if (audio->sound_start_us[index] > now) {
+        audio->plays_coalesced++;
+        return;
     }
-    
-    // Set sample rate
-    unsigned int rate = SAMPLE_RATE;
-    if ((err = snd_pcm_hw_params_set_rate_near(handle, params, &rate, 0)) < 0) {
-        g_warning("Cannot set sample rate: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
+    if (start_us - now > SOUND_BACKLOG_MS * 1000) {
+        audio->plays_dropped++;
+        return;
     }
     
-    if ((err = snd_pcm_hw_params(handle, params)) < 0) {
-        g_warning("Cannot set audio parameters: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
+    double normalize = 1.0;
+    GBytes *samples = get_custom_sound(audio, index, &normalize);
+    if (!samples) samples = get_chime(audio, index);
+    if (!samples) {
+        g_warning("Failed to generate sound for: %s", sound_type);
+        return;
     }
     
-    // Prepare the PCM for playback
-    if ((err = snd_pcm_prepare(handle)) < 0) {
-        g_warning("Cannot prepare audio interface: %s", snd_strerror(err));
-        snd_pcm_close(handle);
-        free_sound_data(sound);
-        return NULL;
-    }
+    // Q15 gain applied while the engine mixes the samples, so loudness
+    // normalization costs nothing extra
+    guint gain = (guint)(audio->volume * normalize * AUDIO_GAIN_UNITY + 0.5);
     
-    // Play the sound
-    int remaining = sound->samples;
-    short *ptr = sound->buffer;
+    if (audio_engine_play_at(audio->engine, samples, gain, start_us)) {
+        audio->last_start_us = start_us;
+        audio->sound_start_us[index] = start_us;
+        audio->plays++;
+    } else {
+        g_warning("Audio queue full, dropping sound: %s", sound_type);
+        audio->plays_dropped++;
+    }
+    g_bytes_unref(samples);
+}
+
+// Brings the engine's stream in line with the settings and the timer state;
+// a change of noise or volume crossfades to a new generator
+static void update_ambient(AudioManager *audio) {
+    gboolean play = audio->ambient_wanted && audio->ambient_selected && audio->enabled &&
+                    audio_engine_get_status(audio->engine) != AUDIO_ENGINE_NO_DEVICE;
+    guint gain = (guint)(audio->volume * AUDIO_GAIN_UNITY + 0.5);
+    
+    if (!play) {
+        if (audio->ambient_playing) audio_engine_set_stream(audio->engine, NULL, NULL, NULL, 0);
+        audio->ambient_playing = FALSE;
+        return;
+    }
+    if (audio->ambient_playing && audio->playing_type == audio->ambient_type && audio->playing_gain == gain) {
+        return;
+    }
     
-    while (remaining > 0) {
-        int frames = remaining > BUFFER_SIZE ? BUFFER_SIZE : remaining;
-        err = snd_pcm_writei(handle, ptr, frames);
-        
-        if (err == -EPIPE) {
-            // Underrun occurred
-            snd_pcm_prepare(handle);
-        } else if (err < 0) {
-            g_warning("Write error: %s", snd_strerror(err));
-            break;
-        } else {
-            ptr += err * CHANNELS;
-            remaining -= err;
-        }
+    // The rate only matters for the tick spacing; before the device is open
+    // the requested rate is the best guess
+    unsigned int rate = audio_engine_get_rate(audio->engine);
+    AmbientNoise *noise = ambient_noise_new(audio->ambient_type, rate ? rate : SAMPLE_RATE, CHANNELS, AMBIENT_NOISE_KERNEL_AUTO);
+    audio->ambient_playing = audio_engine_set_stream(audio->engine, render_ambient, noise,
+                                                     (GDestroyNotify)ambient_noise_free, gain);
+    audio->playing_type = audio->ambient_type;
+    audio->playing_gain = gain;
+}
+
+static void render_ambient(gint16 *out, gsize frames, gpointer user_data) {
+    ambient_noise_render((AmbientNoise*)user_data, out, frames);
+}
+
+static int find_chime(const char *sound_type) {
+    for (guint i = 0; i < CHIME_COUNT; i++) {
+        if (g_strcmp0(chime_params[i].name, sound_type) == 0) return (int)i;
+    }
+    return -1;
+}
+
+static void chime_to_patch(const ChimeParams *params, AudioSynthPatch *patch) {
+    const ChimeEnvelope *env = &chime_envelope;
+    
+    // Zeroed so unused slots hash the same every time
+    memset(patch, 0, sizeof(AudioSynthPatch));
+    patch->duration = env->duration;
+    patch->gain = env->headroom;
+    
+    for (int p = 0; p < 3; p++) {
+        if (params->freq[p] <= 0) continue;
+        patch->partials[patch->partial_count].freq = params->freq[p];
+        patch->partials[patch->partial_count].amp = params->amp[p];
+        patch->partial_count++;
     }
     
-    // Drain and close
-    snd_pcm_drain(handle);
-    snd_pcm_close(handle);
+    // ADSR as breakpoints: attack, decay to sustain, hold, release
+    const AudioSynthPoint points[] = {
+        {0.0f, 0.0f},
+        {env->attack, 1.0f},
+        {env->attack + env->decay, env->sustain},
+        {env->duration - env->release, env->sustain},
+        {env->duration, 0.0f}
+    };
+    patch->point_count = G_N_ELEMENTS(points);
+    memcpy(patch->envelope, points, sizeof(points));
+}
+
+static guint64 chime_key(int index, unsigned int rate) {
+    AudioSynthPatch patch;
+    chime_to_patch(&chime_params[index], &patch);
+    return sound_cache_key(&patch, sizeof(patch), rate, CHANNELS);
+}
+
+static unsigned int get_output_rate(AudioManager *audio) {
+    // Chimes are made at the rate the device was opened with, so nothing is
+    // converted on the way out
+    unsigned int rate = audio_engine_get_rate(audio->engine);
+    return rate ? rate : SAMPLE_RATE;
+}
+
+static GBytes* get_chime(AudioManager *audio, int index) {
+    unsigned int rate = get_output_rate(audio);
+    guint64 key = chime_key(index, rate);
+    ChimeCacheEntry *entry = &audio->chimes[index];
+    GBytes *samples = NULL;
+    
+    g_mutex_lock(&audio->chimes_lock);
+    if (entry->samples && entry->key == key) {
+        samples = g_bytes_ref(entry->samples);
+    }
+    g_mutex_unlock(&audio->chimes_lock);
+    if (samples) return samples;
     
-    free_sound_data(sound);
-    return NULL;
+    // Not prepared yet: map or render now, leave storing to the prepare thread
+    samples = load_chime(audio, index, rate, key, FALSE);
+    publish_chime(audio, index, key, samples);
+    return samples;
 }
 
-static void play_sound_async(AudioManager *audio, const char *sound_type) {
-    if (!audio) return;
+static GBytes* load_chime(AudioManager *audio, int index, unsigned int rate, guint64 key, gboolean store) {
+    AudioSynthPatch patch;
+    chime_to_patch(&chime_params[index], &patch);
+    gsize expected = audio_synth_get_length(&patch, rate) * CHANNELS * sizeof(gint16);
+    
+    GBytes *samples = sound_cache_lookup(audio->sound_cache, key, rate, CHANNELS);
+    if (samples && g_bytes_get_size(samples) != expected) {
+        g_bytes_unref(samples);  // Truncated or otherwise damaged
+        samples = NULL;
+    }
     
-    if (audio->use_aplay) {
-        // Use aplay to play pre-generated WAV file
-        const char *wav_file = get_wav_filename(sound_type);
-        
-        pthread_t thread;
-        pthread_attr_t attr;
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-        
-        char *filename = g_strdup(wav_file);
-        if (pthread_create(&thread, &attr, play_sound_aplay_thread, filename) != 0) {
-            g_warning("Failed to create aplay thread");
-            g_free(filename);
-        }
-        
-        pthread_attr_destroy(&attr);
-    } else {
-        // Use ALSA backend
-        SoundData *sound = generate_chime(sound_type, audio->volume);
-        if (!sound) {
-            g_warning("Failed to generate sound for: %s", sound_type);
-            return;
-        }
-        
-        pthread_t thread;
-        pthread_attr_t attr;
-        pthread_attr_init(&attr);
-        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-        
-        if (pthread_create(&thread, &attr, play_sound_thread, sound) != 0) {
-            g_warning("Failed to create audio thread");
-            free_sound_data(sound);
-        }
-        
-        pthread_attr_destroy(&attr);
-    }
-}
-
-static SoundData* generate_chime(const char *sound_type, double volume) {
-    SoundData *sound = g_malloc(sizeof(SoundData));
-    sound->volume = volume;
-    
-    // Duration and envelope parameters
-    float duration = 0.5f;  // 500ms
-    sound->samples = (int)(duration * SAMPLE_RATE);
-    sound->buffer = g_malloc(sound->samples * sizeof(short));
-    
-    // ADSR envelope parameters
-    float attack = 0.01f;   // 10ms
-    float decay = 0.05f;    // 50ms  
-    float sustain = 0.3f;   // 30% level
-    float release = 0.2f;   // 200ms
-    
-    int attack_samples = (int)(attack * SAMPLE_RATE);
-    int decay_samples = (int)(decay * SAMPLE_RATE);
-    int release_samples = (int)(release * SAMPLE_RATE);
-    
-    // Frequency combinations for different sounds
-    float freq1 = 440.0f, freq2 = 0.0f, freq3 = 0.0f;
-    float amp1 = 1.0f, amp2 = 0.0f, amp3 = 0.0f;
-    
-    if (g_strcmp0(sound_type, "work_start") == 0) {
-        // Major chord C4-E4-G4
-        freq1 = 261.63f; amp1 = 1.0f;
-        freq2 = 329.63f; amp2 = 0.8f;
-        freq3 = 392.00f; amp3 = 0.6f;
-    } else if (g_strcmp0(sound_type, "break_start") == 0) {
-        // Minor chord A3-C4-E4
-        freq1 = 220.00f; amp1 = 1.0f;
-        freq2 = 261.63f; amp2 = 0.8f;
-        freq3 = 329.63f; amp3 = 0.6f;
-    } else if (g_strcmp0(sound_type, "session_complete") == 0) {
-        // Perfect fifth C4-G4-C5
-        freq1 = 261.63f; amp1 = 1.0f;
-        freq2 = 392.00f; amp2 = 0.8f;
-        freq3 = 523.25f; amp3 = 0.5f;
-    } else if (g_strcmp0(sound_type, "long_break_start") == 0) {
-        // Same as break with different mix
-        freq1 = 220.00f; amp1 = 1.2f;
-        freq2 = 261.63f; amp2 = 1.0f;
-        freq3 = 329.63f; amp3 = 0.8f;
-    } else if (g_strcmp0(sound_type, "timer_finish") == 0) {
-        // Octave A4-A5
-        freq1 = 440.00f; amp1 = 1.0f;
-        freq2 = 880.00f; amp2 = 0.5f;
-    } else if (g_strcmp0(sound_type, "idle_pause") == 0) {
-        // Descending F4-D4
-        freq1 = 349.23f; amp1 = 0.8f;
-        freq2 = 293.66f; amp2 = 0.6f;
-    } else if (g_strcmp0(sound_type, "idle_resume") == 0) {
-        // Ascending D4-F4
-        freq1 = 293.66f; amp1 = 0.6f;
-        freq2 = 349.23f; amp2 = 0.8f;
-    }
-    
-    // Generate the waveform
-    for (int i = 0; i < sound->samples; i++) {
-        float t = (float)i / SAMPLE_RATE;
-        
-        // Calculate envelope
-        float envelope = 0.0f;
-        if (i < attack_samples) {
-            envelope = (float)i / attack_samples;
-        } else if (i < attack_samples + decay_samples) {
-            float decay_progress = (float)(i - attack_samples) / decay_samples;
-            envelope = 1.0f - decay_progress * (1.0f - sustain);
-        } else if (i < sound->samples - release_samples) {
-            envelope = sustain;
-        } else {
-            float release_progress = (float)(i - (sound->samples - release_samples)) / release_samples;
-            envelope = sustain * (1.0f - release_progress);
-        }
-        
-        // Generate the multi-tone waveform
-        float sample = 0.0f;
-        sample += amp1 * sinf(2.0f * M_PI * freq1 * t);
-        if (freq2 > 0) sample += amp2 * sinf(2.0f * M_PI * freq2 * t);
-        if (freq3 > 0) sample += amp3 * sinf(2.0f * M_PI * freq3 * t);
-        
-        // Normalize and apply envelope
-        float total_amp = amp1 + (freq2 > 0 ? amp2 : 0) + (freq3 > 0 ? amp3 : 0);
-        sample = (sample / total_amp) * envelope * volume * 0.3f;  // Scale down to prevent clipping
-        
-        // Convert to 16-bit signed integer
-        sound->buffer[i] = (short)(sample * 32767.0f);
+    if (!samples) {
+        samples = audio_synth_render_bytes(&patch, rate);
+        if (store) sound_cache_store(audio->sound_cache, key, samples, rate, CHANNELS);
     }
     
-    return sound;
+    return samples;
 }
 
-static void free_sound_data(SoundData *data) {
-    if (data) {
-        g_free(data->buffer);
-        g_free(data);
+static void publish_chime(AudioManager *audio, int index, guint64 key, GBytes *samples) {
+    ChimeCacheEntry *entry = &audio->chimes[index];
+    
+    g_mutex_lock(&audio->chimes_lock);
+    if (!entry->samples || entry->key != key) {
+        if (entry->samples) g_bytes_unref(entry->samples);
+        entry->samples = g_bytes_ref(samples);
+        entry->key = key;
     }
+    g_mutex_unlock(&audio->chimes_lock);
 }
 
-static gboolean check_aplay_available(void) {
-    // Check if aplay command exists
-    return g_find_program_in_path("aplay") != NULL;
+static void prepare_chimes(gpointer data, gpointer user_data) {
+    (void)data; // Suppress unused parameter warning
+    AudioManager *audio = (AudioManager*)user_data;
+    if (!wait_for_engine(audio)) return;
+    
+    unsigned int rate = get_output_rate(audio);
+    for (guint i = 0; i < CHIME_COUNT; i++) {
+        if (g_atomic_int_get(&audio->stopping)) break;
+        
+        guint64 key = chime_key(i, rate);
+        GBytes *samples = load_chime(audio, i, rate, key, TRUE);
+        publish_chime(audio, i, key, samples);
+        g_bytes_unref(samples);
+    }
 }
 
-static const char* get_wav_filename(const char *sound_type) {
-    static char filename[256];
-    snprintf(filename, sizeof(filename), "/tmp/commodoro_%s.wav", sound_type);
-    return filename;
+static gboolean wait_for_engine(AudioManager *audio) {
+    // The device rate is known once the engine has probed it
+    for (int waited = 0; waited < PREPARE_RATE_WAIT_MS; waited += 10) {
+        if (g_atomic_int_get(&audio->stopping)) return FALSE;
+        if (audio_engine_get_status(audio->engine) != AUDIO_ENGINE_STARTING) break;
+        g_usleep(10 * 1000);
+    }
+    return !g_atomic_int_get(&audio->stopping);
 }
 
-static void write_wav_file(const char *filename, short *buffer, int samples) {
-    FILE *fp = fopen(filename, "wb");
-    if (!fp) {
-        g_warning("Failed to create WAV file: %s", filename);
-        return;
+static GBytes* get_custom_sound(AudioManager *audio, int index, double *gain) {
+    CustomSound *custom = &audio->custom[index];
+    GBytes *samples = NULL;
+    
+    g_mutex_lock(&audio->chimes_lock);
+    if (custom->samples) {
+        samples = g_bytes_ref(custom->samples);
+        *gain = custom->gain;
     }
+    g_mutex_unlock(&audio->chimes_lock);
     
-    // Prepare WAV header
-    WavHeader header;
-    memcpy(header.riff, "RIFF", 4);
-    header.size = 36 + samples * sizeof(short);
-    memcpy(header.wave, "WAVE", 4);
-    memcpy(header.fmt, "fmt ", 4);
-    header.fmt_size = 16;
-    header.format = 1;  // PCM
-    header.channels = CHANNELS;
-    header.sample_rate = SAMPLE_RATE;
-    header.bits_per_sample = 16;
-    header.byte_rate = SAMPLE_RATE * CHANNELS * header.bits_per_sample / 8;
-    header.block_align = CHANNELS * header.bits_per_sample / 8;
-    memcpy(header.data, "data", 4);
-    header.data_size = samples * sizeof(short);
-    
-    // Write header and data
-    fwrite(&header, sizeof(header), 1, fp);
-    fwrite(buffer, sizeof(short), samples, fp);
-    
-    fclose(fp);
-}
-
-static void generate_wav_files(void) {
-    const char *sound_types[] = {
-        "work_start", "break_start", "session_complete",
-        "long_break_start", "timer_finish", "idle_pause", "idle_resume"
-    };
+    return samples;
+}
+
+static GBytes* load_custom_sound(AudioManager *audio, const char *path, unsigned int rate, char **file, double *gain) {
+    GStatBuf st;
+    if (g_stat(path, &st) != 0) {
+        g_warning("Sound file not found: %s", path);
+        return NULL;
+    }
     
-    for (int i = 0; i < 7; i++) {
-        const char *wav_file = get_wav_filename(sound_types[i]);
-        
-        // Check if file already exists
-        if (access(wav_file, F_OK) == 0) {
-            continue;  // File already exists, skip
+    // Keyed by the file's identity, so an edited file is decoded again
+    char *id = g_strdup_printf("custom\n%s\n%" G_GINT64_FORMAT ".%09ld\n%" G_GINT64_FORMAT,
+                               path, (gint64)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec, (gint64)st.st_size);
+    guint64 key = sound_cache_key(id, strlen(id), rate, CHANNELS);
+    g_free(id);
+    
+    char *cache_file = sound_cache_get_path(audio->sound_cache, key);
+    LoudnessMeter *meter = NULL;
+    
+    GBytes *samples = sound_cache_lookup(audio->sound_cache, key, rate, CHANNELS);
+    if (!samples) {
+        // Always converted into the cache, even when the format already
+        // matches: a mapped file of ours can't be truncated under the engine.
+        // The loudness is measured on the way, on the samples that play.
+        SoundDecoder *decoder = sound_decoder_open(path);
+        if (decoder) {
+            meter = loudness_meter_new(rate, CHANNELS);
+            if (sound_decoder_convert(decoder, cache_file, rate, CHANNELS, (gsize)MAX_CUSTOM_SOUND_SECONDS * rate, meter)) {
+                samples = sound_cache_lookup(audio->sound_cache, key, rate, CHANNELS);
+            }
+            sound_decoder_free(decoder);
         }
+    }
+    
+    if (samples && !sound_cache_lookup_gain(audio->sound_cache, key, gain)) {
+        // Decoded before gains were stored: measure the cached file
+        if (!meter) {
+            SoundDecoder *cached = sound_decoder_open(cache_file);
+            meter = loudness_meter_new(rate, CHANNELS);
+            sound_decoder_measure(cached, meter);
+            sound_decoder_free(cached);
+        }
+        *gain = measure_gain(meter, path);
+        sound_cache_store_gain(audio->sound_cache, key, *gain);
+    }
+    
+    loudness_meter_free(meter);
+    if (samples) {
+        *file = cache_file;
+    } else {
+        g_free(cache_file);
+    }
+    return samples;
+}
+
+static double measure_gain(LoudnessMeter *meter, const char *path) {
+    double loudness = loudness_meter_get_integrated(meter);
+    float peak = loudness_meter_get_peak(meter);
+    if (!isfinite(loudness) || peak <= 0.0f) return 1.0;  // Silence stays silent
+    
+    // Quiet sounds are raised only so far, and never into clipping
+    double gain = pow(10.0, (LOUDNESS_TARGET_LUFS - loudness) / 20.0);
+    gain = MIN(gain, pow(10.0, LOUDNESS_MAX_BOOST_DB / 20.0));
+    gain = MIN(gain, 1.0 / peak);
+    
+    g_print("Audio: %s measures %.1f LUFS (peak %.1f dBFS), playing it at %+.1f dB\n",
+            path, loudness, 20.0 * log10(peak), 20.0 * log10(gain));
+    return gain;
+}
+
+static void decode_custom_sound(gpointer data, gpointer user_data) {
+    DecodeJob *job = (DecodeJob*)data;
+    AudioManager *audio = (AudioManager*)user_data;
+    
+    if (wait_for_engine(audio)) {
+        char *file = NULL;
+        double gain = 1.0;
+        GBytes *samples = load_custom_sound(audio, job->path, get_output_rate(audio), &file, &gain);
         
-        // Generate the chime
-        SoundData *sound = generate_chime(sound_types[i], 1.0);  // Max volume for WAV files
-        if (sound) {
-            write_wav_file(wav_file, sound->buffer, sound->samples);
-            free_sound_data(sound);
+        if (!samples) {
+            g_warning("Can't play %s, using the built-in sound", job->path);
+        } else {
+            CustomSound *custom = &audio->custom[job->index];
+            
+            g_mutex_lock(&audio->chimes_lock);
+            if (custom->generation == job->generation) {
+                if (custom->samples) g_bytes_unref(custom->samples);
+                g_free(custom->file);
+                custom->samples = g_bytes_ref(samples);
+                custom->file = g_strdup(file);
+                custom->gain = gain;
+            }
+            g_mutex_unlock(&audio->chimes_lock);
+            
+            g_bytes_unref(samples);
+            g_free(file);
         }
     }
 }
 
-static void* play_sound_aplay_thread(void *data) {
-    char *filename = (char*)data;
+static void free_decode_job(gpointer data) {
+    DecodeJob *job = (DecodeJob*)data;
+    g_free(job->path);
+    g_free(job);
+}
+
+static void play_external(AudioManager *audio, int index) {
+    if (!audio->external_player) return;
     
-    // Build aplay command
-    char command[512];
-    snprintf(command, sizeof(command), "aplay -q \"%s\" 2>/dev/null", filename);
+    ExternalPlayer *player = NULL;
+    for (int i = 0; i < MAX_EXTERNAL_PLAYERS; i++) {
+        if (!audio->players[i].pid) {
+            player = &audio->players[i];
+            break;
+        }
+    }
+    if (!player) {
+        g_warning("Too many sounds playing, dropping %s", chime_params[index].name);
+        return;
+    }
+    
+    // A decoded custom sound, or else the chime's cache file; without a
+    // device both are made at SAMPLE_RATE
+    g_mutex_lock(&audio->chimes_lock);
+    char *wav_file = g_strdup(audio->custom[index].file);
+    g_mutex_unlock(&audio->chimes_lock);
+    
+    // The decoded file is gone if the cache was cleaned since
+    if (wav_file && access(wav_file, R_OK) != 0) {
+        g_warning("Decoded sound %s is missing, using the built-in sound", wav_file);
+        g_free(wav_file);
+        wav_file = NULL;
+    }
+    
+    guint64 key = chime_key(index, SAMPLE_RATE);
+    if (!wav_file) wav_file = sound_cache_get_path(audio->sound_cache, key);
+    if (access(wav_file, R_OK) != 0) {
+        GBytes *samples = load_chime(audio, index, SAMPLE_RATE, key, TRUE);
+        g_bytes_unref(samples);
+    }
+    
+    // No shell: exec the player directly with its output discarded
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
     
-    // Execute aplay
-    system(command);
+    char *argv[] = {audio->external_player, "-q", wav_file, NULL};
+    pid_t pid;
+    int err = posix_spawn(&pid, audio->external_player, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    g_free(wav_file);
     
-    g_free(filename);
-    return NULL;
-}
\ No newline at end of file
+    if (err != 0) {
+        g_warning("Failed to start %s: %s", audio->external_player, g_strerror(err));
+        return;
+    }
+    
+    player->pid = pid;
+    player->watch = g_child_watch_add(pid, on_external_player_exit, audio);
+}
+
+static void on_external_player_exit(GPid pid, gint status, gpointer user_data) {
+    (void)status; // Suppress unused parameter warning
+    AudioManager *audio = (AudioManager*)user_data;
+    
+    // The child watch has already reaped it
+    for (int i = 0; i < MAX_EXTERNAL_PLAYERS; i++) {
+        if (audio->players[i].pid == pid) {
+            audio->players[i].pid = 0;
+            audio->players[i].watch = 0;
+            break;
+        }
+    }
+    g_spawn_close_pid(pid);
+}
@@ -2,11 +2,20 @@
 #define AUDIO_H
 
 #include <glib.h>
+#include "audio_engine.h"
+#include "audio_worker.h"
 
 G_BEGIN_DECLS
 
 typedef struct _AudioManager AudioManager;
 
+typedef struct {
+    guint plays;                 // Sounds handed to the engine
+    guint plays_coalesced;       // Repeats of a sound that hadn't started yet
+    guint plays_dropped;         // Would have started too late, or the engine queue was full
+    AudioWorkerStats work;       // Chime preparation and custom sound decoding
+} AudioRequestStats;
+
 /**
  * Creates a new audio manager
  * @return New AudioManager instance
@@ -75,6 +84,48 @@ void audio_manager_set_volume(AudioManager *audio, double volume);
  */
 void audio_manager_set_enabled(AudioManager *audio, gboolean enabled);
 
+/**
+ * Plays a sound file instead of a built-in sound. The file is decoded in the
+ * background (WAV; FLAC and Ogg when built with libsndfile) into the sound
+ * cache at the device rate and reused from there. The built-in sound plays
+ * until it is ready, or if it can't be decoded.
+ * @param audio AudioManager instance
+ * @param sound_name Sound to replace ("work_start", "break_start", ...)
+ * @param path Sound file, or NULL for the built-in sound
+ */
+void audio_manager_set_custom_sound(AudioManager *audio, const char *sound_name, const char *path);
+
+/**
+ * Selects the background noise played during work sessions
+ * @param audio AudioManager instance
+ * @param type "white", "pink", "brown", "tick", or NULL / "off" for none
+ */
+void audio_manager_set_ambient_noise(AudioManager *audio, const char *type);
+
+/**
+ * Starts or stops the background noise. It is generated on the playback
+ * thread and fades in and out; nothing plays while sounds are disabled,
+ * no noise is selected, or there is no device.
+ * @param audio AudioManager instance
+ * @param playing TRUE during a work session
+ */
+void audio_manager_set_ambient_playing(AudioManager *audio, gboolean playing);
+
+/**
+ * Gets first-sample latency statistics of the playback engine
+ * @param audio AudioManager instance
+ * @param stats Filled with the statistics (all zero when aplay is used)
+ */
+void audio_manager_get_latency_stats(AudioManager *audio, AudioLatencyStats *stats);
+
+/**
+ * Gets how many play requests were played, merged or dropped, and how
+ * busy the background work queue has been, for sizing it
+ * @param audio AudioManager instance
+ * @param stats Filled with the statistics so far
+ */
+void audio_manager_get_request_stats(AudioManager *audio, AudioRequestStats *stats);
+
 G_END_DECLS
 
 #endif // AUDIO_H
\ No newline at end of file
@@ -0,0 +1,542 @@
+#define _GNU_SOURCE
+#include "audio_engine.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+
+// Pending play requests. Power of two; a full queue drops the request
+// rather than blocking the caller (the main loop).
+#define AUDIO_QUEUE_SIZE 32
+#define AUDIO_QUEUE_MASK (AUDIO_QUEUE_SIZE - 1)
+
+// Sounds mixed at once; a new sound past this cuts off the oldest
+#define AUDIO_MAX_VOICES 8
+
+// Streams fade in and out over this long instead of clicking
+#define AUDIO_STREAM_FADE_MS 300
+
+typedef enum {
+    AUDIO_COMMAND_PLAY,
+    AUDIO_COMMAND_STREAM,
+    AUDIO_COMMAND_QUIT
+} AudioCommandType;
+
+typedef struct {
+    AudioCommandType type;
+    GBytes *samples;
+    guint gain;                  // Q15
+    gint64 enqueue_us;           // Monotonic time of the request
+    gint64 start_us;             // Requested start, 0 for as soon as possible
+    AudioStreamFunc fill;        // AUDIO_COMMAND_STREAM only
+    gpointer user_data;
+    GDestroyNotify destroy;
+} AudioCommand;
+
+// A sound being mixed
+typedef struct {
+    GBytes *samples;             // NULL when the voice is free
+    const gint16 *data;
+    gsize frames;
+    gsize position;              // Next frame to mix
+    guint gain;                  // Q15
+    gint64 start_frame;          // Stream frame of the first sample
+    gint64 request_us;           // When it should have started, for latency
+} AudioVoice;
+
+// A generated stream and its fade
+typedef struct {
+    AudioStreamFunc fill;        // NULL when the slot is free
+    gpointer user_data;
+    GDestroyNotify destroy;
+    guint gain;                  // Q15 target
+    guint level;                 // Q15 gain reached so far
+} AudioStream;
+
+// Bounded multi-producer queue (Vyukov): each cell's sequence tells whether
+// it is free for the producer at that position or full for the consumer
+typedef struct {
+    gint sequence;
+    AudioCommand command;
+} AudioQueueCell;
+
+struct _AudioEngine {
+    AudioQueueCell cells[AUDIO_QUEUE_SIZE];
+    gint enqueue_pos;
+    guint dequeue_pos;           // Engine thread only
+    sem_t pending;               // Posted once per queued command
+    
+    pthread_t thread;
+    unsigned int requested_rate;
+    int channels;
+    
+    // Owned by the engine thread
+    AudioSink *sink;
+    gboolean sink_open;
+    AudioVoice voices[AUDIO_MAX_VOICES];
+    int active_voices;
+    gint64 stream_frame;         // Stream position of the next frame written
+    gint64 anchor_frame;         // Stream position heard at anchor_us
+    gint64 anchor_us;
+    gsize period_frames;         // Frames mixed and written per step
+    gint32 *mix;                 // Sum of the voices for one period
+    gint16 *out;                 // The sum, saturated
+    AudioStream streams[2];      // Playing or fading in; fading out
+    gint16 *stream_buf;          // One period of a stream
+    
+    gint rate;                   // Negotiated rate, 0 until the device is open
+    gint status;                 // AudioEngineStatus
+    GMutex stats_lock;
+    AudioLatencyStats stats;
+};
+
+static void* engine_thread(void *data);
+static gboolean queue_push(AudioEngine *engine, const AudioCommand *command);
+static gboolean queue_pop(AudioEngine *engine, AudioCommand *command);
+static gboolean open_sink(AudioEngine *engine);
+static void start_voice(AudioEngine *engine, const AudioCommand *command);
+static void mix_period(AudioEngine *engine);
+static void release_voice(AudioEngine *engine, AudioVoice *voice);
+static void start_stream(AudioEngine *engine, const AudioCommand *command);
+static void mix_streams(AudioEngine *engine);
+static void release_stream(AudioStream *stream);
+static gboolean is_idle(AudioEngine *engine);
+static void mix_voice(gint32 *mix, const gint16 *src, gsize count, guint gain);
+static void mix_ramp(gint32 *mix, const gint16 *src, gsize frames, int channels, guint from, guint to);
+static void saturate(gint16 *dst, const gint32 *mix, gsize count);
+static void record_latency(AudioEngine *engine, gint64 latency_us);
+static void record_drop(AudioEngine *engine);
+static void record_steal(AudioEngine *engine);
+
+AudioEngine* audio_engine_new(AudioSink *sink, unsigned int sample_rate, int channels) {
+    if (!sink) return NULL;
+    
+    AudioEngine *engine = g_malloc0(sizeof(AudioEngine));
+    engine->sink = sink;
+    engine->requested_rate = sample_rate;
+    engine->channels = channels;
+    engine->status = AUDIO_ENGINE_STARTING;
+    
+    for (int i = 0; i < AUDIO_QUEUE_SIZE; i++) {
+        engine->cells[i].sequence = i;
+    }
+    sem_init(&engine->pending, 0, 0);
+    g_mutex_init(&engine->stats_lock);
+    
+    // The device is probed on the engine thread so startup never waits for it
+    if (pthread_create(&engine->thread, NULL, engine_thread, engine) != 0) {
+        g_warning("Failed to create audio engine thread");
+        sem_destroy(&engine->pending);
+        g_mutex_clear(&engine->stats_lock);
+        audio_sink_free(sink);
+        g_free(engine);
+        return NULL;
+    }
+    
+    return engine;
+}
+
+void audio_engine_free(AudioEngine *engine) {
+    if (!engine) return;
+    
+    AudioCommand quit = {AUDIO_COMMAND_QUIT, NULL, 0, 0, 0, NULL, NULL, NULL};
+    while (!queue_push(engine, &quit)) {
+        g_usleep(1000);  // Full: the engine is draining it
+    }
+    sem_post(&engine->pending);
+    pthread_join(engine->thread, NULL);
+    
+    // Requests queued behind the quit were never played
+    AudioCommand command;
+    while (queue_pop(engine, &command)) {
+        if (command.samples) g_bytes_unref(command.samples);
+        if (command.destroy) command.destroy(command.user_data);
+    }
+    
+    sem_destroy(&engine->pending);
+    g_mutex_clear(&engine->stats_lock);
+    audio_sink_free(engine->sink);
+    g_free(engine->mix);
+    g_free(engine->out);
+    g_free(engine->stream_buf);
+    g_free(engine);
+}
+
+gboolean audio_engine_play(AudioEngine *engine, GBytes *samples, guint gain) {
+    return audio_engine_play_at(engine, samples, gain, 0);
+}
+
+gboolean audio_engine_play_at(AudioEngine *engine, GBytes *samples, guint gain, gint64 start_us) {
+    if (!engine || !samples) return FALSE;
+    
+    AudioCommand command = {AUDIO_COMMAND_PLAY, g_bytes_ref(samples), gain, g_get_monotonic_time(), start_us, NULL, NULL, NULL};
+    if (!queue_push(engine, &command)) {
+        g_bytes_unref(samples);
+        record_drop(engine);
+        return FALSE;
+    }
+    
+    sem_post(&engine->pending);
+    return TRUE;
+}
+
+gboolean audio_engine_set_stream(AudioEngine *engine, AudioStreamFunc fill, gpointer user_data, GDestroyNotify destroy, guint gain) {
+    if (!engine) {
+        if (destroy) destroy(user_data);
+        return FALSE;
+    }
+    
+    AudioCommand command = {AUDIO_COMMAND_STREAM, NULL, gain, g_get_monotonic_time(), 0, fill, user_data, destroy};
+    if (!queue_push(engine, &command)) {
+        if (destroy) destroy(user_data);
+        record_drop(engine);
+        return FALSE;
+    }
+    
+    sem_post(&engine->pending);
+    return TRUE;
+}
+
+AudioEngineStatus audio_engine_get_status(AudioEngine *engine) {
+    if (!engine) return AUDIO_ENGINE_NO_DEVICE;
+    
+    return (AudioEngineStatus)g_atomic_int_get(&engine->status);
+}
+
+unsigned int audio_engine_get_rate(AudioEngine *engine) {
+    if (!engine) return 0;
+    
+    return (unsigned int)g_atomic_int_get(&engine->rate);
+}
+
+AudioSink* audio_engine_get_sink(AudioEngine *engine) {
+    return engine ? engine->sink : NULL;
+}
+
+void audio_engine_get_latency_stats(AudioEngine *engine, AudioLatencyStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(AudioLatencyStats));
+    if (!engine) return;
+    
+    g_mutex_lock(&engine->stats_lock);
+    *stats = engine->stats;
+    g_mutex_unlock(&engine->stats_lock);
+}
+
+static gboolean queue_push(AudioEngine *engine, const AudioCommand *command) {
+    guint pos = (guint)g_atomic_int_get(&engine->enqueue_pos);
+    
+    for (;;) {
+        AudioQueueCell *cell = &engine->cells[pos & AUDIO_QUEUE_MASK];
+        gint diff = (gint)((guint)g_atomic_int_get(&cell->sequence) - pos);
+        
+        if (diff == 0) {
+            // Cell is free at our position; claim the position
+            if (g_atomic_int_compare_and_exchange(&engine->enqueue_pos, (gint)pos, (gint)(pos + 1))) {
+                cell->command = *command;
+                g_atomic_int_set(&cell->sequence, (gint)(pos + 1));
+                return TRUE;
+            }
+            pos = (guint)g_atomic_int_get(&engine->enqueue_pos);
+        } else if (diff < 0) {
+            // Consumer hasn't freed this cell yet: full
+            return FALSE;
+        } else {
+            // Another producer took this position
+            pos = (guint)g_atomic_int_get(&engine->enqueue_pos);
+        }
+    }
+}
+
+static gboolean queue_pop(AudioEngine *engine, AudioCommand *command) {
+    guint pos = engine->dequeue_pos;
+    AudioQueueCell *cell = &engine->cells[pos & AUDIO_QUEUE_MASK];
+    
+    if ((gint)((guint)g_atomic_int_get(&cell->sequence) - (pos + 1)) < 0) {
+        return FALSE;  // Empty (or the producer is still writing it)
+    }
+    
+    *command = cell->command;
+    engine->dequeue_pos = pos + 1;
+    g_atomic_int_set(&cell->sequence, (gint)(pos + AUDIO_QUEUE_SIZE));
+    return TRUE;
+}
+
+static void* engine_thread(void *data) {
+    AudioEngine *engine = (AudioEngine*)data;
+    gboolean running = TRUE;
+    
+    if (open_sink(engine)) {
+        g_atomic_int_set(&engine->status, AUDIO_ENGINE_READY);
+    } else {
+        g_warning("Cannot open audio output (%s)", audio_sink_get_name(engine->sink));
+        g_atomic_int_set(&engine->status, AUDIO_ENGINE_NO_DEVICE);
+    }
+    
+    while (running) {
+        // Sleep only while nothing plays; while mixing, requests are picked
+        // up once per period, which the blocking writes pace
+        if (is_idle(engine)) {
+            while (sem_wait(&engine->pending) != 0 && errno == EINTR) {
+                // Retry
+            }
+        }
+        
+        // Take the wake-ups before the commands, so a command queued after
+        // the queue was emptied always leaves a wake-up behind
+        while (sem_trywait(&engine->pending) == 0) {
+            // Consumed
+        }
+        
+        AudioCommand command;
+        while (running && queue_pop(engine, &command)) {
+            if (command.type == AUDIO_COMMAND_QUIT) {
+                running = FALSE;
+                break;
+            }
+            
+            if (command.type == AUDIO_COMMAND_STREAM) {
+                if (engine->sink_open) {
+                    start_stream(engine, &command);
+                } else if (command.destroy) {
+                    command.destroy(command.user_data);
+                }
+                continue;
+            }
+            
+            if (engine->sink_open) {
+                start_voice(engine, &command);
+            } else {
+                record_drop(engine);
+            }
+            g_bytes_unref(command.samples);
+        }
+        if (!running || is_idle(engine)) continue;
+        
+        mix_period(engine);
+        
+        // Let the tail play out unless more sounds are already waiting, then
+        // leave the device prepared for the next one
+        int pending = 0;
+        sem_getvalue(&engine->pending, &pending);
+        if (is_idle(engine) && pending == 0) {
+            audio_sink_drain(engine->sink);
+        }
+    }
+    
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) {
+        release_voice(engine, &engine->voices[i]);
+    }
+    release_stream(&engine->streams[0]);
+    release_stream(&engine->streams[1]);
+    return NULL;
+}
+
+static gboolean open_sink(AudioEngine *engine) {
+    unsigned int rate = engine->requested_rate;
+    
+    if (!audio_sink_open(engine->sink, &rate, engine->channels, &engine->period_frames)) return FALSE;
+    engine->sink_open = TRUE;
+    
+    // Mixing a period at a time keeps a new sound at most a period late
+    engine->mix = g_malloc(engine->period_frames * engine->channels * sizeof(gint32));
+    engine->out = g_malloc(engine->period_frames * engine->channels * sizeof(gint16));
+    engine->stream_buf = g_malloc(engine->period_frames * engine->channels * sizeof(gint16));
+    
+    g_atomic_int_set(&engine->rate, (gint)rate);
+    return TRUE;
+}
+
+static void start_voice(AudioEngine *engine, const AudioCommand *command) {
+    AudioVoice *voice = NULL;
+    
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) {
+        if (!engine->voices[i].samples) {
+            voice = &engine->voices[i];
+            break;
+        }
+        // Out of voices: the one that started first makes room
+        if (!voice || engine->voices[i].start_frame < voice->start_frame) {
+            voice = &engine->voices[i];
+        }
+    }
+    if (voice->samples) {
+        release_voice(engine, voice);
+        record_steal(engine);
+    }
+    
+    gsize size = 0;
+    voice->samples = g_bytes_ref(command->samples);
+    voice->data = g_bytes_get_data(command->samples, &size);
+    voice->frames = size / (sizeof(gint16) * engine->channels);
+    voice->position = 0;
+    voice->gain = command->gain;
+    voice->request_us = MAX(command->start_us, command->enqueue_us);
+    gint64 rate = g_atomic_int_get(&engine->rate);
+    
+    // Tie the stream to the clock once as it starts: the next frame written
+    // is heard after the frames still queued in the device. Converting every
+    // start time against the same anchor keeps their spacing exact.
+    if (engine->active_voices == 0) {
+        gint64 delay = (gint64)audio_sink_get_delay(engine->sink);
+        engine->anchor_frame = engine->stream_frame;
+        engine->anchor_us = g_get_monotonic_time() + delay * G_USEC_PER_SEC / rate;
+    }
+    engine->active_voices++;
+    
+    gint64 frame = engine->anchor_frame + (voice->request_us - engine->anchor_us) * rate / G_USEC_PER_SEC;
+    voice->start_frame = MAX(frame, engine->stream_frame);
+}
+
+static void mix_period(AudioEngine *engine) {
+    gsize period = engine->period_frames;
+    int channels = engine->channels;
+    gsize starts[AUDIO_MAX_VOICES];  // Offset of voices starting in this period
+    
+    memset(engine->mix, 0, period * channels * sizeof(gint32));
+    
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) {
+        AudioVoice *voice = &engine->voices[i];
+        starts[i] = G_MAXSIZE;
+        if (!voice->samples || voice->start_frame >= engine->stream_frame + (gint64)period) continue;
+        
+        gsize offset = voice->start_frame > engine->stream_frame ? (gsize)(voice->start_frame - engine->stream_frame) : 0;
+        gsize count = MIN(period - offset, voice->frames - voice->position);
+        if (voice->position == 0) starts[i] = offset;
+        
+        mix_voice(engine->mix + offset * channels, voice->data + voice->position * channels, count * channels, voice->gain);
+        voice->position += count;
+    }
+    mix_streams(engine);
+    saturate(engine->out, engine->mix, period * channels);
+    
+    gboolean ok = audio_sink_write(engine->sink, engine->out, period);
+    engine->stream_frame += period;
+    
+    // Queued frames ahead of each new voice's first sample
+    gint64 delay = ok ? (gint64)audio_sink_get_delay(engine->sink) : 0;
+    gint64 now = g_get_monotonic_time();
+    gint64 rate = g_atomic_int_get(&engine->rate);
+    
+    for (int i = 0; i < AUDIO_MAX_VOICES; i++) {
+        AudioVoice *voice = &engine->voices[i];
+        if (!voice->samples) continue;
+        
+        if (ok && starts[i] != G_MAXSIZE) {
+            gint64 ahead = MAX(delay - (gint64)(period - starts[i]), 0);
+            record_latency(engine, now - voice->request_us + ahead * G_USEC_PER_SEC / rate);
+        }
+        // A device error ends every sound rather than retrying each period
+        if (!ok || voice->position == voice->frames) release_voice(engine, voice);
+    }
+    if (!ok) {
+        release_stream(&engine->streams[0]);
+        release_stream(&engine->streams[1]);
+    }
+}
+
+static void release_voice(AudioEngine *engine, AudioVoice *voice) {
+    if (!voice->samples) return;
+    
+    g_bytes_unref(voice->samples);
+    voice->samples = NULL;
+    engine->active_voices--;
+}
+
+static void start_stream(AudioEngine *engine, const AudioCommand *command) {
+    // Whatever was fading out is cut; the playing stream takes its place
+    release_stream(&engine->streams[1]);
+    engine->streams[1] = engine->streams[0];
+    memset(&engine->streams[0], 0, sizeof(AudioStream));
+    
+    if (!command->fill) return;
+    engine->streams[0].fill = command->fill;
+    engine->streams[0].user_data = command->user_data;
+    engine->streams[0].destroy = command->destroy;
+    engine->streams[0].gain = command->gain;
+}
+
+static void mix_streams(AudioEngine *engine) {
+    gsize period = engine->period_frames;
+    guint64 fade_frames = MAX((guint64)AUDIO_STREAM_FADE_MS * (guint)g_atomic_int_get(&engine->rate) / 1000, 1);
+    guint step = (guint)MAX((guint64)AUDIO_GAIN_UNITY * period / fade_frames, 1);
+    
+    for (int i = 0; i < 2; i++) {
+        AudioStream *stream = &engine->streams[i];
+        if (!stream->fill) continue;
+        
+        // Ramp towards the target over the period, a fade step at a time
+        guint target = i == 0 ? stream->gain : 0;
+        guint from = stream->level;
+        guint to = from < target ? MIN(from + step, target) : (from > target + step ? from - step : target);
+        
+        stream->fill(engine->stream_buf, period, stream->user_data);
+        if (from == to) {
+            mix_voice(engine->mix, engine->stream_buf, period * engine->channels, to);
+        } else {
+            mix_ramp(engine->mix, engine->stream_buf, period, engine->channels, from, to);
+        }
+        stream->level = to;
+        
+        if (i == 1 && to == 0) release_stream(stream);
+    }
+}
+
+static void release_stream(AudioStream *stream) {
+    if (!stream->fill) return;
+    
+    if (stream->destroy) stream->destroy(stream->user_data);
+    memset(stream, 0, sizeof(AudioStream));
+}
+
+static gboolean is_idle(AudioEngine *engine) {
+    return engine->active_voices == 0 && !engine->streams[0].fill && !engine->streams[1].fill;
+}
+
+static void mix_voice(gint32 *mix, const gint16 *src, gsize count, guint gain) {
+    // Plain loops so the compiler can vectorize them. Each voice is scaled
+    // with rounding; AUDIO_MAX_VOICES full-scale voices still fit in 32 bits.
+    for (gsize i = 0; i < count; i++) {
+        mix[i] += ((gint32)src[i] * (gint32)gain + (1 << 14)) >> 15;
+    }
+}
+
+static void mix_ramp(gint32 *mix, const gint16 *src, gsize frames, int channels, guint from, guint to) {
+    gint64 delta = (gint64)to - (gint64)from;
+    
+    for (gsize i = 0; i < frames; i++) {
+        gint32 gain = (gint32)(from + delta * (gint64)i / (gint64)frames);
+        for (int c = 0; c < channels; c++) {
+            gsize k = i * channels + c;
+            mix[k] += ((gint32)src[k] * gain + (1 << 14)) >> 15;
+        }
+    }
+}
+
+static void saturate(gint16 *dst, const gint32 *mix, gsize count) {
+    for (gsize i = 0; i < count; i++) {
+        dst[i] = (gint16)CLAMP(mix[i], G_MININT16, G_MAXINT16);
+    }
+}
+
+static void record_latency(AudioEngine *engine, gint64 latency_us) {
+    g_mutex_lock(&engine->stats_lock);
+    AudioLatencyStats *stats = &engine->stats;
+    if (stats->plays == 0 || latency_us < stats->min_us) stats->min_us = latency_us;
+    if (latency_us > stats->max_us) stats->max_us = latency_us;
+    stats->last_us = latency_us;
+    stats->total_us += latency_us;
+    stats->plays++;
+    g_mutex_unlock(&engine->stats_lock);
+}
+
+static void record_drop(AudioEngine *engine) {
+    g_mutex_lock(&engine->stats_lock);
+    engine->stats.dropped++;
+    g_mutex_unlock(&engine->stats_lock);
+}
+
+static void record_steal(AudioEngine *engine) {
+    g_mutex_lock(&engine->stats_lock);
+    engine->stats.stolen++;
+    g_mutex_unlock(&engine->stats_lock);
+}
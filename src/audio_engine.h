@@ -0,0 +1,129 @@
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include <glib.h>
+#include "audio_sink.h"
+
+G_BEGIN_DECLS
+
+typedef struct _AudioEngine AudioEngine;
+
+// Fixed-point (Q15) gain that leaves samples unchanged
+#define AUDIO_GAIN_UNITY (1 << 15)
+
+typedef enum {
+    AUDIO_ENGINE_STARTING,       // Device not probed yet; requests are queued
+    AUDIO_ENGINE_READY,          // Device open and prepared
+    AUDIO_ENGINE_NO_DEVICE       // No usable device; requests are dropped
+} AudioEngineStatus;
+
+/**
+ * Produces the next frames of a stream; called on the engine thread once per
+ * period, so it must not block
+ * @param out Destination for frames * channels interleaved samples
+ * @param frames Number of frames
+ * @param user_data Data given to audio_engine_set_stream
+ */
+typedef void (*AudioStreamFunc)(gint16 *out, gsize frames, gpointer user_data);
+
+/**
+ * First-sample latency of played sounds: from the play request to the
+ * moment its first sample reaches the device (queued frames included)
+ */
+typedef struct {
+    guint plays;                 // Sounds that reached the device
+    guint dropped;               // Requests refused (queue full or no device)
+    guint stolen;                // Voices cut off to stay within the voice budget
+    gint64 last_us;
+    gint64 min_us;
+    gint64 max_us;
+    gint64 total_us;             // Sum over all plays, for the mean
+} AudioLatencyStats;
+
+/**
+ * Creates the audio engine and starts its thread. The thread opens the sink
+ * once and keeps it prepared between sounds. Sounds that overlap are mixed
+ * into the one stream, up to a fixed number of voices; past that the oldest
+ * voice is cut off.
+ * @param sink Output to play on (taken over by the engine)
+ * @param sample_rate Requested sample rate in Hz
+ * @param channels Number of interleaved channels
+ * @return New AudioEngine instance
+ */
+AudioEngine* audio_engine_new(AudioSink *sink, unsigned int sample_rate, int channels);
+
+/**
+ * Stops the engine thread, discarding queued sounds, and frees the sink
+ * @param engine AudioEngine instance to free
+ */
+void audio_engine_free(AudioEngine *engine);
+
+/**
+ * Queues a sound to start as soon as possible, without blocking. Safe to
+ * call from any thread.
+ * @param engine AudioEngine instance
+ * @param samples Interleaved signed 16-bit samples (a reference is taken)
+ * @param gain Q15 gain applied on output, AUDIO_GAIN_UNITY for none
+ * @return TRUE if queued, FALSE if the queue is full
+ */
+gboolean audio_engine_play(AudioEngine *engine, GBytes *samples, guint gain);
+
+/**
+ * Queues a sound to start at a given time. The time is converted to a
+ * frame of the output stream, so sounds scheduled relative to each other
+ * keep their spacing to the sample; times already past start at once.
+ * @param engine AudioEngine instance
+ * @param samples Interleaved signed 16-bit samples (a reference is taken)
+ * @param gain Q15 gain applied on output, AUDIO_GAIN_UNITY for none
+ * @param start_us Monotonic time (g_get_monotonic_time) to start at
+ * @return TRUE if queued, FALSE if the queue is full
+ */
+gboolean audio_engine_play_at(AudioEngine *engine, GBytes *samples, guint gain, gint64 start_us);
+
+/**
+ * Starts a continuous stream, generated period by period on the engine
+ * thread and mixed under the sounds. The stream fades in, and one that was
+ * already playing fades out, so switching takes effect within a period plus
+ * the device buffer. Calling it again with the same data is not supported;
+ * pass a new generator.
+ * @param engine AudioEngine instance
+ * @param fill Generator, or NULL to only fade out the current stream
+ * @param user_data Passed to fill
+ * @param destroy Frees user_data once the stream has faded out, or at once if
+ *                the request can't be queued; may be NULL
+ * @param gain Q15 gain, AUDIO_GAIN_UNITY for none
+ * @return TRUE if queued, FALSE if the queue is full
+ */
+gboolean audio_engine_set_stream(AudioEngine *engine, AudioStreamFunc fill, gpointer user_data, GDestroyNotify destroy, guint gain);
+
+/**
+ * Gets whether the engine has a device to play on
+ * @param engine AudioEngine instance
+ * @return Current status
+ */
+AudioEngineStatus audio_engine_get_status(AudioEngine *engine);
+
+/**
+ * Gets the sample rate the device was opened with
+ * @param engine AudioEngine instance
+ * @return Negotiated rate in Hz, or 0 while the device isn't open
+ */
+unsigned int audio_engine_get_rate(AudioEngine *engine);
+
+/**
+ * Gets the sink the engine plays on, e.g. for its counters
+ * @param engine AudioEngine instance
+ * @return The engine's sink, owned by the engine
+ */
+AudioSink* audio_engine_get_sink(AudioEngine *engine);
+
+/**
+ * Gets first-sample latency statistics
+ * @param engine AudioEngine instance
+ * @param stats Filled with the statistics so far
+ */
+void audio_engine_get_latency_stats(AudioEngine *engine, AudioLatencyStats *stats);
+
+G_END_DECLS
+
+#endif // AUDIO_ENGINE_H
@@ -0,0 +1,313 @@
+#include "audio_resampler.h"
+#include <math.h>
+#include <string.h>
+
+#include "simd_dispatch.h"
+
+G_STATIC_ASSERT((int)AUDIO_RESAMPLER_KERNEL_AUTO == (int)SIMD_KERNEL_AUTO && (int)AUDIO_RESAMPLER_KERNEL_AVX2 == (int)SIMD_KERNEL_AVX2);
+
+// Sinc zero crossings on each side of the filter center. With the Kaiser
+// window below this gives about 85 dB stopband attenuation and a
+// transition band of about 7% of the lower Nyquist frequency.
+#define ZERO_CROSSINGS 32
+#define KAISER_BETA 8.6
+
+// The passband ends this far below the lower Nyquist frequency, so the
+// transition band is already attenuated at Nyquist
+#define CUTOFF_SCALE 0.91
+
+// Filter phases stored at most; ratios needing more use the nearest one
+#define MAX_PHASES 1024
+
+// Input frames appended per pass in addition to the filter length
+#define HISTORY_BLOCK 1024
+
+typedef float (*DotFunc)(const float *x, const float *h, int taps);
+
+struct _AudioResampler {
+    int in_channels;
+    int channels;
+    guint64 up;                 // Output rate / gcd
+    guint64 down;               // Input rate / gcd
+    int phases;
+    int taps;                   // Per phase, a multiple of 8
+    float *coefs;               // phases * taps
+    DotFunc dot;
+    
+    // Planar history of mixed input, one run of capacity frames per channel
+    float *history;
+    gsize capacity;
+    gsize filled;
+    gsize index;                // First tap of the next output
+    guint64 frac;               // Its offset from index, in 1/up frames
+    
+    guint64 in_total;
+    guint64 out_total;
+};
+
+static float dot_scalar(const float *x, const float *h, int taps) {
+    float sum = 0.0f;
+    for (int i = 0; i < taps; i++) sum += x[i] * h[i];
+    return sum;
+}
+
+#ifdef __SSE2__
+static float dot_sse2(const float *x, const float *h, int taps) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    
+    for (int i = 0; i < taps; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(h + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(h + i + 4)));
+    }
+    
+    __m128 sum = _mm_add_ps(acc0, acc1);
+    sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_add_ss(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNEL
+__attribute__((target("avx2,fma")))
+static float dot_avx2(const float *x, const float *h, int taps) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    
+    for (; i + 16 <= taps; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(h + i + 8), acc1);
+    }
+    if (i < taps) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(h + i), acc0);
+    }
+    
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_add_ss(sum, _mm_movehl_ps(sum, sum));
+    return _mm_cvtss_f32(sum);
+}
+#endif
+
+gboolean audio_resampler_kernel_supported(AudioResamplerKernel kernel) {
+    return simd_kernel_supported((SimdKernel)kernel, SIMD_NEEDS_FMA);
+}
+
+static AudioResamplerKernel resolve_kernel(AudioResamplerKernel kernel) {
+    return (AudioResamplerKernel)simd_resolve_kernel((SimdKernel)kernel, SIMD_NEEDS_FMA);
+}
+
+const char* audio_resampler_kernel_name(AudioResamplerKernel kernel) {
+    return simd_kernel_name((SimdKernel)kernel, SIMD_NEEDS_FMA);
+}
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    
+    for (int k = 1; k < 64 && term > sum * 1e-12; k++) {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+static void design_filter(AudioResampler *resampler, double cutoff) {
+    int taps = resampler->taps;
+    double half = taps / 2;
+    double norm = bessel_i0(KAISER_BETA);
+    
+    for (int p = 0; p < resampler->phases; p++) {
+        float *row = resampler->coefs + (gsize)p * taps;
+        double frac = (double)p / resampler->phases;
+        double sum = 0.0;
+        
+        for (int k = 0; k < taps; k++) {
+            // Distance from the output instant to input tap k
+            double x = frac + (half - 1) - k;
+            double sinc = fabs(x) < 1e-9 ? 1.0 : sin(G_PI * cutoff * x) / (G_PI * cutoff * x);
+            double r = x / half;
+            double window = r * r < 1.0 ? bessel_i0(KAISER_BETA * sqrt(1.0 - r * r)) / norm : 0.0;
+            
+            row[k] = (float)(sinc * window);
+            sum += row[k];
+        }
+        
+        // Unity gain at DC for every phase
+        for (int k = 0; k < taps; k++) row[k] = (float)(row[k] / sum);
+    }
+}
+
+AudioResampler* audio_resampler_new(unsigned int in_rate, int in_channels, unsigned int out_rate, int out_channels, AudioResamplerKernel kernel) {
+    if (in_rate == 0 || out_rate == 0 || in_channels <= 0 || out_channels <= 0) return NULL;
+    
+    AudioResampler *resampler = g_malloc0(sizeof(AudioResampler));
+    guint64 a = in_rate, b = out_rate;
+    while (b) {
+        guint64 t = a % b;
+        a = b;
+        b = t;
+    }
+    
+    resampler->in_channels = in_channels;
+    resampler->channels = out_channels;
+    resampler->up = out_rate / a;
+    resampler->down = in_rate / a;
+    resampler->phases = resampler->up < MAX_PHASES ? (int)resampler->up : MAX_PHASES;
+    
+    // Downsampling narrows the passband, and the filter widens to match
+    double cutoff = CUTOFF_SCALE * MIN(1.0, (double)out_rate / in_rate);
+    int taps = 2 * (int)ceil(ZERO_CROSSINGS / cutoff);
+    resampler->taps = (taps + 7) & ~7;
+    resampler->coefs = g_malloc((gsize)resampler->phases * resampler->taps * sizeof(float));
+    design_filter(resampler, cutoff);
+    
+    switch (resolve_kernel(kernel)) {
+#ifdef HAVE_AVX2_KERNEL
+        case AUDIO_RESAMPLER_KERNEL_AVX2:
+            resampler->dot = dot_avx2;
+            break;
+#endif
+#ifdef __SSE2__
+        case AUDIO_RESAMPLER_KERNEL_SSE2:
+            resampler->dot = dot_sse2;
+            break;
+#endif
+        default:
+            resampler->dot = dot_scalar;
+            break;
+    }
+    
+    // Half a filter of silence ahead of the input centers the first output
+    // on the first input frame
+    resampler->capacity = resampler->taps + HISTORY_BLOCK;
+    resampler->history = g_malloc0(resampler->capacity * out_channels * sizeof(float));
+    resampler->filled = resampler->taps / 2 - 1;
+    
+    return resampler;
+}
+
+void audio_resampler_free(AudioResampler *resampler) {
+    if (!resampler) return;
+    
+    g_free(resampler->coefs);
+    g_free(resampler->history);
+    g_free(resampler);
+}
+
+gsize audio_resampler_get_max_output(AudioResampler *resampler, gsize frames) {
+    if (!resampler) return 0;
+    
+    // Up to a filter length of earlier input may still be pending
+    guint64 pending = MAX((guint64)frames, (guint64)resampler->taps) + resampler->taps;
+    return (gsize)(pending * resampler->up / resampler->down + 2);
+}
+
+static void append(AudioResampler *resampler, const float *in, gsize frames) {
+    int in_channels = resampler->in_channels;
+    int channels = resampler->channels;
+    
+    for (int c = 0; c < channels; c++) {
+        float *dst = resampler->history + c * resampler->capacity + resampler->filled;
+        
+        if (!in) {
+            memset(dst, 0, frames * sizeof(float));
+        } else if (channels == 1 && in_channels > 1) {
+            // Average, so full-scale stereo stays within full scale
+            float scale = 1.0f / in_channels;
+            for (gsize f = 0; f < frames; f++) {
+                const float *src = in + f * in_channels;
+                float sum = 0.0f;
+                for (int i = 0; i < in_channels; i++) sum += src[i];
+                dst[f] = sum * scale;
+            }
+        } else {
+            // Mono goes to every channel, otherwise channels wrap around
+            const float *src = in + c % in_channels;
+            for (gsize f = 0; f < frames; f++) dst[f] = src[f * in_channels];
+        }
+    }
+    
+    resampler->filled += frames;
+}
+
+static gsize run(AudioResampler *resampler, float *out, gsize limit) {
+    int channels = resampler->channels;
+    int taps = resampler->taps;
+    gsize count = 0;
+    
+    while (count < limit) {
+        gsize phase = (gsize)((resampler->frac * resampler->phases + resampler->up / 2) / resampler->up);
+        gsize start = resampler->index;
+        
+        // Rounding up past the last phase lands on phase 0 of the next frame
+        if (phase == (gsize)resampler->phases) {
+            phase = 0;
+            start++;
+        }
+        if (start + taps > resampler->filled) break;
+        
+        const float *coefs = resampler->coefs + phase * taps;
+        for (int c = 0; c < channels; c++) {
+            const float *x = resampler->history + c * resampler->capacity + start;
+            out[count * channels + c] = resampler->dot(x, coefs, taps);
+        }
+        count++;
+        
+        resampler->frac += resampler->down;
+        resampler->index += resampler->frac / resampler->up;
+        resampler->frac %= resampler->up;
+    }
+    
+    // Drop input no later output reaches
+    gsize shift = MIN(resampler->index, resampler->filled);
+    if (shift > 0) {
+        gsize keep = resampler->filled - shift;
+        for (int c = 0; c < channels; c++) {
+            float *h = resampler->history + c * resampler->capacity;
+            memmove(h, h + shift, keep * sizeof(float));
+        }
+        resampler->filled = keep;
+        resampler->index -= shift;
+    }
+    
+    resampler->out_total += count;
+    return count;
+}
+
+gsize audio_resampler_process(AudioResampler *resampler, const float *in, gsize frames, float *out) {
+    if (!resampler || !in || !out) return 0;
+    
+    gsize produced = 0;
+    while (frames > 0) {
+        gsize count = MIN(frames, resampler->capacity - resampler->filled);
+        append(resampler, in, count);
+        resampler->in_total += count;
+        in += count * resampler->in_channels;
+        frames -= count;
+        
+        produced += run(resampler, out + produced * resampler->channels, G_MAXSIZE);
+    }
+    
+    return produced;
+}
+
+gsize audio_resampler_drain(AudioResampler *resampler, float *out) {
+    if (!resampler || !out) return 0;
+    
+    guint64 target = (resampler->in_total * resampler->up + resampler->down - 1) / resampler->down;
+    gsize produced = 0;
+    gsize zeros = 0;
+    
+    // Silence after the input lets the filter reach its last frames
+    while (resampler->out_total < target && zeros < (gsize)resampler->taps * 2) {
+        gsize count = MIN((gsize)resampler->taps, resampler->capacity - resampler->filled);
+        append(resampler, NULL, count);
+        zeros += count;
+        produced += run(resampler, out + produced * resampler->channels, target - resampler->out_total);
+    }
+    
+    return produced;
+}
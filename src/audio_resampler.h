@@ -0,0 +1,81 @@
+#ifndef AUDIO_RESAMPLER_H
+#define AUDIO_RESAMPLER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AudioResampler AudioResampler;
+
+typedef enum {
+    AUDIO_RESAMPLER_KERNEL_AUTO,     // Best kernel the CPU supports
+    AUDIO_RESAMPLER_KERNEL_SCALAR,
+    AUDIO_RESAMPLER_KERNEL_SSE2,
+    AUDIO_RESAMPLER_KERNEL_AVX2
+} AudioResamplerKernel;
+
+/**
+ * Creates a polyphase resampler with a Kaiser-windowed sinc filter, which
+ * also down- or up-mixes channels (mono output is the average of the input
+ * channels). The ratio is kept exact; at most 1024 filter phases are
+ * stored, so unusual ratios use the nearest phase.
+ * @param in_rate Input sample rate in Hz
+ * @param in_channels Input channel count
+ * @param out_rate Output sample rate in Hz
+ * @param out_channels Output channel count
+ * @param kernel Filter kernel; AUTO picks the fastest supported one
+ * @return New AudioResampler instance
+ */
+AudioResampler* audio_resampler_new(unsigned int in_rate, int in_channels, unsigned int out_rate, int out_channels, AudioResamplerKernel kernel);
+
+/**
+ * Frees a resampler
+ * @param resampler AudioResampler instance to free
+ */
+void audio_resampler_free(AudioResampler *resampler);
+
+/**
+ * Gets the most frames one call can produce, to size output buffers
+ * @param resampler AudioResampler instance
+ * @param frames Input frames passed to audio_resampler_process
+ * @return Output frame bound (also enough for audio_resampler_drain)
+ */
+gsize audio_resampler_get_max_output(AudioResampler *resampler, gsize frames);
+
+/**
+ * Converts a block of input. Output lags the input by half the filter
+ * length; audio_resampler_drain returns the rest at the end.
+ * @param resampler AudioResampler instance
+ * @param in Interleaved input frames
+ * @param frames Number of input frames
+ * @param out Interleaved output frames, see audio_resampler_get_max_output
+ * @return Number of output frames written
+ */
+gsize audio_resampler_process(AudioResampler *resampler, const float *in, gsize frames, float *out);
+
+/**
+ * Flushes the filter after the last input, so the total output is the
+ * input length scaled by the rate ratio (rounded up)
+ * @param resampler AudioResampler instance
+ * @param out Interleaved output frames, see audio_resampler_get_max_output
+ * @return Number of output frames written
+ */
+gsize audio_resampler_drain(AudioResampler *resampler, float *out);
+
+/**
+ * Checks whether a kernel can run on this CPU
+ * @param kernel Kernel to check
+ * @return TRUE if supported
+ */
+gboolean audio_resampler_kernel_supported(AudioResamplerKernel kernel);
+
+/**
+ * Gets a kernel's name
+ * @param kernel Kernel, AUTO resolves to the one that would be used
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char* audio_resampler_kernel_name(AudioResamplerKernel kernel);
+
+G_END_DECLS
+
+#endif // AUDIO_RESAMPLER_H
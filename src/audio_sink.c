@@ -0,0 +1,384 @@
+#include "audio_sink.h"
+#include "wav_file.h"
+#include <alsa/asoundlib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Small buffer so a sound starts quickly once the device is idle
+#define AUDIO_BUFFER_TIME_US 100000
+#define AUDIO_PERIOD_TIME_US 20000
+
+typedef struct {
+    const char *name;
+    gboolean (*open)(AudioSink *sink);
+    gboolean (*write)(AudioSink *sink, const gint16 *samples, gsize frames);
+    gsize (*get_delay)(AudioSink *sink);
+    void (*drain)(AudioSink *sink);
+    void (*close)(AudioSink *sink);
+} AudioSinkOps;
+
+struct _AudioSink {
+    const AudioSinkOps *ops;
+    gboolean is_open;
+    unsigned int rate;
+    int channels;
+    gsize period_frames;
+    
+    GMutex stats_lock;
+    AudioSinkStats stats;
+    
+    // ALSA
+    snd_pcm_t *handle;
+    
+    // Simulated device (null and capture): a clock started by the first
+    // write plays the frames back at the sink's rate
+    gboolean paced;
+    gboolean running;
+    gint64 clock_start_us;
+    gint64 clock_frames;         // Frames written since the clock started
+    gsize buffer_frames;
+    
+    // Capture
+    char *path;
+    WavWriter *wav;
+    FILE *timestamps;
+    gint64 open_us;
+};
+
+static AudioSink* sink_new(const AudioSinkOps *ops);
+static void count_write(AudioSink *sink, gsize frames);
+static void count_underrun(AudioSink *sink);
+
+static gboolean alsa_open(AudioSink *sink);
+static gboolean alsa_write(AudioSink *sink, const gint16 *samples, gsize frames);
+static gsize alsa_get_delay(AudioSink *sink);
+static void alsa_drain(AudioSink *sink);
+static void alsa_close(AudioSink *sink);
+
+static gboolean null_open(AudioSink *sink);
+static gboolean null_write(AudioSink *sink, const gint16 *samples, gsize frames);
+static gsize null_get_delay(AudioSink *sink);
+static void null_drain(AudioSink *sink);
+static void null_close(AudioSink *sink);
+static gint64 queued_frames(AudioSink *sink, gint64 now);
+
+static gboolean capture_open(AudioSink *sink);
+static gboolean capture_write(AudioSink *sink, const gint16 *samples, gsize frames);
+static void capture_close(AudioSink *sink);
+
+static const AudioSinkOps alsa_ops = {"alsa", alsa_open, alsa_write, alsa_get_delay, alsa_drain, alsa_close};
+static const AudioSinkOps null_ops = {"null", null_open, null_write, null_get_delay, null_drain, null_close};
+static const AudioSinkOps capture_ops = {"capture", capture_open, capture_write, null_get_delay, null_drain, capture_close};
+
+AudioSink* audio_sink_new_alsa(void) {
+    return sink_new(&alsa_ops);
+}
+
+AudioSink* audio_sink_new_null(gboolean paced) {
+    AudioSink *sink = sink_new(&null_ops);
+    sink->paced = paced;
+    return sink;
+}
+
+AudioSink* audio_sink_new_capture(const char *path, gboolean paced) {
+    if (!path || !*path) return NULL;
+    
+    AudioSink *sink = sink_new(&capture_ops);
+    sink->paced = paced;
+    sink->path = g_strdup(path);
+    return sink;
+}
+
+AudioSink* audio_sink_new_from_spec(const char *spec) {
+    if (!spec || !*spec || g_strcmp0(spec, "alsa") == 0) return audio_sink_new_alsa();
+    if (g_strcmp0(spec, "null") == 0) return audio_sink_new_null(TRUE);
+    if (g_strcmp0(spec, "null-fast") == 0) return audio_sink_new_null(FALSE);
+    if (g_str_has_prefix(spec, "capture:")) return audio_sink_new_capture(spec + strlen("capture:"), TRUE);
+    if (g_str_has_prefix(spec, "capture-fast:")) return audio_sink_new_capture(spec + strlen("capture-fast:"), FALSE);
+    return NULL;
+}
+
+void audio_sink_free(AudioSink *sink) {
+    if (!sink) return;
+    
+    if (sink->is_open) sink->ops->close(sink);
+    g_mutex_clear(&sink->stats_lock);
+    g_free(sink->path);
+    g_free(sink);
+}
+
+gboolean audio_sink_open(AudioSink *sink, unsigned int *rate, int channels, gsize *period_frames) {
+    if (!sink || !rate || sink->is_open) return FALSE;
+    
+    sink->rate = *rate;
+    sink->channels = channels;
+    if (!sink->ops->open(sink)) return FALSE;
+    
+    sink->is_open = TRUE;
+    *rate = sink->rate;
+    if (period_frames) *period_frames = sink->period_frames;
+    return TRUE;
+}
+
+gboolean audio_sink_write(AudioSink *sink, const gint16 *samples, gsize frames) {
+    if (!sink || !sink->is_open) return FALSE;
+    if (!sink->ops->write(sink, samples, frames)) return FALSE;
+    
+    count_write(sink, frames);
+    return TRUE;
+}
+
+gsize audio_sink_get_delay(AudioSink *sink) {
+    if (!sink || !sink->is_open) return 0;
+    
+    return sink->ops->get_delay(sink);
+}
+
+void audio_sink_drain(AudioSink *sink) {
+    if (!sink || !sink->is_open) return;
+    
+    sink->ops->drain(sink);
+}
+
+void audio_sink_get_stats(AudioSink *sink, AudioSinkStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(AudioSinkStats));
+    if (!sink) return;
+    
+    g_mutex_lock(&sink->stats_lock);
+    *stats = sink->stats;
+    g_mutex_unlock(&sink->stats_lock);
+}
+
+const char* audio_sink_get_name(AudioSink *sink) {
+    return sink ? sink->ops->name : NULL;
+}
+
+static AudioSink* sink_new(const AudioSinkOps *ops) {
+    AudioSink *sink = g_malloc0(sizeof(AudioSink));
+    sink->ops = ops;
+    g_mutex_init(&sink->stats_lock);
+    return sink;
+}
+
+static void count_write(AudioSink *sink, gsize frames) {
+    g_mutex_lock(&sink->stats_lock);
+    sink->stats.frames += frames;
+    sink->stats.writes++;
+    g_mutex_unlock(&sink->stats_lock);
+}
+
+static void count_underrun(AudioSink *sink) {
+    g_mutex_lock(&sink->stats_lock);
+    sink->stats.underruns++;
+    g_mutex_unlock(&sink->stats_lock);
+}
+
+static gboolean alsa_open(AudioSink *sink) {
+    snd_pcm_t *handle = NULL;
+    int err = -ENODEV;
+    
+    // Try different devices in order of preference
+    const char* devices[] = {"pipewire", "plughw:0,0", "default", "dmix"};
+    for (int i = 0; i < 4; i++) {
+        if ((err = snd_pcm_open(&handle, devices[i], SND_PCM_STREAM_PLAYBACK, 0)) >= 0) {
+            break;
+        }
+        handle = NULL;
+    }
+    if (!handle) return FALSE;
+    
+    snd_pcm_hw_params_t *params;
+    snd_pcm_hw_params_alloca(&params);
+    unsigned int rate = sink->rate;
+    unsigned int buffer_time = AUDIO_BUFFER_TIME_US;
+    unsigned int period_time = AUDIO_PERIOD_TIME_US;
+    
+    if ((err = snd_pcm_hw_params_any(handle, params)) < 0 ||
+        (err = snd_pcm_hw_params_set_access(handle, params, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0 ||
+        (err = snd_pcm_hw_params_set_format(handle, params, SND_PCM_FORMAT_S16_LE)) < 0 ||
+        (err = snd_pcm_hw_params_set_channels(handle, params, sink->channels)) < 0 ||
+        (err = snd_pcm_hw_params_set_rate_near(handle, params, &rate, 0)) < 0) {
+        g_warning("Cannot configure audio device: %s", snd_strerror(err));
+        snd_pcm_close(handle);
+        return FALSE;
+    }
+    
+    // Best effort; some devices have fixed buffer geometry
+    snd_pcm_hw_params_set_buffer_time_near(handle, params, &buffer_time, 0);
+    snd_pcm_hw_params_set_period_time_near(handle, params, &period_time, 0);
+    
+    if ((err = snd_pcm_hw_params(handle, params)) < 0) {
+        g_warning("Cannot set audio parameters: %s", snd_strerror(err));
+        snd_pcm_close(handle);
+        return FALSE;
+    }
+    
+    // Start as soon as one period is queued instead of when the buffer is
+    // full, which would delay short sounds by the whole buffer
+    snd_pcm_uframes_t period_size = 0;
+    snd_pcm_hw_params_get_period_size(params, &period_size, 0);
+    
+    snd_pcm_sw_params_t *sw_params;
+    snd_pcm_sw_params_alloca(&sw_params);
+    if (snd_pcm_sw_params_current(handle, sw_params) == 0) {
+        snd_pcm_sw_params_set_start_threshold(handle, sw_params, period_size > 0 ? period_size : 1);
+        snd_pcm_sw_params(handle, sw_params);
+    }
+    
+    if ((err = snd_pcm_prepare(handle)) < 0) {
+        g_warning("Cannot prepare audio interface: %s", snd_strerror(err));
+        snd_pcm_close(handle);
+        return FALSE;
+    }
+    
+    sink->handle = handle;
+    sink->rate = rate;
+    sink->period_frames = period_size > 0 ? period_size : (gsize)rate * AUDIO_PERIOD_TIME_US / G_USEC_PER_SEC;
+    return TRUE;
+}
+
+static gboolean alsa_write(AudioSink *sink, const gint16 *samples, gsize frames) {
+    snd_pcm_t *handle = sink->handle;
+    
+    // Drained after the previous sound or after an underrun
+    snd_pcm_state_t state = snd_pcm_state(handle);
+    if (state == SND_PCM_STATE_XRUN || state == SND_PCM_STATE_SETUP) {
+        if (state == SND_PCM_STATE_XRUN) count_underrun(sink);
+        snd_pcm_prepare(handle);
+    }
+    
+    while (frames > 0) {
+        snd_pcm_sframes_t written = snd_pcm_writei(handle, samples, frames);
+        
+        if (written < 0) {
+            if (written == -EPIPE) count_underrun(sink);
+            if (snd_pcm_recover(handle, (int)written, 1) < 0) {
+                g_warning("Write error: %s", snd_strerror((int)written));
+                return FALSE;
+            }
+            continue;
+        }
+        
+        samples += written * sink->channels;
+        frames -= written;
+    }
+    
+    return TRUE;
+}
+
+static gsize alsa_get_delay(AudioSink *sink) {
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(sink->handle, &delay) < 0 || delay < 0) return 0;
+    
+    return (gsize)delay;
+}
+
+static void alsa_drain(AudioSink *sink) {
+    snd_pcm_drain(sink->handle);
+    snd_pcm_prepare(sink->handle);
+}
+
+static void alsa_close(AudioSink *sink) {
+    snd_pcm_drop(sink->handle);
+    snd_pcm_close(sink->handle);
+    sink->handle = NULL;
+}
+
+static gboolean null_open(AudioSink *sink) {
+    // Same geometry the ALSA sink asks for
+    sink->period_frames = (gsize)sink->rate * AUDIO_PERIOD_TIME_US / G_USEC_PER_SEC;
+    sink->buffer_frames = (gsize)sink->rate * AUDIO_BUFFER_TIME_US / G_USEC_PER_SEC;
+    return TRUE;
+}
+
+static gboolean null_write(AudioSink *sink, const gint16 *samples, gsize frames) {
+    (void)samples; // Suppress unused parameter warning
+    if (!sink->paced) return TRUE;
+    
+    gint64 now = g_get_monotonic_time();
+    gint64 queued = queued_frames(sink, now);
+    
+    // Ran dry: the stream starts over from this write
+    if (!sink->running || queued <= 0) {
+        if (sink->running) count_underrun(sink);
+        sink->running = TRUE;
+        sink->clock_start_us = now;
+        sink->clock_frames = 0;
+        queued = 0;
+    }
+    
+    // Block until the frames fit in the buffer, like a device would
+    gint64 excess = queued + (gint64)frames - (gint64)sink->buffer_frames;
+    if (excess > 0) g_usleep(excess * G_USEC_PER_SEC / sink->rate);
+    
+    sink->clock_frames += frames;
+    return TRUE;
+}
+
+static gsize null_get_delay(AudioSink *sink) {
+    if (!sink->paced || !sink->running) return 0;
+    
+    return (gsize)MAX(queued_frames(sink, g_get_monotonic_time()), 0);
+}
+
+static void null_drain(AudioSink *sink) {
+    if (sink->paced && sink->running) {
+        gint64 queued = queued_frames(sink, g_get_monotonic_time());
+        if (queued > 0) g_usleep(queued * G_USEC_PER_SEC / sink->rate);
+    }
+    sink->running = FALSE;
+}
+
+static void null_close(AudioSink *sink) {
+    sink->running = FALSE;
+}
+
+static gint64 queued_frames(AudioSink *sink, gint64 now) {
+    return sink->clock_frames - (now - sink->clock_start_us) * sink->rate / G_USEC_PER_SEC;
+}
+
+static gboolean capture_open(AudioSink *sink) {
+    null_open(sink);
+    
+    sink->wav = wav_writer_new(sink->path, sink->rate, sink->channels);
+    if (!sink->wav) return FALSE;
+    
+    char *timestamps_path = g_strconcat(sink->path, ".timestamps", NULL);
+    sink->timestamps = fopen(timestamps_path, "w");
+    if (!sink->timestamps) {
+        g_warning("Cannot create %s: %s", timestamps_path, g_strerror(errno));
+        g_free(timestamps_path);
+        wav_writer_abort(sink->wav);
+        sink->wav = NULL;
+        return FALSE;
+    }
+    g_free(timestamps_path);
+    
+    fprintf(sink->timestamps, "# rate %u, channels %d\n# frame\ttime_us\tframes\n", sink->rate, sink->channels);
+    sink->open_us = g_get_monotonic_time();
+    return TRUE;
+}
+
+static gboolean capture_write(AudioSink *sink, const gint16 *samples, gsize frames) {
+    // The block is heard once the frames queued before it have played
+    gint64 heard_us = g_get_monotonic_time() + (gint64)null_get_delay(sink) * G_USEC_PER_SEC / sink->rate;
+    
+    AudioSinkStats stats;
+    audio_sink_get_stats(sink, &stats);
+    fprintf(sink->timestamps, "%" G_GUINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%" G_GSIZE_FORMAT "\n",
+            stats.frames, heard_us - sink->open_us, frames);
+    
+    if (!wav_writer_write(sink->wav, samples, frames)) return FALSE;
+    return null_write(sink, samples, frames);
+}
+
+static void capture_close(AudioSink *sink) {
+    null_close(sink);
+    
+    wav_writer_finish(sink->wav);  // Warns on failure
+    sink->wav = NULL;
+    fclose(sink->timestamps);
+    sink->timestamps = NULL;
+}
@@ -0,0 +1,110 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AudioSink AudioSink;
+
+/**
+ * Counters kept by every sink
+ */
+typedef struct {
+    guint64 frames;              // Frames written
+    guint writes;                // Blocks written
+    guint underruns;             // Times the stream ran dry while playing
+} AudioSinkStats;
+
+/**
+ * Creates a sink playing on the first ALSA device that opens
+ * @return New AudioSink instance
+ */
+AudioSink* audio_sink_new_alsa(void);
+
+/**
+ * Creates a sink that discards the samples. Paced, it behaves like a device
+ * with the same buffer as the ALSA sink: writes block while the buffer is
+ * full and the delay reflects the queued frames. Unpaced, writes return at
+ * once, to measure the cost of the pipeline itself.
+ * @param paced Whether to play in real time
+ * @return New AudioSink instance
+ */
+AudioSink* audio_sink_new_null(gboolean paced);
+
+/**
+ * Creates a sink that records what would have been played: the samples go
+ * to a 16-bit WAV file and, for every block written, a line with its first
+ * frame, the time it would be heard (microseconds since the sink opened)
+ * and its length goes to path with ".timestamps" appended. Paced like the
+ * null sink.
+ * @param path WAV file to write, complete once the sink is freed
+ * @param paced Whether to play in real time
+ * @return New AudioSink instance
+ */
+AudioSink* audio_sink_new_capture(const char *path, gboolean paced);
+
+/**
+ * Creates a sink from a description: "alsa", "null", "null-fast",
+ * "capture:PATH" or "capture-fast:PATH". NULL or empty means ALSA.
+ * @param spec Sink description, e.g. from COMMODORO_AUDIO_SINK
+ * @return New AudioSink instance, or NULL if spec isn't recognised
+ */
+AudioSink* audio_sink_new_from_spec(const char *spec);
+
+/**
+ * Closes the sink if open and frees it
+ * @param sink AudioSink instance to free
+ */
+void audio_sink_free(AudioSink *sink);
+
+/**
+ * Opens the sink for interleaved signed 16-bit samples and prepares it
+ * @param sink AudioSink instance
+ * @param rate Requested rate in Hz; set to the rate the sink runs at
+ * @param channels Number of interleaved channels
+ * @param period_frames Set to the frames the sink consumes per period
+ * @return TRUE if the sink is ready to play
+ */
+gboolean audio_sink_open(AudioSink *sink, unsigned int *rate, int channels, gsize *period_frames);
+
+/**
+ * Writes frames, blocking while the sink's buffer is full. Recovers from
+ * underruns by itself; playback starts once a period is queued.
+ * @param sink Open AudioSink instance
+ * @param samples Interleaved samples
+ * @param frames Number of frames
+ * @return TRUE if all frames were written, FALSE on an error the sink can't recover from
+ */
+gboolean audio_sink_write(AudioSink *sink, const gint16 *samples, gsize frames);
+
+/**
+ * Gets how many frames are queued ahead of the next frame written
+ * @param sink Open AudioSink instance
+ * @return Delay in frames
+ */
+gsize audio_sink_get_delay(AudioSink *sink);
+
+/**
+ * Lets the queued frames play out, then prepares the sink for the next write
+ * @param sink Open AudioSink instance
+ */
+void audio_sink_drain(AudioSink *sink);
+
+/**
+ * Gets the sink's counters. Safe to call from any thread.
+ * @param sink AudioSink instance
+ * @param stats Filled with the counters so far
+ */
+void audio_sink_get_stats(AudioSink *sink, AudioSinkStats *stats);
+
+/**
+ * Gets a short name for log messages
+ * @param sink AudioSink instance
+ * @return "alsa", "null" or "capture"
+ */
+const char* audio_sink_get_name(AudioSink *sink);
+
+G_END_DECLS
+
+#endif // AUDIO_SINK_H
@@ -0,0 +1,84 @@
+#ifndef AUDIO_SYNTH_H
+#define AUDIO_SYNTH_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define AUDIO_SYNTH_MAX_PARTIALS 16
+#define AUDIO_SYNTH_MAX_POINTS 16
+
+typedef struct {
+    float freq;                  // Hz
+    float amp;                   // Relative amplitude
+} AudioSynthPartial;
+
+typedef struct {
+    float time;                  // Seconds from the start
+    float level;                 // Envelope level, linear in between points
+} AudioSynthPoint;
+
+/**
+ * A generated sound: a sum of sine partials shaped by a breakpoint envelope.
+ * Partial amplitudes are normalized to their sum, then scaled by gain.
+ * Plain data, so it can be hashed to identify the samples it produces.
+ */
+typedef struct {
+    float duration;              // Seconds
+    float gain;                  // Output scale (headroom)
+    int partial_count;
+    AudioSynthPartial partials[AUDIO_SYNTH_MAX_PARTIALS];
+    int point_count;
+    AudioSynthPoint envelope[AUDIO_SYNTH_MAX_POINTS];
+} AudioSynthPatch;
+
+typedef enum {
+    AUDIO_SYNTH_KERNEL_AUTO,     // Best kernel the CPU supports
+    AUDIO_SYNTH_KERNEL_SCALAR,
+    AUDIO_SYNTH_KERNEL_SSE2,
+    AUDIO_SYNTH_KERNEL_AVX2
+} AudioSynthKernel;
+
+/**
+ * Gets the number of samples a patch renders to
+ * @param patch Sound description
+ * @param rate Sample rate in Hz
+ * @return Sample count
+ */
+int audio_synth_get_length(const AudioSynthPatch *patch, unsigned int rate);
+
+/**
+ * Renders a patch to mono signed 16-bit samples with wavetable oscillators.
+ * All kernels produce identical output.
+ * @param patch Sound description
+ * @param rate Sample rate in Hz
+ * @param out Destination, audio_synth_get_length() samples
+ * @param kernel Kernel to use; AUTO picks the fastest supported one
+ */
+void audio_synth_render(const AudioSynthPatch *patch, unsigned int rate, gint16 *out, AudioSynthKernel kernel);
+
+/**
+ * Renders a patch into a new buffer with the fastest kernel
+ * @param patch Sound description
+ * @param rate Sample rate in Hz
+ * @return Samples as GBytes
+ */
+GBytes* audio_synth_render_bytes(const AudioSynthPatch *patch, unsigned int rate);
+
+/**
+ * Checks whether a kernel can run on this CPU
+ * @param kernel Kernel to check
+ * @return TRUE if supported
+ */
+gboolean audio_synth_kernel_supported(AudioSynthKernel kernel);
+
+/**
+ * Gets a kernel's name
+ * @param kernel Kernel, AUTO resolves to the one that would be used
+ * @return "scalar", "sse2" or "avx2"
+ */
+const char* audio_synth_kernel_name(AudioSynthKernel kernel);
+
+G_END_DECLS
+
+#endif // AUDIO_SYNTH_H
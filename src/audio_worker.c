@@ -0,0 +1,207 @@
+#include "audio_worker.h"
+#include <string.h>
+
+typedef struct {
+    AudioWorkFunc func;
+    gpointer data;
+    GDestroyNotify destroy;
+    guint64 key;
+} AudioWork;
+
+typedef struct {
+    AudioWorkerPool *pool;
+    GThread *thread;
+    guint64 running_key;         // Key of the job being run, 0 if none
+} AudioWorker;
+
+struct _AudioWorkerPool {
+    GMutex lock;
+    GCond wake;
+    gboolean stopping;
+    gpointer user_data;
+    AudioWorkOverflow overflow;
+    
+    // Waiting jobs, oldest first; short enough that removing from the
+    // middle is cheaper than a linked list
+    AudioWork *queue;
+    guint capacity;
+    guint depth;
+    
+    AudioWorker *workers;
+    int worker_count;
+    AudioWorkerStats stats;
+};
+
+static gpointer worker_thread(gpointer data);
+static int find_runnable(AudioWorkerPool *pool);
+static void remove_at(AudioWorkerPool *pool, guint index);
+static void destroy_work(AudioWork *work);
+
+AudioWorkerPool* audio_worker_pool_new(const char *name, int threads, guint capacity, AudioWorkOverflow overflow, gpointer user_data) {
+    if (threads <= 0 || capacity == 0) return NULL;
+    
+    AudioWorkerPool *pool = g_malloc0(sizeof(AudioWorkerPool));
+    g_mutex_init(&pool->lock);
+    g_cond_init(&pool->wake);
+    pool->user_data = user_data;
+    pool->overflow = overflow;
+    pool->queue = g_malloc0(capacity * sizeof(AudioWork));
+    pool->capacity = capacity;
+    pool->stats.capacity = capacity;
+    pool->workers = g_malloc0(threads * sizeof(AudioWorker));
+    pool->worker_count = threads;
+    
+    for (int i = 0; i < threads; i++) {
+        char *thread_name = g_strdup_printf("%s-%d", name ? name : "audio-worker", i);
+        pool->workers[i].pool = pool;
+        pool->workers[i].thread = g_thread_new(thread_name, worker_thread, &pool->workers[i]);
+        g_free(thread_name);
+    }
+    
+    return pool;
+}
+
+void audio_worker_pool_free(AudioWorkerPool *pool) {
+    if (!pool) return;
+    
+    g_mutex_lock(&pool->lock);
+    pool->stopping = TRUE;
+    guint depth = pool->depth;
+    AudioWork *waiting = g_new(AudioWork, depth);
+    if (depth > 0) memcpy(waiting, pool->queue, depth * sizeof(AudioWork));
+    pool->depth = 0;
+    g_cond_broadcast(&pool->wake);
+    g_mutex_unlock(&pool->lock);
+    
+    for (guint i = 0; i < depth; i++) destroy_work(&waiting[i]);
+    g_free(waiting);
+    
+    for (int i = 0; i < pool->worker_count; i++) {
+        g_thread_join(pool->workers[i].thread);
+    }
+    
+    g_cond_clear(&pool->wake);
+    g_mutex_clear(&pool->lock);
+    g_free(pool->workers);
+    g_free(pool->queue);
+    g_free(pool);
+}
+
+gboolean audio_worker_pool_push(AudioWorkerPool *pool, AudioWorkFunc func, gpointer data, GDestroyNotify destroy, guint64 key) {
+    AudioWork work = {func, data, destroy, key};
+    if (!pool || !func) {
+        destroy_work(&work);
+        return FALSE;
+    }
+    
+    AudioWork discarded = {NULL, NULL, NULL, 0};
+    gboolean queued = TRUE;
+    
+    g_mutex_lock(&pool->lock);
+    pool->stats.submitted++;
+    
+    guint coalesce = pool->depth;
+    if (key != 0) {
+        for (guint i = 0; i < pool->depth; i++) {
+            if (pool->queue[i].key == key) {
+                coalesce = i;
+                break;
+            }
+        }
+    }
+    
+    if (pool->stopping) {
+        discarded = work;
+        queued = FALSE;
+    } else if (coalesce < pool->depth) {
+        // Takes the waiting job's place in line
+        discarded = pool->queue[coalesce];
+        pool->queue[coalesce] = work;
+        pool->stats.coalesced++;
+    } else if (pool->depth == pool->capacity && pool->overflow == AUDIO_WORK_DROP_NEWEST) {
+        discarded = work;
+        queued = FALSE;
+        pool->stats.dropped++;
+    } else {
+        if (pool->depth == pool->capacity) {
+            discarded = pool->queue[0];
+            remove_at(pool, 0);
+            pool->stats.dropped++;
+        }
+        pool->queue[pool->depth++] = work;
+        pool->stats.max_depth = MAX(pool->stats.max_depth, pool->depth);
+    }
+    
+    // Every worker: the first one woken may be held back by the key
+    if (queued) g_cond_broadcast(&pool->wake);
+    g_mutex_unlock(&pool->lock);
+    
+    destroy_work(&discarded);
+    return queued;
+}
+
+void audio_worker_pool_get_stats(AudioWorkerPool *pool, AudioWorkerStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(AudioWorkerStats));
+    if (!pool) return;
+    
+    g_mutex_lock(&pool->lock);
+    *stats = pool->stats;
+    stats->depth = pool->depth;
+    g_mutex_unlock(&pool->lock);
+}
+
+static gpointer worker_thread(gpointer data) {
+    AudioWorker *worker = (AudioWorker*)data;
+    AudioWorkerPool *pool = worker->pool;
+    
+    g_mutex_lock(&pool->lock);
+    for (;;) {
+        int next = -1;
+        while (!pool->stopping && (next = find_runnable(pool)) < 0) {
+            g_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) break;
+        
+        AudioWork work = pool->queue[next];
+        remove_at(pool, (guint)next);
+        worker->running_key = work.key;
+        g_mutex_unlock(&pool->lock);
+        
+        work.func(work.data, pool->user_data);
+        destroy_work(&work);
+        
+        g_mutex_lock(&pool->lock);
+        worker->running_key = 0;
+        pool->stats.completed++;
+        
+        // A job waiting for this key can run now
+        if (work.key != 0) g_cond_broadcast(&pool->wake);
+    }
+    g_mutex_unlock(&pool->lock);
+    
+    return NULL;
+}
+
+// Oldest waiting job whose key isn't being run by another worker
+static int find_runnable(AudioWorkerPool *pool) {
+    for (guint i = 0; i < pool->depth; i++) {
+        guint64 key = pool->queue[i].key;
+        gboolean busy = FALSE;
+        
+        for (int w = 0; key != 0 && w < pool->worker_count; w++) {
+            if (pool->workers[w].running_key == key) busy = TRUE;
+        }
+        if (!busy) return (int)i;
+    }
+    return -1;
+}
+
+static void remove_at(AudioWorkerPool *pool, guint index) {
+    memmove(pool->queue + index, pool->queue + index + 1, (pool->depth - index - 1) * sizeof(AudioWork));
+    pool->depth--;
+}
+
+static void destroy_work(AudioWork *work) {
+    if (work->destroy) work->destroy(work->data);
+}
@@ -0,0 +1,71 @@
+#ifndef AUDIO_WORKER_H
+#define AUDIO_WORKER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AudioWorkerPool AudioWorkerPool;
+
+/**
+ * Runs one job on a worker thread
+ * @param data Data given to audio_worker_pool_push
+ * @param user_data Data given to audio_worker_pool_new
+ */
+typedef void (*AudioWorkFunc)(gpointer data, gpointer user_data);
+
+typedef enum {
+    AUDIO_WORK_DROP_NEWEST,      // A full queue refuses the new job
+    AUDIO_WORK_DROP_OLDEST       // A full queue discards its oldest job
+} AudioWorkOverflow;
+
+typedef struct {
+    guint depth;                 // Jobs waiting now
+    guint max_depth;             // Most jobs waiting at once
+    guint capacity;
+    guint submitted;
+    guint completed;
+    guint coalesced;             // Replaced while waiting by a job with the same key
+    guint dropped;               // Discarded because the queue was full
+} AudioWorkerStats;
+
+/**
+ * Starts a fixed number of worker threads sharing one bounded queue
+ * @param name Thread name prefix
+ * @param threads Number of threads
+ * @param capacity Most jobs that can wait at once
+ * @param overflow What a full queue drops
+ * @param user_data Passed to every job
+ * @return New AudioWorkerPool instance
+ */
+AudioWorkerPool* audio_worker_pool_new(const char *name, int threads, guint capacity, AudioWorkOverflow overflow, gpointer user_data);
+
+/**
+ * Stops the pool: waiting jobs are discarded, running jobs finish and the
+ * threads are joined
+ * @param pool AudioWorkerPool instance to free
+ */
+void audio_worker_pool_free(AudioWorkerPool *pool);
+
+/**
+ * Queues a job. A waiting job with the same key is replaced by this one,
+ * and jobs with the same key never run at the same time.
+ * @param pool AudioWorkerPool instance
+ * @param func Function to run
+ * @param data Job data
+ * @param destroy Frees data after the job ran or was dropped, or NULL
+ * @param key Coalescing key, 0 for none
+ * @return TRUE if queued; otherwise data has already been destroyed
+ */
+gboolean audio_worker_pool_push(AudioWorkerPool *pool, AudioWorkFunc func, gpointer data, GDestroyNotify destroy, guint64 key);
+
+/**
+ * Gets queue statistics
+ * @param pool AudioWorkerPool instance
+ * @param stats Filled with the statistics so far
+ */
+void audio_worker_pool_get_stats(AudioWorkerPool *pool, AudioWorkerStats *stats);
+
+G_END_DECLS
+
+#endif // AUDIO_WORKER_H
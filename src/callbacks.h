@@ -6,4 +6,9 @@
 void on_start_clicked(GtkButton *button, GomodaroApp *app);
 void on_reset_clicked(GtkButton *button, GomodaroApp *app);
 
+// Named timers running alongside the main pomodoro timer
+Timer* app_add_named_timer(GomodaroApp *app, const char *name);
+gboolean app_remove_named_timer(GomodaroApp *app, const char *name);
+gboolean app_toggle_named_timer(GomodaroApp *app, const char *name);
+
 #endif // CALLBACKS_H
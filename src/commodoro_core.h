@@ -0,0 +1,25 @@
+#ifndef COMMODORO_CORE_H
+#define COMMODORO_CORE_H
+
+/*
+ * libcommodoro-core: the headless part of Commodoro (timer state machine,
+ * named timers on a shared timing wheel, crash-safe timer snapshots,
+ * settings and config persistence, duration parsing). Depends on GLib only,
+ * so it can be embedded or benchmarked without initializing GTK.
+ *
+ * The API declared by these headers is stable within a major version; the
+ * shared library's soname carries COMMODORO_CORE_VERSION_MAJOR.
+ */
+
+#include "timer.h"
+#include "timer_wheel.h"
+#include "timer_group.h"
+#include "timer_snapshot.h"
+#include "settings.h"
+#include "config.h"
+#include "duration.h"
+
+#define COMMODORO_CORE_VERSION_MAJOR 1
+#define COMMODORO_CORE_VERSION_MINOR 2
+
+#endif // COMMODORO_CORE_H
@@ -1,6 +1,7 @@
 #include "config.h"
 #include <glib/gstdio.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 struct _Config {
@@ -13,6 +14,7 @@ static gboolean ensure_config_directory(const char *config_dir);
 static Settings* parse_config_file(const char *config_file);
 static gboolean write_config_file(const char *config_file, const Settings *settings);
 static char* escape_json_string(const char *str);
+static char* unescape_json_string(const char *str);
 
 Config* config_new(gboolean use_persistent) {
     Config *config = g_malloc0(sizeof(Config));
@@ -181,6 +183,21 @@ static Settings* parse_config_file(const char *config_file) {
             } else if (strcmp(key, "sound_type") == 0) {
                 g_free(settings->sound_type);
                 settings->sound_type = g_strdup(value);
+            } else if (strcmp(key, "ambient_noise") == 0) {
+                g_free(settings->ambient_noise);
+                settings->ambient_noise = g_strdup(value);
+            } else if (strcmp(key, "work_start_sound") == 0) {
+                g_free(settings->work_start_sound);
+                settings->work_start_sound = unescape_json_string(value);
+            } else if (strcmp(key, "break_start_sound") == 0) {
+                g_free(settings->break_start_sound);
+                settings->break_start_sound = unescape_json_string(value);
+            } else if (strcmp(key, "session_complete_sound") == 0) {
+                g_free(settings->session_complete_sound);
+                settings->session_complete_sound = unescape_json_string(value);
+            } else if (strcmp(key, "timer_finish_sound") == 0) {
+                g_free(settings->timer_finish_sound);
+                settings->timer_finish_sound = unescape_json_string(value);
             }
         }
         
@@ -215,6 +232,12 @@ static gboolean write_config_file(const char *config_file, const Settings *setti
         g_free(escaped);
     }
     
+    if (settings->ambient_noise) {
+        char *escaped = escape_json_string(settings->ambient_noise);
+        fprintf(file, ",\n  \"ambient_noise\": \"%s\"", escaped);
+        g_free(escaped);
+    }
+    
     if (settings->work_start_sound) {
         char *escaped = escape_json_string(settings->work_start_sound);
         fprintf(file, ",\n  \"work_start_sound\": \"%s\"", escaped);
@@ -260,4 +283,17 @@ static char* escape_json_string(const char *str) {
     char *result = g_strdup(escaped->str);
     g_string_free(escaped, TRUE);
     return result;
+}
+
+static char* unescape_json_string(const char *str) {
+    // Reverses escape_json_string; an empty string means no file
+    if (!str || !*str) return NULL;
+    
+    GString *unescaped = g_string_new("");
+    for (const char *p = str; *p; p++) {
+        if (*p == '\\' && p[1]) p++;
+        g_string_append_c(unescaped, *p);
+    }
+    
+    return g_string_free(unescaped, FALSE);
 }
\ No newline at end of file
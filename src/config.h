@@ -2,7 +2,7 @@
 #define CONFIG_H
 
 #include <glib.h>
-#include "settings_dialog.h"
+#include "settings.h"
 
 G_BEGIN_DECLS
 
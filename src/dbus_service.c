@@ -7,14 +7,24 @@ struct _DBusService {
     GDBusConnection *connection;
     guint owner_id;
     gpointer app_pointer;
+    
+    // logind sleep notifications on the system bus
+    GDBusConnection *system_connection;
+    guint sleep_subscription_id;
+    GCancellable *system_cancellable;
 };
 
 static void on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data);
 static void on_name_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data);
 static void on_name_lost(GDBusConnection *connection, const gchar *name, gpointer user_data);
 
+static void on_system_bus_ready(GObject *source, GAsyncResult *result, gpointer user_data);
+static void on_prepare_for_sleep(GDBusConnection *connection, const gchar *sender_name, const gchar *object_path, const gchar *interface_name, const gchar *signal_name, GVariant *parameters, gpointer user_data);
+
 static void handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *method_name, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer user_data);
 
+static const char* timer_state_to_string(TimerState state);
+
 static const GDBusInterfaceVTable interface_vtable = {
     .method_call = handle_method_call
 };
@@ -40,6 +50,10 @@ void dbus_service_publish(DBusService *service) {
                                      on_name_lost,
                                      service,
                                      NULL);
+    
+    // Watch for resume from suspend so the timer can catch up immediately
+    service->system_cancellable = g_cancellable_new();
+    g_bus_get(G_BUS_TYPE_SYSTEM, service->system_cancellable, on_system_bus_ready, service);
 }
 
 void dbus_service_unpublish(DBusService *service) {
@@ -47,6 +61,62 @@ void dbus_service_unpublish(DBusService *service) {
         g_bus_unown_name(service->owner_id);
         service->owner_id = 0;
     }
+    
+    if (service->system_cancellable) {
+        g_cancellable_cancel(service->system_cancellable);
+        g_object_unref(service->system_cancellable);
+        service->system_cancellable = NULL;
+    }
+    
+    if (service->system_connection) {
+        if (service->sleep_subscription_id) {
+            g_dbus_connection_signal_unsubscribe(service->system_connection, service->sleep_subscription_id);
+            service->sleep_subscription_id = 0;
+        }
+        g_object_unref(service->system_connection);
+        service->system_connection = NULL;
+    }
+}
+
+static void on_system_bus_ready(GObject *source, GAsyncResult *result, gpointer user_data) {
+    (void)source;
+    GError *error = NULL;
+    GDBusConnection *connection = g_bus_get_finish(result, &error);
+    
+    if (!connection) {
+        // Cancelled during shutdown, or no system bus (containers, CI)
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning("System bus unavailable, suspend detection disabled: %s", error->message);
+        }
+        g_error_free(error);
+        return;
+    }
+    
+    DBusService *service = (DBusService*)user_data;
+    service->system_connection = connection;
+    service->sleep_subscription_id = g_dbus_connection_signal_subscribe(connection,
+                                                                         "org.freedesktop.login1",
+                                                                         "org.freedesktop.login1.Manager",
+                                                                         "PrepareForSleep",
+                                                                         "/org/freedesktop/login1",
+                                                                         NULL,
+                                                                         G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                         on_prepare_for_sleep,
+                                                                         service,
+                                                                         NULL);
+}
+
+static void on_prepare_for_sleep(GDBusConnection *connection, const gchar *sender_name, const gchar *object_path, const gchar *interface_name, const gchar *signal_name, GVariant *parameters, gpointer user_data) {
+    DBusService *service = (DBusService*)user_data;
+    GomodaroApp *app = (GomodaroApp*)service->app_pointer;
+    gboolean going_to_sleep = FALSE;
+    
+    g_variant_get(parameters, "(b)", &going_to_sleep);
+    
+    // PrepareForSleep(false) is sent after resume
+    if (!going_to_sleep && app && app->timers) {
+        timer_group_resync(app->timers);
+    }
 }
 
 static void on_bus_acquired(GDBusConnection *connection, const gchar *name, gpointer user_data) {
@@ -71,6 +141,21 @@ static void on_name_acquired(GDBusConnection *connection, const gchar *name, gpo
         "    <method name='GetState'>"
         "      <arg type='s' name='state' direction='out'/>"
         "    </method>"
+        "    <method name='AddTimer'>"
+        "      <arg type='s' name='name' direction='in'/>"
+        "    </method>"
+        "    <method name='RemoveTimer'>"
+        "      <arg type='s' name='name' direction='in'/>"
+        "    </method>"
+        "    <method name='ToggleNamedTimer'>"
+        "      <arg type='s' name='name' direction='in'/>"
+        "    </method>"
+        "    <method name='ResetNamedTimer'>"
+        "      <arg type='s' name='name' direction='in'/>"
+        "    </method>"
+        "    <method name='ListTimers'>"
+        "      <arg type='a(ssi)' name='timers' direction='out'/>"
+        "    </method>"
         "  </interface>"
         "</node>";
 
@@ -95,6 +180,12 @@ static void on_name_acquired(GDBusConnection *connection, const gchar *name, gpo
         g_warning("Failed to register D-Bus object: %s", error->message);
         g_error_free(error);
     }
+    
+    // The tray item shares this connection
+    GomodaroApp *app = (GomodaroApp*)service->app_pointer;
+    if (app && app->status_notifier) {
+        status_notifier_attach(app->status_notifier, connection);
+    }
 }
 
 static void on_name_lost(GDBusConnection *connection, const gchar *name, gpointer user_data) {
@@ -125,18 +216,65 @@ static void handle_method_call(GDBusConnection *connection, const gchar *sender,
         }
         g_dbus_method_invocation_return_value(invocation, NULL);
     } else if (g_strcmp0(method_name, "GetState") == 0) {
-        TimerState state = timer_get_state(app->timer);
-        const char *state_str;
-        switch (state) {
-            case TIMER_STATE_IDLE: state_str = "IDLE"; break;
-            case TIMER_STATE_WORK: state_str = "WORK"; break;
-            case TIMER_STATE_SHORT_BREAK: state_str = "SHORT_BREAK"; break;
-            case TIMER_STATE_LONG_BREAK: state_str = "LONG_BREAK"; break;
-            case TIMER_STATE_PAUSED: state_str = "PAUSED"; break;
-            default: state_str = "UNKNOWN"; break;
-        }
+        const char *state_str = timer_state_to_string(timer_get_state(app->timer));
         g_dbus_method_invocation_return_value(invocation, g_variant_new("(s)", state_str));
+    } else if (g_strcmp0(method_name, "AddTimer") == 0) {
+        const gchar *name;
+        g_variant_get(parameters, "(&s)", &name);
+        if (app_add_named_timer(app, name)) {
+            g_dbus_method_invocation_return_value(invocation, NULL);
+        } else {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.dl.commodoro.Error.InvalidName", "Timer name is empty or already in use");
+        }
+    } else if (g_strcmp0(method_name, "RemoveTimer") == 0) {
+        const gchar *name;
+        g_variant_get(parameters, "(&s)", &name);
+        if (app_remove_named_timer(app, name)) {
+            g_dbus_method_invocation_return_value(invocation, NULL);
+        } else {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.dl.commodoro.Error.InvalidName", "No removable timer with that name");
+        }
+    } else if (g_strcmp0(method_name, "ToggleNamedTimer") == 0) {
+        const gchar *name;
+        g_variant_get(parameters, "(&s)", &name);
+        if (app_toggle_named_timer(app, name)) {
+            g_dbus_method_invocation_return_value(invocation, NULL);
+        } else {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.dl.commodoro.Error.InvalidName", "No timer with that name");
+        }
+    } else if (g_strcmp0(method_name, "ResetNamedTimer") == 0) {
+        const gchar *name;
+        g_variant_get(parameters, "(&s)", &name);
+        Timer *timer = timer_group_lookup(app->timers, name);
+        if (timer) {
+            timer_reset(timer);
+            g_dbus_method_invocation_return_value(invocation, NULL);
+        } else {
+            g_dbus_method_invocation_return_dbus_error(invocation, "org.dl.commodoro.Error.InvalidName", "No timer with that name");
+        }
+    } else if (g_strcmp0(method_name, "ListTimers") == 0) {
+        GVariantBuilder builder;
+        g_variant_builder_init(&builder, G_VARIANT_TYPE("a(ssi)"));
+        for (guint i = 0; i < timer_group_get_count(app->timers); i++) {
+            Timer *timer = timer_group_get_timer(app->timers, i);
+            int minutes, seconds;
+            timer_get_remaining(timer, &minutes, &seconds);
+            g_variant_builder_add(&builder, "(ssi)", timer_group_get_name(app->timers, i),
+                                  timer_state_to_string(timer_get_state(timer)), minutes * 60 + seconds);
+        }
+        g_dbus_method_invocation_return_value(invocation, g_variant_new("(a(ssi))", &builder));
     } else {
         g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.UnknownMethod", "Method does not exist");
     }
 }
+
+static const char* timer_state_to_string(TimerState state) {
+    switch (state) {
+        case TIMER_STATE_IDLE: return "IDLE";
+        case TIMER_STATE_WORK: return "WORK";
+        case TIMER_STATE_SHORT_BREAK: return "SHORT_BREAK";
+        case TIMER_STATE_LONG_BREAK: return "LONG_BREAK";
+        case TIMER_STATE_PAUSED: return "PAUSED";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,35 @@
+#include "duration.h"
+#include <stdlib.h>
+#include <string.h>
+
+int parse_duration_to_seconds(const char *duration_str) {
+    if (!duration_str) return 0;
+    
+    int len = strlen(duration_str);
+    if (len == 0) return 0;
+    
+    char *endptr;
+    int value = strtol(duration_str, &endptr, 10);
+    
+    if (endptr == duration_str) {
+        // No digits found
+        return 0;
+    }
+    
+    // Check for time unit suffix
+    if (*endptr == 's') {
+        // Seconds
+        return value;
+    } else if (*endptr == 'm') {
+        // Minutes
+        return value * 60;
+    } else if (*endptr == 'h') {
+        // Hours
+        return value * 3600;
+    } else if (*endptr == '\0') {
+        // No suffix, assume minutes
+        return value * 60;
+    }
+    
+    return 0; // Invalid format
+}
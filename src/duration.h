@@ -0,0 +1,17 @@
+#ifndef DURATION_H
+#define DURATION_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Parses a duration string such as "25m", "30s", "1h" or "25"
+ * @param duration_str Duration with optional unit suffix (s, m, h; no suffix = minutes)
+ * @return Duration in seconds, or 0 if the string is empty or invalid
+ */
+int parse_duration_to_seconds(const char *duration_str);
+
+G_END_DECLS
+
+#endif // DURATION_H
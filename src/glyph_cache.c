@@ -0,0 +1,266 @@
+#include "glyph_cache.h"
+#include <math.h>
+#include <string.h>
+
+// Font sizes with rasterized masks; the tray renders at one size per
+// TrayIcon size cache, so this only needs to cover a few
+#define GLYPH_CACHE_SIZES 4
+
+// Everything the tray ever draws. "●" and "||" are kept as one symbol each.
+static const char *const cached_symbols[] = {
+    "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "●", "||"
+};
+#define SYMBOL_COUNT ((int)G_N_ELEMENTS(cached_symbols))
+
+// Longest text composed from symbols; longer strings use the fallback path
+#define MAX_SYMBOLS_PER_TEXT 16
+
+typedef struct {
+    cairo_surface_t *mask;       // A8 coverage, NULL if the symbol has no ink
+    int mask_x;                  // Mask origin relative to the pen position
+    int mask_y;
+    cairo_text_extents_t extents;
+} CachedSymbol;
+
+typedef struct {
+    double font_size;            // 0 if unused
+    guint64 last_used;
+    cairo_scaled_font_t *scaled_font;
+    CachedSymbol symbols[SYMBOL_COUNT];
+} GlyphSet;
+
+struct _GlyphCache {
+    cairo_font_face_t *face;
+    cairo_font_options_t *options;
+    GlyphSet sets[GLYPH_CACHE_SIZES];
+    guint64 use_counter;
+    guint rasterized;
+    guint drawn;
+};
+
+static GlyphSet* get_glyph_set(GlyphCache *cache, double font_size);
+static void clear_glyph_set(GlyphSet *set);
+static void rasterize_symbol(GlyphCache *cache, GlyphSet *set, int index);
+static int split_symbols(const char *text, int *indices);
+static void compose_extents(GlyphSet *set, const int *indices, int count, cairo_text_extents_t *extents);
+
+GlyphCache* glyph_cache_new(const char *family, cairo_font_weight_t weight) {
+    GlyphCache *cache = g_malloc0(sizeof(GlyphCache));
+    
+    // Resolved through fontconfig once instead of on every redraw
+    cache->face = cairo_toy_font_face_create(family, CAIRO_FONT_SLANT_NORMAL, weight);
+    cache->options = cairo_font_options_create();
+    
+    return cache;
+}
+
+void glyph_cache_free(GlyphCache *cache) {
+    if (!cache) return;
+    
+    for (int i = 0; i < GLYPH_CACHE_SIZES; i++) {
+        clear_glyph_set(&cache->sets[i]);
+    }
+    cairo_font_options_destroy(cache->options);
+    cairo_font_face_destroy(cache->face);
+    g_free(cache);
+}
+
+void glyph_cache_get_extents(GlyphCache *cache, const char *text, double font_size, cairo_text_extents_t *extents) {
+    if (!extents) return;
+    memset(extents, 0, sizeof(cairo_text_extents_t));
+    if (!cache || !text) return;
+    
+    GlyphSet *set = get_glyph_set(cache, font_size);
+    int indices[MAX_SYMBOLS_PER_TEXT];
+    int count = split_symbols(text, indices);
+    
+    if (count >= 0) {
+        compose_extents(set, indices, count, extents);
+    } else {
+        cairo_scaled_font_text_extents(set->scaled_font, text, extents);
+    }
+}
+
+void glyph_cache_draw_centered(GlyphCache *cache, cairo_t *cr, const char *text, double font_size, double center_x, double center_y) {
+    if (!cache || !cr || !text) return;
+    
+    GlyphSet *set = get_glyph_set(cache, font_size);
+    int indices[MAX_SYMBOLS_PER_TEXT];
+    int count = split_symbols(text, indices);
+    cairo_text_extents_t extents;
+    
+    if (count < 0) {
+        // Not made of cached symbols: still skip the font lookup
+        cairo_scaled_font_text_extents(set->scaled_font, text, &extents);
+        cairo_set_scaled_font(cr, set->scaled_font);
+        cairo_move_to(cr, center_x - (extents.width / 2.0 + extents.x_bearing),
+                      center_y - (extents.height / 2.0 + extents.y_bearing));
+        cairo_show_text(cr, text);
+        return;
+    }
+    
+    compose_extents(set, indices, count, &extents);
+    
+    // Snap the origin to whole pixels so the masks land on the pixel grid
+    // they were rasterized for
+    double origin_x = round(center_x - (extents.width / 2.0 + extents.x_bearing));
+    double origin_y = round(center_y - (extents.height / 2.0 + extents.y_bearing));
+    double pen = 0;
+    
+    for (int i = 0; i < count; i++) {
+        CachedSymbol *symbol = &set->symbols[indices[i]];
+        if (symbol->mask) {
+            cairo_mask_surface(cr, symbol->mask, origin_x + pen + symbol->mask_x, origin_y + symbol->mask_y);
+            cache->drawn++;
+        }
+        pen += symbol->extents.x_advance;
+    }
+}
+
+void glyph_cache_get_stats(GlyphCache *cache, guint *rasterized, guint *drawn) {
+    if (rasterized) *rasterized = cache ? cache->rasterized : 0;
+    if (drawn) *drawn = cache ? cache->drawn : 0;
+}
+
+// Returns the set for the given size, rasterizing all symbols into the
+// least recently used set if the size is new
+static GlyphSet* get_glyph_set(GlyphCache *cache, double font_size) {
+    GlyphSet *victim = NULL;
+    GlyphSet *set = NULL;
+    
+    for (int i = 0; i < GLYPH_CACHE_SIZES; i++) {
+        GlyphSet *candidate = &cache->sets[i];
+        if (candidate->font_size == font_size) {
+            set = candidate;
+            break;
+        }
+        if (!victim || candidate->font_size == 0 || (victim->font_size != 0 && candidate->last_used < victim->last_used)) {
+            victim = candidate;
+        }
+    }
+    
+    if (!set) {
+        set = victim;
+        clear_glyph_set(set);
+        
+        cairo_matrix_t font_matrix;
+        cairo_matrix_t ctm;
+        cairo_matrix_init_scale(&font_matrix, font_size, font_size);
+        cairo_matrix_init_identity(&ctm);
+        set->scaled_font = cairo_scaled_font_create(cache->face, &font_matrix, &ctm, cache->options);
+        set->font_size = font_size;
+        
+        for (int i = 0; i < SYMBOL_COUNT; i++) {
+            rasterize_symbol(cache, set, i);
+        }
+    }
+    
+    set->last_used = ++cache->use_counter;
+    return set;
+}
+
+static void clear_glyph_set(GlyphSet *set) {
+    for (int i = 0; i < SYMBOL_COUNT; i++) {
+        if (set->symbols[i].mask) {
+            cairo_surface_destroy(set->symbols[i].mask);
+        }
+    }
+    if (set->scaled_font) {
+        cairo_scaled_font_destroy(set->scaled_font);
+    }
+    memset(set, 0, sizeof(GlyphSet));
+}
+
+static void rasterize_symbol(GlyphCache *cache, GlyphSet *set, int index) {
+    CachedSymbol *symbol = &set->symbols[index];
+    const char *text = cached_symbols[index];
+    
+    cairo_scaled_font_text_extents(set->scaled_font, text, &symbol->extents);
+    if (symbol->extents.width <= 0 || symbol->extents.height <= 0) {
+        return;
+    }
+    
+    // Ink box rounded out to whole pixels, plus a pixel for antialiasing
+    cairo_text_extents_t *e = &symbol->extents;
+    int x0 = (int)floor(e->x_bearing) - 1;
+    int y0 = (int)floor(e->y_bearing) - 1;
+    int x1 = (int)ceil(e->x_bearing + e->width) + 1;
+    int y1 = (int)ceil(e->y_bearing + e->height) + 1;
+    
+    symbol->mask = cairo_image_surface_create(CAIRO_FORMAT_A8, x1 - x0, y1 - y0);
+    symbol->mask_x = x0;
+    symbol->mask_y = y0;
+    
+    cairo_t *cr = cairo_create(symbol->mask);
+    cairo_set_scaled_font(cr, set->scaled_font);
+    cairo_move_to(cr, -x0, -y0);
+    cairo_show_text(cr, text);
+    cairo_destroy(cr);
+    cairo_surface_flush(symbol->mask);
+    
+    cache->rasterized++;
+}
+
+// Splits text into cached symbols. Returns the number of symbols, or -1 if
+// the text contains anything that isn't cached.
+static int split_symbols(const char *text, int *indices) {
+    int count = 0;
+    
+    while (*text) {
+        int match = -1;
+        size_t length = 0;
+        
+        for (int i = 0; i < SYMBOL_COUNT; i++) {
+            size_t symbol_length = strlen(cached_symbols[i]);
+            if (strncmp(text, cached_symbols[i], symbol_length) == 0) {
+                match = i;
+                length = symbol_length;
+                break;
+            }
+        }
+        
+        if (match < 0 || count == MAX_SYMBOLS_PER_TEXT) {
+            return -1;
+        }
+        indices[count++] = match;
+        text += length;
+    }
+    
+    return count;
+}
+
+// Union of the symbols' ink boxes laid out along their advances
+static void compose_extents(GlyphSet *set, const int *indices, int count, cairo_text_extents_t *extents) {
+    double pen = 0;
+    double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+    gboolean has_ink = FALSE;
+    
+    for (int i = 0; i < count; i++) {
+        const cairo_text_extents_t *e = &set->symbols[indices[i]].extents;
+        
+        if (e->width > 0 && e->height > 0) {
+            double left = pen + e->x_bearing;
+            double top = e->y_bearing;
+            if (!has_ink) {
+                min_x = left;
+                min_y = top;
+                max_x = left + e->width;
+                max_y = top + e->height;
+                has_ink = TRUE;
+            } else {
+                min_x = MIN(min_x, left);
+                min_y = MIN(min_y, top);
+                max_x = MAX(max_x, left + e->width);
+                max_y = MAX(max_y, top + e->height);
+            }
+        }
+        pen += e->x_advance;
+    }
+    
+    extents->x_bearing = min_x;
+    extents->y_bearing = min_y;
+    extents->width = max_x - min_x;
+    extents->height = max_y - min_y;
+    extents->x_advance = pen;
+    extents->y_advance = 0;
+}
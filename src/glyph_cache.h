@@ -0,0 +1,60 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <glib.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GlyphCache GlyphCache;
+
+/**
+ * Creates a glyph cache for one font. The font face is resolved once here;
+ * the digits 0-9, "●" and "||" are rasterized into alpha masks the first
+ * time each font size is used.
+ * @param family Font family (e.g. "Sans")
+ * @param weight Font weight
+ * @return New GlyphCache object
+ */
+GlyphCache* glyph_cache_new(const char *family, cairo_font_weight_t weight);
+
+/**
+ * Frees a glyph cache and all rasterized masks
+ * @param cache GlyphCache instance to free
+ */
+void glyph_cache_free(GlyphCache *cache);
+
+/**
+ * Gets the ink extents of a string as cairo_text_extents() would report
+ * them, from the cached per-glyph metrics
+ * @param cache GlyphCache instance
+ * @param text Text to measure
+ * @param font_size Font size in pixels
+ * @param extents Where to store the extents
+ */
+void glyph_cache_get_extents(GlyphCache *cache, const char *text, double font_size, cairo_text_extents_t *extents);
+
+/**
+ * Draws a string centered on a point using the current source of cr.
+ * Cached symbols are composited from their masks; any other text falls back
+ * to the cached scaled font.
+ * @param cache GlyphCache instance
+ * @param cr Cairo context to draw into
+ * @param text Text to draw
+ * @param font_size Font size in pixels
+ * @param center_x Horizontal center of the text's ink box
+ * @param center_y Vertical center of the text's ink box
+ */
+void glyph_cache_draw_centered(GlyphCache *cache, cairo_t *cr, const char *text, double font_size, double center_x, double center_y);
+
+/**
+ * Gets mask usage statistics for profiling
+ * @param cache GlyphCache instance
+ * @param rasterized Pointer to store the number of masks rasterized (can be NULL)
+ * @param drawn Pointer to store the number of masks composited (can be NULL)
+ */
+void glyph_cache_get_stats(GlyphCache *cache, guint *rasterized, guint *drawn);
+
+G_END_DECLS
+
+#endif // GLYPH_CACHE_H
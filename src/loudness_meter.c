@@ -0,0 +1,211 @@
+#include "loudness_meter.h"
+#include <math.h>
+
+// Gating blocks are 400 ms long and start every 100 ms
+#define SUBBLOCK_MS 100
+#define BLOCK_SUBBLOCKS 4
+
+#define ABSOLUTE_GATE_LUFS -70.0
+#define RELATIVE_GATE_LU -10.0
+
+// Gated blocks are counted in 0.1 LU bins from the absolute gate up; the
+// relative gate is then exact to a bin
+#define HISTOGRAM_BINS_PER_LU 10
+#define HISTOGRAM_BINS 800          // -70 to +10 LUFS
+
+// Filter state below this is flushed, so silence never runs on denormals
+#define STATE_FLUSH 1e-30
+
+typedef struct {
+    double b0, b1, b2;
+    double a1, a2;
+} Biquad;
+
+struct _LoudnessMeter {
+    int channels;
+    Biquad shelf;               // K-weighting stage 1: head, +4 dB above 2 kHz
+    Biquad highpass;            // K-weighting stage 2: RLB high-pass
+    double *state;              // Per channel: shelf z1 z2, high-pass z1 z2
+    double *weights;            // Per channel
+    float peak;
+    
+    gsize subblock_frames;
+    gsize subblock_position;    // Frames in the current sub-block
+    double subblock_sum;        // Its weighted sum of squares
+    double subblocks[BLOCK_SUBBLOCKS];  // Mean squares of the last sub-blocks
+    guint64 subblock_count;
+    
+    // Everything, for sounds shorter than one block
+    double total_sum;
+    guint64 total_frames;
+    
+    guint64 bin_count[HISTOGRAM_BINS];
+    double bin_energy[HISTOGRAM_BINS];
+};
+
+static void design_filters(LoudnessMeter *meter, unsigned int rate);
+static double filter(const Biquad *biquad, double *z, double x);
+static void finish_subblock(LoudnessMeter *meter);
+static void add_block(LoudnessMeter *meter, double energy);
+static double energy_to_lufs(double energy);
+
+LoudnessMeter* loudness_meter_new(unsigned int rate, int channels) {
+    if (rate == 0 || channels <= 0) return NULL;
+    
+    LoudnessMeter *meter = g_malloc0(sizeof(LoudnessMeter));
+    meter->channels = channels;
+    meter->state = g_malloc0(channels * 4 * sizeof(double));
+    meter->weights = g_malloc(channels * sizeof(double));
+    meter->subblock_frames = MAX((gsize)rate * SUBBLOCK_MS / 1000, 1);
+    design_filters(meter, rate);
+    
+    // Surround channels count 1.5 dB more, the LFE not at all
+    for (int c = 0; c < channels; c++) {
+        meter->weights[c] = 1.0;
+        if ((channels == 5 && c >= 3) || (channels == 6 && c >= 4)) meter->weights[c] = 1.41;
+    }
+    if (channels == 6) meter->weights[3] = 0.0;
+    
+    return meter;
+}
+
+void loudness_meter_free(LoudnessMeter *meter) {
+    if (!meter) return;
+    
+    g_free(meter->state);
+    g_free(meter->weights);
+    g_free(meter);
+}
+
+void loudness_meter_add(LoudnessMeter *meter, const float *samples, gsize frames) {
+    if (!meter || !samples) return;
+    
+    int channels = meter->channels;
+    float peak = meter->peak;
+    
+    for (gsize i = 0; i < frames; i++) {
+        double sum = 0.0;
+        
+        for (int c = 0; c < channels; c++) {
+            float x = samples[i * channels + c];
+            peak = MAX(peak, fabsf(x));
+            
+            double *z = meter->state + c * 4;
+            double y = filter(&meter->highpass, z + 2, filter(&meter->shelf, z, x));
+            sum += meter->weights[c] * y * y;
+        }
+        
+        meter->subblock_sum += sum;
+        if (++meter->subblock_position == meter->subblock_frames) finish_subblock(meter);
+    }
+    
+    meter->peak = peak;
+}
+
+double loudness_meter_get_integrated(LoudnessMeter *meter) {
+    if (!meter) return -INFINITY;
+    
+    guint64 count = 0;
+    double energy = 0.0;
+    for (int b = 0; b < HISTOGRAM_BINS; b++) {
+        count += meter->bin_count[b];
+        energy += meter->bin_energy[b];
+    }
+    
+    // No complete block: the whole sound is the block
+    if (count == 0) {
+        guint64 frames = meter->total_frames + meter->subblock_position;
+        if (frames == 0) return -INFINITY;
+        
+        double loudness = energy_to_lufs((meter->total_sum + meter->subblock_sum) / frames);
+        return loudness > ABSOLUTE_GATE_LUFS ? loudness : -INFINITY;
+    }
+    
+    // Drop the blocks more than 10 LU below the level of all gated blocks
+    double threshold = energy_to_lufs(energy / count) + RELATIVE_GATE_LU;
+    count = 0;
+    energy = 0.0;
+    for (int b = 0; b < HISTOGRAM_BINS; b++) {
+        if (!meter->bin_count[b]) continue;
+        if (energy_to_lufs(meter->bin_energy[b] / meter->bin_count[b]) <= threshold) continue;
+        count += meter->bin_count[b];
+        energy += meter->bin_energy[b];
+    }
+    
+    return count ? energy_to_lufs(energy / count) : -INFINITY;
+}
+
+float loudness_meter_get_peak(LoudnessMeter *meter) {
+    return meter ? meter->peak : 0.0f;
+}
+
+static void design_filters(LoudnessMeter *meter, unsigned int rate) {
+    // BS.1770 gives the coefficients at 48 kHz; these are the analog
+    // prototypes they come from, bilinear-transformed for any rate
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    
+    double k = tan(G_PI * f0 / rate);
+    double vh = pow(10.0, gain_db / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    
+    meter->shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    meter->shelf.b1 = 2.0 * (k * k - vh) / a0;
+    meter->shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    meter->shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    meter->shelf.a2 = (1.0 - k / q + k * k) / a0;
+    
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(G_PI * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    
+    meter->highpass.b0 = 1.0;
+    meter->highpass.b1 = -2.0;
+    meter->highpass.b2 = 1.0;
+    meter->highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+    meter->highpass.a2 = (1.0 - k / q + k * k) / a0;
+}
+
+// Transposed direct form II
+static double filter(const Biquad *biquad, double *z, double x) {
+    double y = biquad->b0 * x + z[0];
+    z[0] = biquad->b1 * x - biquad->a1 * y + z[1];
+    z[1] = biquad->b2 * x - biquad->a2 * y;
+    return y;
+}
+
+static void finish_subblock(LoudnessMeter *meter) {
+    meter->subblocks[meter->subblock_count % BLOCK_SUBBLOCKS] = meter->subblock_sum / meter->subblock_frames;
+    meter->subblock_count++;
+    meter->total_sum += meter->subblock_sum;
+    meter->total_frames += meter->subblock_frames;
+    meter->subblock_sum = 0.0;
+    meter->subblock_position = 0;
+    
+    if (meter->subblock_count >= BLOCK_SUBBLOCKS) {
+        double energy = 0.0;
+        for (int i = 0; i < BLOCK_SUBBLOCKS; i++) energy += meter->subblocks[i];
+        add_block(meter, energy / BLOCK_SUBBLOCKS);
+    }
+    
+    for (int i = 0; i < meter->channels * 4; i++) {
+        if (fabs(meter->state[i]) < STATE_FLUSH) meter->state[i] = 0.0;
+    }
+}
+
+static void add_block(LoudnessMeter *meter, double energy) {
+    double loudness = energy_to_lufs(energy);
+    if (loudness <= ABSOLUTE_GATE_LUFS) return;
+    
+    int bin = (int)((loudness - ABSOLUTE_GATE_LUFS) * HISTOGRAM_BINS_PER_LU);
+    bin = CLAMP(bin, 0, HISTOGRAM_BINS - 1);
+    meter->bin_count[bin]++;
+    meter->bin_energy[bin] += energy;
+}
+
+static double energy_to_lufs(double energy) {
+    return energy > 0.0 ? -0.691 + 10.0 * log10(energy) : -INFINITY;
+}
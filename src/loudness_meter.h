@@ -0,0 +1,54 @@
+#ifndef LOUDNESS_METER_H
+#define LOUDNESS_METER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _LoudnessMeter LoudnessMeter;
+
+/**
+ * Creates an integrated loudness meter after ITU-R BS.1770 / EBU R128:
+ * K-weighting, 400 ms blocks every 100 ms, an absolute gate at -70 LUFS
+ * and a relative gate 10 LU below the ungated level. Blocks are kept in a
+ * fixed-size histogram, so memory use doesn't depend on the length of the
+ * sound.
+ * @param rate Sample rate in Hz
+ * @param channels Number of interleaved channels (5 and 6 are read as
+ *                 L R C Ls Rs and L R C LFE Ls Rs)
+ * @return New LoudnessMeter instance
+ */
+LoudnessMeter* loudness_meter_new(unsigned int rate, int channels);
+
+/**
+ * Frees a meter
+ * @param meter LoudnessMeter instance to free
+ */
+void loudness_meter_free(LoudnessMeter *meter);
+
+/**
+ * Measures the next frames
+ * @param meter LoudnessMeter instance
+ * @param samples Interleaved floats in [-1, 1)
+ * @param frames Number of frames
+ */
+void loudness_meter_add(LoudnessMeter *meter, const float *samples, gsize frames);
+
+/**
+ * Gets the integrated loudness of everything added so far. A sound
+ * shorter than one block is measured as a single block.
+ * @param meter LoudnessMeter instance
+ * @return Loudness in LUFS, -INFINITY for silence
+ */
+double loudness_meter_get_integrated(LoudnessMeter *meter);
+
+/**
+ * Gets the highest absolute sample value added so far
+ * @param meter LoudnessMeter instance
+ * @return Sample peak, 1.0 is full scale
+ */
+float loudness_meter_get_peak(LoudnessMeter *meter);
+
+G_END_DECLS
+
+#endif // LOUDNESS_METER_H
@@ -12,12 +12,14 @@
 #include "app.h"
 #include "callbacks.h"
 #include "dbus.h"
+#include "duration.h"
 
 
 static void on_settings_clicked(GtkButton *button, GomodaroApp *app);
 static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user_data);
 static void on_timer_tick(Timer *timer, int minutes, int seconds, gpointer user_data);
 static void on_timer_session_complete(Timer *timer, TimerState completed_state, gpointer user_data);
+static void on_timer_catch_up(Timer *timer, const TimerState *completed_states, int n_completed, gpointer user_data);
 static void update_display(GomodaroApp *app);
 static gboolean on_key_pressed(GtkWidget *widget, GdkEventKey *event, gpointer user_data);
 static void on_tray_status_action(const char *action, gpointer user_data);
@@ -37,40 +39,18 @@ static gboolean delayed_window_present(gpointer user_data);
 static gboolean check_idle_timeout(gpointer user_data);
 static void start_idle_monitoring(GomodaroApp *app);
 static void stop_idle_monitoring(GomodaroApp *app);
+static void update_tick_subscriptions(GomodaroApp *app);
+static void on_window_visibility_changed(GtkWidget *widget, gpointer user_data);
+static void apply_timer_settings(GomodaroApp *app, Timer *timer);
+static void on_named_timer_session_complete(Timer *timer, TimerState completed_state, gpointer user_data);
+static void on_tray_named_timer_clicked(GtkMenuItem *item, gpointer user_data);
 
-// Command line argument parsing
-static int parse_duration_to_seconds(const char *duration_str) {
-    if (!duration_str) return 0;
-    
-    int len = strlen(duration_str);
-    if (len == 0) return 0;
-    
-    char *endptr;
-    int value = strtol(duration_str, &endptr, 10);
-    
-    if (endptr == duration_str) {
-        // No digits found
-        return 0;
-    }
-    
-    // Check for time unit suffix
-    if (*endptr == 's') {
-        // Seconds
-        return value;
-    } else if (*endptr == 'm') {
-        // Minutes
-        return value * 60;
-    } else if (*endptr == 'h') {
-        // Hours
-        return value * 3600;
-    } else if (*endptr == '\0') {
-        // No suffix, assume minutes
-        return value * 60;
-    }
-    
-    return 0; // Invalid format
-}
+static const char* get_status_text(TimerState state);
+static void update_tray(GomodaroApp *app);
+static void schedule_tray_redraw(GomodaroApp *app);
+static gboolean on_tray_redraw(gpointer user_data);
 
+// Command line argument parsing
 static int seconds_to_duration_units(int seconds) {
     // Return duration in the units expected by timer (minutes for normal, seconds for test)
     return seconds; // Store actual seconds, timer will handle conversion
@@ -173,11 +153,14 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Create audio manager
     app->audio = audio_manager_new();
     
-    // Create timer with default durations
-    app->timer = timer_new();
+    // Create the main timer; further named timers can be added over D-Bus
+    // and are all scheduled from the group's shared timing wheel
+    app->timers = timer_group_new();
+    app->timer = timer_group_add(app->timers, APP_MAIN_TIMER_NAME);
     timer_set_durations(app->timer, app->settings->work_duration, app->settings->short_break_duration, 
                        app->settings->long_break_duration, app->settings->sessions_until_long_break);
     timer_set_callbacks(app->timer, on_timer_state_changed, on_timer_tick, on_timer_session_complete, app);
+    timer_set_catch_up_callback(app->timer, on_timer_catch_up, app);
     
     // Set timer mode based on test mode
     if (cmd_args && cmd_args->test_mode) {
@@ -187,6 +170,18 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Apply initial settings
     apply_settings(app);
     
+    // Pick up a pomodoro interrupted by a crash or session restart. This runs
+    // before any widget exists; the UI catches up once the window is built.
+    gboolean restored = FALSE;
+    if (!(cmd_args && cmd_args->test_mode)) {
+        app->snapshot = timer_snapshot_open(NULL);
+        gint64 restore_start = g_get_monotonic_time();
+        restored = timer_snapshot_restore(app->snapshot, app->timer);
+        if (restored) {
+            g_print("Restored timer snapshot in %" G_GINT64_FORMAT " us\n", g_get_monotonic_time() - restore_start);
+        }
+    }
+    
     // Create tray icon
     app->tray_icon = tray_icon_new();
     tray_icon_set_tooltip(app->tray_icon, "Commodoro - Ready to start");
@@ -194,6 +189,12 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Create status tray
     app->status_tray = tray_status_icon_new();
     tray_status_icon_set_callback(app->status_tray, on_tray_status_action, app);
+    tray_status_icon_update(app->status_tray, tray_icon_get_surface(app->tray_icon), "Commodoro - Ready to start");
+    
+    // StatusNotifierItem tray; exported once the D-Bus service has the bus
+    app->status_notifier = status_notifier_new();
+    status_notifier_set_callback(app->status_notifier, on_tray_status_action, app);
+    status_notifier_update(app->status_notifier, tray_icon_get_surface(app->tray_icon), "Commodoro - Ready to start");
     
     // Create break overlay
     app->break_overlay = break_overlay_new();
@@ -294,6 +295,10 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Connect delete-event signal to hide window instead of destroying it
     g_signal_connect(app->window, "delete-event", G_CALLBACK(on_window_delete_event), app);
     
+    // Only ask the timer for per-second ticks while the window is shown
+    g_signal_connect(app->window, "show", G_CALLBACK(on_window_visibility_changed), app);
+    g_signal_connect(app->window, "hide", G_CALLBACK(on_window_visibility_changed), app);
+    
     // Load CSS
     GtkCssProvider *css_provider = gtk_css_provider_new();
     gtk_css_provider_load_from_data(css_provider,
@@ -338,6 +343,13 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Initial display update
     update_display(app);
     
+    // Bring buttons, overlay and monitors in line with a restored phase
+    if (restored && timer_get_state(app->timer) != TIMER_STATE_IDLE) {
+        app->restoring = TRUE;
+        on_timer_state_changed(app->timer, timer_get_state(app->timer), app);
+        app->restoring = FALSE;
+    }
+    
     // Check if we should execute a startup command
     const char *startup_cmd = g_getenv("COMMODORO_STARTUP_CMD");
     if (startup_cmd) {
@@ -383,9 +395,12 @@ static void on_settings_clicked(GtkButton *button, GomodaroApp *app) {
 }
 
 static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user_data) {
-    (void)timer; // Suppress unused parameter warning
     GomodaroApp *app = (GomodaroApp *)user_data;
     
+    // After a resume the catch-up callback already played one sound for the
+    // whole batch of skipped phases; a restored phase isn't a new one
+    gboolean quiet = timer_is_catching_up(timer) || app->restoring;
+    
     switch (state) {
         case TIMER_STATE_IDLE:
             gtk_button_set_label(GTK_BUTTON(app->start_button), "Start");
@@ -414,7 +429,7 @@ static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user
             gtk_widget_set_sensitive(app->start_button, TRUE);
             gtk_widget_set_sensitive(app->reset_button, TRUE);
             // Play work start sound
-            audio_manager_play_work_start(app->audio);
+            if (!quiet) audio_manager_play_work_start(app->audio);
             // Hide break overlay during work
             break_overlay_hide(app->break_overlay);
             // Stop input monitoring when work starts
@@ -428,7 +443,7 @@ static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user
             gtk_widget_set_sensitive(app->start_button, TRUE);
             gtk_widget_set_sensitive(app->reset_button, TRUE);
             // Play break start sound
-            audio_manager_play_break_start(app->audio);
+            if (!quiet) audio_manager_play_break_start(app->audio);
             // Show break overlay
             int minutes, seconds;
             timer_get_remaining(app->timer, &minutes, &seconds);
@@ -442,7 +457,7 @@ static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user
             gtk_widget_set_sensitive(app->start_button, TRUE);
             gtk_widget_set_sensitive(app->reset_button, TRUE);
             // Play long break start sound
-            audio_manager_play_long_break_start(app->audio);
+            if (!quiet) audio_manager_play_long_break_start(app->audio);
             // Show break overlay
             timer_get_remaining(app->timer, &minutes, &seconds);
             break_overlay_show(app->break_overlay, "Long Break", minutes, seconds);
@@ -461,6 +476,12 @@ static void on_timer_state_changed(Timer *timer, TimerState state, gpointer user
             break;
     }
     
+    // Focus noise plays for exactly the work phases, paused ones excluded
+    audio_manager_set_ambient_playing(app->audio, state == TIMER_STATE_WORK);
+    
+    // Persist on transitions only; ticks don't change anything restorable
+    timer_snapshot_save(app->snapshot, timer);
+    
     update_display(app);
 }
 
@@ -499,10 +520,20 @@ static void on_timer_session_complete(Timer *timer, TimerState completed_state,
     }
 }
 
+static void on_timer_catch_up(Timer *timer, const TimerState *completed_states, int n_completed, gpointer user_data) {
+    GomodaroApp *app = (GomodaroApp *)user_data;
+    
+    if (n_completed <= 0) return;
+    
+    g_print("Resumed after suspend: %d phase(s) completed while asleep\n", n_completed);
+    
+    // One chime for the whole batch, based on the most recent completion
+    on_timer_session_complete(timer, completed_states[n_completed - 1], app);
+}
+
 static void update_display(GomodaroApp *app) {
     char time_text[16];
     char session_text[32];
-    char tooltip_text[64];
     
     // Get current timer state
     TimerState state = timer_get_state(app->timer);
@@ -519,43 +550,121 @@ static void update_display(GomodaroApp *app) {
     gtk_label_set_text(GTK_LABEL(app->session_label), session_text);
     
     // Update status display
-    const char *status;
+    gtk_label_set_text(GTK_LABEL(app->status_label), get_status_text(state));
+    
+    update_tray(app);
+    
+    // The break overlay may have been shown or hidden by a state change
+    update_tick_subscriptions(app);
+}
+
+static const char* get_status_text(TimerState state) {
     switch (state) {
-        case TIMER_STATE_IDLE:
-            status = "Ready to start";
-            break;
-        case TIMER_STATE_WORK:
-            status = "Work Session";
-            break;
-        case TIMER_STATE_SHORT_BREAK:
-            status = "Short Break";
-            break;
-        case TIMER_STATE_LONG_BREAK:
-            status = "Long Break";
-            break;
-        case TIMER_STATE_PAUSED:
-            status = "Paused";
-            break;
-        default:
-            status = "Unknown";
-            break;
+        case TIMER_STATE_IDLE: return "Ready to start";
+        case TIMER_STATE_WORK: return "Work Session";
+        case TIMER_STATE_SHORT_BREAK: return "Short Break";
+        case TIMER_STATE_LONG_BREAK: return "Long Break";
+        case TIMER_STATE_PAUSED: return "Paused";
+        default: return "Unknown";
     }
-    gtk_label_set_text(GTK_LABEL(app->status_label), status);
+}
+
+static void update_tray(GomodaroApp *app) {
+    char tooltip_text[64];
     
     // Update tray icon with state, time, and progress
+    TimerState state = timer_get_state(app->timer);
+    int minutes, seconds;
+    timer_get_remaining(app->timer, &minutes, &seconds);
     int total_seconds = timer_get_total_duration(app->timer);
     int current_seconds = minutes * 60 + seconds;
     
-    tray_icon_update(app->tray_icon, state, current_seconds, total_seconds);
+    gboolean icon_changed = tray_icon_update(app->tray_icon, state, current_seconds, total_seconds);
     
     g_snprintf(tooltip_text, sizeof(tooltip_text), "Commodoro - %s (%02d:%02d remaining)", 
-               status, minutes, seconds);
+               get_status_text(state), minutes, seconds);
     tray_icon_set_tooltip(app->tray_icon, tooltip_text);
     
-    // Update status tray
+    // Update both trays; the pixel conversion is skipped when the cached
+    // frame didn't change
     cairo_surface_t *surface = tray_icon_get_surface(app->tray_icon);
     if (surface) {
-        tray_status_icon_update(app->status_tray, surface, tooltip_text);
+        tray_status_icon_update(app->status_tray, icon_changed ? surface : NULL, tooltip_text);
+        status_notifier_update(app->status_notifier, icon_changed ? surface : NULL, tooltip_text);
+    }
+    
+    schedule_tray_redraw(app);
+}
+
+// Arms a one-shot redraw for the moment the tray icon will next look
+// different, independent of the timer's ticks. Between those moments
+// nothing about the icon changes, so nothing wakes up for it.
+static void schedule_tray_redraw(GomodaroApp *app) {
+    int seconds_ahead = tray_icon_get_seconds_until_change(app->tray_icon);
+    
+    if (seconds_ahead < 0) {
+        if (app->tray_redraw_source) {
+            g_source_remove(app->tray_redraw_source);
+            app->tray_redraw_source = 0;
+        }
+        return;
+    }
+    
+    // The icon was just drawn for the current whole remaining second; the
+    // change happens when the countdown reaches seconds_ahead fewer
+    int minutes, seconds;
+    timer_get_remaining(app->timer, &minutes, &seconds);
+    gint64 target_remaining_ms = (gint64)(minutes * 60 + seconds - seconds_ahead) * 1000;
+    gint64 delay_ms = MAX(timer_get_remaining_ms(app->timer) - target_remaining_ms, 1);
+    gint64 due_ms = g_get_monotonic_time() / 1000 + delay_ms;
+    
+    // Per-second ticks (window shown) land here too; keep an equivalent timeout
+    if (app->tray_redraw_source) {
+        if (ABS(due_ms - app->tray_redraw_due_ms) <= 1) return;
+        g_source_remove(app->tray_redraw_source);
+    }
+    
+    app->tray_redraw_due_ms = due_ms;
+    app->tray_redraw_source = g_timeout_add((guint)delay_ms, on_tray_redraw, app);
+}
+
+static gboolean on_tray_redraw(gpointer user_data) {
+    GomodaroApp *app = (GomodaroApp *)user_data;
+    
+    app->tray_redraw_source = 0;
+    update_tray(app);
+    return G_SOURCE_REMOVE;
+}
+
+static void update_tick_subscriptions(GomodaroApp *app) {
+    if (!app->window || !app->break_overlay) return;
+    
+    gboolean window_visible = gtk_widget_get_visible(app->window);
+    if (window_visible && app->window_tick_subscription == 0) {
+        app->window_tick_subscription = timer_subscribe_resolution(app->timer, 1);
+    } else if (!window_visible && app->window_tick_subscription > 0) {
+        timer_unsubscribe_resolution(app->timer, app->window_tick_subscription);
+        app->window_tick_subscription = 0;
+    }
+    
+    gboolean overlay_visible = break_overlay_is_visible(app->break_overlay);
+    if (overlay_visible && app->overlay_tick_subscription == 0) {
+        app->overlay_tick_subscription = timer_subscribe_resolution(app->timer, 1);
+    } else if (!overlay_visible && app->overlay_tick_subscription > 0) {
+        timer_unsubscribe_resolution(app->timer, app->overlay_tick_subscription);
+        app->overlay_tick_subscription = 0;
+    }
+}
+
+static void on_window_visibility_changed(GtkWidget *widget, gpointer user_data) {
+    (void)widget; // Suppress unused parameter warning
+    GomodaroApp *app = (GomodaroApp *)user_data;
+    
+    // Labels may be stale after running on coarse ticks while hidden
+    if (gtk_widget_get_visible(app->window)) {
+        update_display(app);
+    } else {
+        update_tick_subscriptions(app);
     }
 }
 
@@ -591,6 +700,24 @@ static void on_tray_status_action(const char *action, gpointer user_data) {
             gtk_window_present(GTK_WINDOW(app->window));
             gtk_window_set_urgency_hint(GTK_WINDOW(app->window), TRUE);
         }
+    } else if (g_strcmp0(action, "registered") == 0) {
+        // A StatusNotifierItem host shows the icon; avoid a second one via XEmbed.
+        // Hosts don't report their size, so give them the default to scale.
+        tray_status_icon_set_visible(app->status_tray, FALSE);
+        if (tray_icon_set_size(app->tray_icon, TRAY_ICON_DEFAULT_SIZE)) {
+            status_notifier_update(app->status_notifier, tray_icon_get_surface(app->tray_icon), NULL);
+        }
+    } else if (g_strcmp0(action, "unregistered") == 0) {
+        tray_status_icon_set_visible(app->status_tray, TRUE);
+        if (tray_icon_set_size(app->tray_icon, tray_status_icon_get_pixel_size(app->status_tray))) {
+            tray_status_icon_update(app->status_tray, tray_icon_get_surface(app->tray_icon), NULL);
+        }
+    } else if (g_strcmp0(action, "size-changed") == 0) {
+        // Render at the tray's own size rather than having it rescale 64 px
+        if (!status_notifier_is_registered(app->status_notifier) &&
+            tray_icon_set_size(app->tray_icon, tray_status_icon_get_pixel_size(app->status_tray))) {
+            tray_status_icon_update(app->status_tray, tray_icon_get_surface(app->tray_icon), NULL);
+        }
     } else if (g_strcmp0(action, "popup-menu") == 0) {
         // Right-click - show context menu
         GtkWidget *menu = gtk_menu_new();
@@ -620,6 +747,40 @@ static void on_tray_status_action(const char *action, gpointer user_data) {
                         G_CALLBACK(on_tray_reset_clicked), app);
         gtk_menu_shell_append(GTK_MENU_SHELL(menu), reset_item);
         
+        // Named timers (besides the main one), each toggled by clicking
+        if (timer_group_get_count(app->timers) > 1) {
+            GtkWidget *timers_item = gtk_menu_item_new_with_label("Timers");
+            GtkWidget *timers_menu = gtk_menu_new();
+            
+            for (guint i = 0; i < timer_group_get_count(app->timers); i++) {
+                Timer *named = timer_group_get_timer(app->timers, i);
+                const char *name = timer_group_get_name(app->timers, i);
+                if (named == app->timer) continue;
+                
+                int minutes, seconds;
+                timer_get_remaining(named, &minutes, &seconds);
+                const char *status;
+                switch (timer_get_state(named)) {
+                    case TIMER_STATE_WORK: status = "Work"; break;
+                    case TIMER_STATE_SHORT_BREAK:
+                    case TIMER_STATE_LONG_BREAK: status = "Break"; break;
+                    case TIMER_STATE_PAUSED: status = "Paused"; break;
+                    default: status = "Idle"; break;
+                }
+                
+                char *label = g_strdup_printf("%s  %02d:%02d  %s", name, minutes, seconds, status);
+                GtkWidget *named_item = gtk_menu_item_new_with_label(label);
+                g_free(label);
+                g_object_set_data_full(G_OBJECT(named_item), "timer-name", g_strdup(name), g_free);
+                g_signal_connect(named_item, "activate",
+                                G_CALLBACK(on_tray_named_timer_clicked), app);
+                gtk_menu_shell_append(GTK_MENU_SHELL(timers_menu), named_item);
+            }
+            
+            gtk_menu_item_set_submenu(GTK_MENU_ITEM(timers_item), timers_menu);
+            gtk_menu_shell_append(GTK_MENU_SHELL(menu), timers_item);
+        }
+        
         // Separator
         GtkWidget *separator1 = gtk_separator_menu_item_new();
         gtk_menu_shell_append(GTK_MENU_SHELL(menu), separator1);
@@ -671,9 +832,12 @@ static void on_settings_dialog_action(const char *action, gpointer user_data) {
         // Save settings (config manager handles in-memory vs persistent)
         config_save_settings(app->config, app->settings);
         
-        // Update timer with new durations
-        timer_set_durations(app->timer, app->settings->work_duration, app->settings->short_break_duration,
-                           app->settings->long_break_duration, app->settings->sessions_until_long_break);
+        // Update all timers with new durations
+        for (guint i = 0; i < timer_group_get_count(app->timers); i++) {
+            timer_set_durations(timer_group_get_timer(app->timers, i), app->settings->work_duration,
+                               app->settings->short_break_duration, app->settings->long_break_duration,
+                               app->settings->sessions_until_long_break);
+        }
         
         // Apply audio and other settings
         apply_settings(app);
@@ -694,8 +858,20 @@ static void apply_settings(GomodaroApp *app) {
     audio_manager_set_enabled(app->audio, app->settings->enable_sounds);
     audio_manager_set_volume(app->audio, app->settings->sound_volume);
     
+    // Custom sound files replace the matching chimes; a long break uses the
+    // break sound
+    gboolean custom = g_strcmp0(app->settings->sound_type, "custom") == 0;
+    audio_manager_set_custom_sound(app->audio, "work_start", custom ? app->settings->work_start_sound : NULL);
+    audio_manager_set_custom_sound(app->audio, "break_start", custom ? app->settings->break_start_sound : NULL);
+    audio_manager_set_custom_sound(app->audio, "long_break_start", custom ? app->settings->break_start_sound : NULL);
+    audio_manager_set_custom_sound(app->audio, "session_complete", custom ? app->settings->session_complete_sound : NULL);
+    audio_manager_set_custom_sound(app->audio, "timer_finish", custom ? app->settings->timer_finish_sound : NULL);
+    audio_manager_set_ambient_noise(app->audio, app->settings->ambient_noise);
+    
     // Apply timer settings
-    timer_set_auto_start_work(app->timer, app->settings->auto_start_work_after_break);
+    for (guint i = 0; i < timer_group_get_count(app->timers); i++) {
+        timer_set_auto_start_work(timer_group_get_timer(app->timers, i), app->settings->auto_start_work_after_break);
+    }
     
     // Update auto-start checkbox to match settings
     if (app->auto_start_check && GTK_IS_TOGGLE_BUTTON(app->auto_start_check)) {
@@ -714,6 +890,7 @@ static void on_break_overlay_action(const char *action, gpointer user_data) {
     } else if (g_strcmp0(action, "extend_break") == 0) {
         // Add 5 minutes (300 seconds) to the current break
         timer_extend_break(app->timer, 300);
+        timer_snapshot_save(app->snapshot, app->timer);
     } else if (g_strcmp0(action, "pause") == 0) {
         TimerState current_state = timer_get_state(app->timer);
         
@@ -732,6 +909,8 @@ static void on_break_overlay_action(const char *action, gpointer user_data) {
         // Just hide the overlay (ESC key)
         break_overlay_hide(app->break_overlay);
     }
+    
+    update_tick_subscriptions(app);
 }
 
 static void on_auto_start_toggled(GtkToggleButton *button, gpointer user_data) {
@@ -763,10 +942,32 @@ static void cleanup_app(GomodaroApp *app) {
     }
     
     // Clean up resources
-    if (app->timer) timer_free(app->timer);
-    if (app->audio) audio_manager_free(app->audio);
-    if (app->tray_icon) tray_icon_free(app->tray_icon);
+    if (app->tray_redraw_source) g_source_remove(app->tray_redraw_source);
+    if (app->snapshot) timer_snapshot_close(app->snapshot);
+    if (app->timers) timer_group_free(app->timers);
+    if (app->audio) {
+        AudioLatencyStats latency;
+        audio_manager_get_latency_stats(app->audio, &latency);
+        if (latency.plays > 0) {
+            g_print("Audio first-sample latency: %u plays, avg %.1f ms, min %.1f ms, max %.1f ms, %u dropped, %u cut off\n",
+                    latency.plays, latency.total_us / 1000.0 / latency.plays,
+                    latency.min_us / 1000.0, latency.max_us / 1000.0, latency.dropped, latency.stolen);
+        }
+        AudioRequestStats requests;
+        audio_manager_get_request_stats(app->audio, &requests);
+        g_print("Audio requests: %u played, %u merged, %u dropped; work queue: %u jobs, max %u of %u waiting, %u coalesced, %u dropped\n",
+                requests.plays, requests.plays_coalesced, requests.plays_dropped, requests.work.submitted,
+                requests.work.max_depth, requests.work.capacity, requests.work.coalesced, requests.work.dropped);
+        audio_manager_free(app->audio);
+    }
+    if (app->tray_icon) {
+        guint hits, misses;
+        tray_icon_get_cache_stats(app->tray_icon, &hits, &misses);
+        g_print("Tray frame cache: %u hits, %u misses\n", hits, misses);
+        tray_icon_free(app->tray_icon);
+    }
     if (app->status_tray) tray_status_icon_free(app->status_tray);
+    if (app->status_notifier) status_notifier_free(app->status_notifier);
     if (app->break_overlay) break_overlay_free(app->break_overlay);
     if (app->input_monitor) input_monitor_free(app->input_monitor);
     if (app->dbus_service) dbus_service_free(app->dbus_service);
@@ -789,6 +990,9 @@ static gboolean on_window_delete_event(GtkWidget *widget, GdkEvent *event, gpoin
 }
 
 static void quit_application(GomodaroApp *app) {
+    // An explicit quit ends the pomodoro; only crashes and kills resume it
+    timer_snapshot_discard(app->snapshot);
+    
     // Cleanup and quit the application
     cleanup_app(app);
     gtk_main_quit();
@@ -847,6 +1051,69 @@ static void on_tray_reset_clicked(GtkMenuItem *item, gpointer user_data) {
     timer_reset(app->timer);
 }
 
+static void on_tray_named_timer_clicked(GtkMenuItem *item, gpointer user_data) {
+    GomodaroApp *app = (GomodaroApp *)user_data;
+    
+    // Looked up by name, so a timer removed while the menu was open is ignored
+    app_toggle_named_timer(app, g_object_get_data(G_OBJECT(item), "timer-name"));
+}
+
+static void apply_timer_settings(GomodaroApp *app, Timer *timer) {
+    timer_set_durations(timer, app->settings->work_duration, app->settings->short_break_duration,
+                       app->settings->long_break_duration, app->settings->sessions_until_long_break);
+    timer_set_auto_start_work(timer, app->settings->auto_start_work_after_break);
+    
+    if (app->args && app->args->test_mode) {
+        timer_set_duration_mode(timer, TRUE);
+    }
+}
+
+static void on_named_timer_session_complete(Timer *timer, TimerState completed_state, gpointer user_data) {
+    (void)timer; // Suppress unused parameter warning
+    GomodaroApp *app = (GomodaroApp *)user_data;
+    
+    // Catch-up after suspend reports only the last phase, so this fires once
+    if (completed_state == TIMER_STATE_WORK) {
+        audio_manager_play_session_complete(app->audio);
+    } else {
+        audio_manager_play_timer_finish(app->audio);
+    }
+}
+
+Timer* app_add_named_timer(GomodaroApp *app, const char *name) {
+    Timer *timer = timer_group_add(app->timers, name);
+    if (!timer) return NULL;
+    
+    apply_timer_settings(app, timer);
+    timer_set_callbacks(timer, NULL, NULL, on_named_timer_session_complete, app);
+    return timer;
+}
+
+gboolean app_remove_named_timer(GomodaroApp *app, const char *name) {
+    // The main timer is wired into the window, tray and overlay
+    if (g_strcmp0(name, APP_MAIN_TIMER_NAME) == 0) return FALSE;
+    
+    return timer_group_remove(app->timers, name);
+}
+
+gboolean app_toggle_named_timer(GomodaroApp *app, const char *name) {
+    Timer *timer = timer_group_lookup(app->timers, name);
+    if (!timer) return FALSE;
+    
+    if (timer == app->timer) {
+        on_start_clicked(NULL, app);
+        return TRUE;
+    }
+    
+    TimerState state = timer_get_state(timer);
+    if (state == TIMER_STATE_IDLE || state == TIMER_STATE_PAUSED) {
+        timer_start(timer);
+    } else {
+        timer_pause(timer);
+    }
+    return TRUE;
+}
+
 static gboolean on_input_activity_detected(gpointer user_data) {
     GomodaroApp *app = (GomodaroApp *)user_data;
     
@@ -941,6 +1208,7 @@ static gboolean check_idle_timeout(gpointer user_data) {
         cairo_surface_t *surface = tray_icon_get_surface(app->tray_icon);
         if (surface) {
             tray_status_icon_update(app->status_tray, surface, "Commodoro - Paused (idle)");
+            status_notifier_update(app->status_notifier, surface, "Commodoro - Paused (idle)");
         }
     }
     
@@ -0,0 +1,143 @@
+#include "pixel_convert.h"
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Straight alpha from premultiplied: c * 255 / a, rounded. Done in single
+// precision so the scalar and SSE2 paths agree bit for bit.
+static inline guint8 unpremultiply(guint32 c, float scale) {
+    guint32 v = (guint32)((float)c * scale + 0.5f);
+    return v > 255 ? 255 : (guint8)v;
+}
+
+// Output byte order of a converted pixel
+typedef enum {
+    ORDER_RGBA,
+    ORDER_ARGB
+} PixelOrder;
+
+static void convert_row_scalar(const guint32 *src, guint8 *dst, int width, PixelOrder order) {
+    for (int x = 0; x < width; x++) {
+        guint32 p = src[x];
+        guint32 a = p >> 24;
+        float scale = a ? 255.0f / (float)a : 0.0f;
+        guint8 r = unpremultiply((p >> 16) & 0xff, scale);
+        guint8 g = unpremultiply((p >> 8) & 0xff, scale);
+        guint8 b = unpremultiply(p & 0xff, scale);
+        
+        if (order == ORDER_RGBA) {
+            dst[0] = r; dst[1] = g; dst[2] = b; dst[3] = (guint8)a;
+        } else {
+            dst[0] = (guint8)a; dst[1] = r; dst[2] = g; dst[3] = b;
+        }
+        dst += 4;
+    }
+}
+
+#ifdef __SSE2__
+// Four pixels per iteration: split channels into 32-bit lanes, scale in
+// float, then saturate-pack and interleave back into the requested byte order.
+static void convert_row_sse2(const guint32 *src, guint8 *dst, int width, PixelOrder order) {
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128 full = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero_ps = _mm_setzero_ps();
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    
+    for (; x + 4 <= width; x += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i*)(src + x));
+        __m128i a = _mm_srli_epi32(px, 24);
+        __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+        __m128i b = _mm_and_si128(px, mask);
+        
+        // Fully transparent pixels get scale 0 instead of inf
+        __m128 af = _mm_cvtepi32_ps(a);
+        __m128 scale = _mm_and_ps(_mm_div_ps(full, af), _mm_cmpneq_ps(af, zero_ps));
+        
+        r = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(r), scale), half));
+        g = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(g), scale), half));
+        b = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), scale), half));
+        
+        // For output order c0 c1 c2 c3: even = c0 x4, c2 x4 and
+        // odd = c1 x4, c3 x4 (bytes, saturated)
+        __m128i even, odd;
+        if (order == ORDER_RGBA) {
+            even = _mm_packus_epi16(_mm_packs_epi32(r, b), zero);
+            odd = _mm_packus_epi16(_mm_packs_epi32(g, a), zero);
+        } else {
+            even = _mm_packus_epi16(_mm_packs_epi32(a, g), zero);
+            odd = _mm_packus_epi16(_mm_packs_epi32(r, b), zero);
+        }
+        // c0 c1 c0 c1 .. c2 c3 c2 c3 ..
+        __m128i out = _mm_unpacklo_epi8(even, odd);
+        // c0 c1 c2 c3 c0 c1 c2 c3 ..
+        out = _mm_unpacklo_epi16(out, _mm_srli_si128(out, 8));
+        _mm_storeu_si128((__m128i*)(dst + x * 4), out);
+    }
+    
+    if (x < width) {
+        convert_row_scalar(src + x, dst + x * 4, width - x, order);
+    }
+}
+#endif
+
+static void convert(const guint8 *src, int src_stride,
+                    guint8 *dst, int dst_stride,
+                    int width, int height, PixelOrder order) {
+    if (!src || !dst || width <= 0) return;
+    
+    for (int y = 0; y < height; y++) {
+        // cairo guarantees 4-byte aligned strides for ARGB32
+        const guint32 *row = (const guint32*)(const void*)(src + (gsize)y * src_stride);
+        guint8 *out = dst + (gsize)y * dst_stride;
+#ifdef __SSE2__
+        convert_row_sse2(row, out, width, order);
+#else
+        convert_row_scalar(row, out, width, order);
+#endif
+    }
+}
+
+void pixel_convert_argb32_to_rgba(const guint8 *src, int src_stride,
+                                  guint8 *dst, int dst_stride,
+                                  int width, int height) {
+    convert(src, src_stride, dst, dst_stride, width, height, ORDER_RGBA);
+}
+
+void pixel_convert_argb32_to_argb_be(const guint8 *src, int src_stride,
+                                     guint8 *dst, int dst_stride,
+                                     int width, int height) {
+    convert(src, src_stride, dst, dst_stride, width, height, ORDER_ARGB);
+}
+
+guint64 pixel_hash(const guint8 *data, int stride, int row_bytes, int height) {
+    // FNV-1a over 64-bit words with a final avalanche; only needs to tell
+    // frames apart, not resist adversaries
+    guint64 hash = G_GUINT64_CONSTANT(0xcbf29ce484222325);
+    const guint64 prime = G_GUINT64_CONSTANT(0x100000001b3);
+    
+    if (!data) return 0;
+    
+    for (int y = 0; y < height; y++) {
+        const guint8 *row = data + (gsize)y * stride;
+        int i = 0;
+        
+        for (; i + 8 <= row_bytes; i += 8) {
+            guint64 word;
+            memcpy(&word, row + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < row_bytes; i++) {
+            hash = (hash ^ row[i]) * prime;
+        }
+    }
+    
+    hash ^= hash >> 33;
+    hash *= G_GUINT64_CONSTANT(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    return hash;
+}
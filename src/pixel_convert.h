@@ -0,0 +1,49 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Converts premultiplied cairo ARGB32 pixels to straight-alpha RGBA bytes
+ * (the GdkPixbuf layout). Uses SSE2 when available, scalar code otherwise;
+ * both paths produce identical output.
+ * @param src Source pixels (CAIRO_FORMAT_ARGB32, native endian)
+ * @param src_stride Source row stride in bytes
+ * @param dst Destination pixels (8-bit RGBA)
+ * @param dst_stride Destination row stride in bytes
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+void pixel_convert_argb32_to_rgba(const guint8 *src, int src_stride,
+                                  guint8 *dst, int dst_stride,
+                                  int width, int height);
+
+/**
+ * Converts premultiplied cairo ARGB32 pixels to straight-alpha ARGB in
+ * network byte order (A,R,G,B bytes), the StatusNotifierItem pixmap layout
+ * @param src Source pixels (CAIRO_FORMAT_ARGB32, native endian)
+ * @param src_stride Source row stride in bytes
+ * @param dst Destination pixels, width * 4 bytes per row
+ * @param dst_stride Destination row stride in bytes
+ * @param width Width in pixels
+ * @param height Height in pixels
+ */
+void pixel_convert_argb32_to_argb_be(const guint8 *src, int src_stride,
+                                     guint8 *dst, int dst_stride,
+                                     int width, int height);
+
+/**
+ * Hashes a block of pixels, ignoring row padding
+ * @param data Pixel data
+ * @param stride Row stride in bytes
+ * @param row_bytes Number of meaningful bytes per row
+ * @param height Number of rows
+ * @return 64-bit content hash
+ */
+guint64 pixel_hash(const guint8 *data, int stride, int row_bytes, int height);
+
+G_END_DECLS
+
+#endif // PIXEL_CONVERT_H
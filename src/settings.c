@@ -0,0 +1,59 @@
+#include "settings.h"
+
+Settings* settings_new_default(void) {
+    Settings *settings = g_malloc0(sizeof(Settings));
+    
+    settings->work_duration = 25;
+    settings->short_break_duration = 5;
+    settings->long_break_duration = 15;
+    settings->sessions_until_long_break = 4;
+    settings->auto_start_work_after_break = TRUE;
+    settings->enable_idle_detection = FALSE;  // Off by default
+    settings->idle_timeout_minutes = 2;        // 2 minutes default
+    settings->enable_sounds = TRUE;
+    settings->sound_volume = 0.7; // Fixed reasonable volume
+    settings->sound_type = g_strdup("chimes");
+    settings->work_start_sound = NULL;
+    settings->break_start_sound = NULL;
+    settings->session_complete_sound = NULL;
+    settings->timer_finish_sound = NULL;
+    settings->ambient_noise = g_strdup("off");
+    
+    return settings;
+}
+
+void settings_free(Settings *settings) {
+    if (!settings) return;
+    
+    g_free(settings->sound_type);
+    g_free(settings->work_start_sound);
+    g_free(settings->break_start_sound);
+    g_free(settings->session_complete_sound);
+    g_free(settings->timer_finish_sound);
+    g_free(settings->ambient_noise);
+    g_free(settings);
+}
+
+Settings* settings_copy(const Settings *settings) {
+    if (!settings) return NULL;
+    
+    Settings *copy = g_malloc0(sizeof(Settings));
+    
+    copy->work_duration = settings->work_duration;
+    copy->short_break_duration = settings->short_break_duration;
+    copy->long_break_duration = settings->long_break_duration;
+    copy->sessions_until_long_break = settings->sessions_until_long_break;
+    copy->auto_start_work_after_break = settings->auto_start_work_after_break;
+    copy->enable_idle_detection = settings->enable_idle_detection;
+    copy->idle_timeout_minutes = settings->idle_timeout_minutes;
+    copy->enable_sounds = settings->enable_sounds;
+    copy->sound_volume = settings->sound_volume;
+    copy->sound_type = g_strdup(settings->sound_type);
+    copy->work_start_sound = g_strdup(settings->work_start_sound);
+    copy->break_start_sound = g_strdup(settings->break_start_sound);
+    copy->session_complete_sound = g_strdup(settings->session_complete_sound);
+    copy->timer_finish_sound = g_strdup(settings->timer_finish_sound);
+    copy->ambient_noise = g_strdup(settings->ambient_noise);
+    
+    return copy;
+}
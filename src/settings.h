@@ -0,0 +1,55 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Settings structure
+ */
+typedef struct {
+    // Timer settings
+    int work_duration;              // minutes (1-120)
+    int short_break_duration;       // minutes (1-60)
+    int long_break_duration;        // minutes (5-120)
+    int sessions_until_long_break;  // count (2-10)
+    
+    // Behavior settings
+    gboolean auto_start_work_after_break;
+    gboolean enable_idle_detection;
+    int idle_timeout_minutes;       // minutes (1-30)
+    
+    // Audio settings
+    gboolean enable_sounds;
+    double sound_volume;            // 0.0-1.0
+    char *sound_type;               // "chimes" or "custom"
+    char *work_start_sound;         // file path or NULL
+    char *break_start_sound;        // file path or NULL
+    char *session_complete_sound;   // file path or NULL
+    char *timer_finish_sound;       // file path or NULL
+    char *ambient_noise;            // "off", "white", "pink", "brown" or "tick" during work
+} Settings;
+
+/**
+ * Creates default settings
+ * @return Default Settings structure
+ */
+Settings* settings_new_default(void);
+
+/**
+ * Frees a settings structure
+ * @param settings Settings to free
+ */
+void settings_free(Settings *settings);
+
+/**
+ * Copies settings structure
+ * @param settings Settings to copy
+ * @return Copy of settings
+ */
+Settings* settings_copy(const Settings *settings);
+
+G_END_DECLS
+
+#endif // SETTINGS_H
@@ -14,6 +14,7 @@ struct _SettingsDialog {
     // Misc tab widgets
     GtkWidget *auto_start_check;
     GtkWidget *enable_sounds_check;
+    GtkWidget *ambient_noise_combo;
     GtkWidget *enable_idle_detection_check;
     GtkWidget *idle_timeout_spin;
     GtkWidget *idle_timeout_box;
@@ -23,6 +24,13 @@ struct _SettingsDialog {
     GtkWidget *cancel_button;
     GtkWidget *ok_button;
     
+    // Sound choices have no controls yet and are passed through unchanged
+    char *sound_type;
+    char *work_start_sound;
+    char *break_start_sound;
+    char *session_complete_sound;
+    char *timer_finish_sound;
+    
     SettingsDialogCallback callback;
     gpointer user_data;
 };
@@ -35,6 +43,11 @@ static void on_idle_detection_toggled(GtkToggleButton *button, SettingsDialog *d
 SettingsDialog* settings_dialog_new(GtkWindow *parent, const Settings *settings, AudioManager *audio) {
     (void)audio; // Not used in simplified version
     SettingsDialog *dialog = g_malloc0(sizeof(SettingsDialog));
+    dialog->sound_type = g_strdup(settings->sound_type);
+    dialog->work_start_sound = g_strdup(settings->work_start_sound);
+    dialog->break_start_sound = g_strdup(settings->break_start_sound);
+    dialog->session_complete_sound = g_strdup(settings->session_complete_sound);
+    dialog->timer_finish_sound = g_strdup(settings->timer_finish_sound);
     
     // Create dialog
     dialog->dialog = gtk_dialog_new();
@@ -137,6 +150,25 @@ SettingsDialog* settings_dialog_new(GtkWindow *parent, const Settings *settings,
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(dialog->enable_sounds_check), settings->enable_sounds);
     gtk_box_pack_start(GTK_BOX(behavior_box), dialog->enable_sounds_check, FALSE, FALSE, 0);
     
+    // Background noise during work sessions
+    GtkWidget *ambient_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_widget_set_margin_left(ambient_box, 24);
+    gtk_box_pack_start(GTK_BOX(behavior_box), ambient_box, FALSE, FALSE, 0);
+    
+    GtkWidget *ambient_label = gtk_label_new("Focus noise while working:");
+    gtk_box_pack_start(GTK_BOX(ambient_box), ambient_label, FALSE, FALSE, 0);
+    
+    dialog->ambient_noise_combo = gtk_combo_box_text_new();
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(dialog->ambient_noise_combo), "off", "Off");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(dialog->ambient_noise_combo), "white", "White noise");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(dialog->ambient_noise_combo), "pink", "Pink noise");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(dialog->ambient_noise_combo), "brown", "Brown noise");
+    gtk_combo_box_text_append(GTK_COMBO_BOX_TEXT(dialog->ambient_noise_combo), "tick", "Ticking clock");
+    if (!gtk_combo_box_set_active_id(GTK_COMBO_BOX(dialog->ambient_noise_combo), settings->ambient_noise)) {
+        gtk_combo_box_set_active_id(GTK_COMBO_BOX(dialog->ambient_noise_combo), "off");
+    }
+    gtk_box_pack_start(GTK_BOX(ambient_box), dialog->ambient_noise_combo, FALSE, FALSE, 0);
+    
     // Idle detection section
     gtk_widget_set_margin_top(dialog->enable_sounds_check, 8);
     dialog->enable_idle_detection_check = gtk_check_button_new_with_label("Auto-pause when idle");
@@ -192,6 +224,11 @@ void settings_dialog_free(SettingsDialog *dialog) {
     if (!dialog) return;
     
     gtk_widget_destroy(dialog->dialog);
+    g_free(dialog->sound_type);
+    g_free(dialog->work_start_sound);
+    g_free(dialog->break_start_sound);
+    g_free(dialog->session_complete_sound);
+    g_free(dialog->timer_finish_sound);
     g_free(dialog);
 }
 
@@ -227,70 +264,17 @@ Settings* settings_dialog_get_settings(SettingsDialog *dialog) {
     // Audio settings (simplified)
     settings->enable_sounds = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(dialog->enable_sounds_check));
     settings->sound_volume = 0.7; // Fixed reasonable volume
-    settings->sound_type = g_strdup("chimes");
-    settings->work_start_sound = NULL;
-    settings->break_start_sound = NULL;
-    settings->session_complete_sound = NULL;
-    settings->timer_finish_sound = NULL;
-    
-    return settings;
-}
-
-Settings* settings_new_default(void) {
-    Settings *settings = g_malloc0(sizeof(Settings));
-    
-    settings->work_duration = 25;
-    settings->short_break_duration = 5;
-    settings->long_break_duration = 15;
-    settings->sessions_until_long_break = 4;
-    settings->auto_start_work_after_break = TRUE;
-    settings->enable_idle_detection = FALSE;  // Off by default
-    settings->idle_timeout_minutes = 2;        // 2 minutes default
-    settings->enable_sounds = TRUE;
-    settings->sound_volume = 0.7; // Fixed reasonable volume
-    settings->sound_type = g_strdup("chimes");
-    settings->work_start_sound = NULL;
-    settings->break_start_sound = NULL;
-    settings->session_complete_sound = NULL;
-    settings->timer_finish_sound = NULL;
+    settings->sound_type = g_strdup(dialog->sound_type ? dialog->sound_type : "chimes");
+    settings->work_start_sound = g_strdup(dialog->work_start_sound);
+    settings->break_start_sound = g_strdup(dialog->break_start_sound);
+    settings->session_complete_sound = g_strdup(dialog->session_complete_sound);
+    settings->timer_finish_sound = g_strdup(dialog->timer_finish_sound);
+    const char *ambient = gtk_combo_box_get_active_id(GTK_COMBO_BOX(dialog->ambient_noise_combo));
+    settings->ambient_noise = g_strdup(ambient ? ambient : "off");
     
     return settings;
 }
 
-void settings_free(Settings *settings) {
-    if (!settings) return;
-    
-    g_free(settings->sound_type);
-    g_free(settings->work_start_sound);
-    g_free(settings->break_start_sound);
-    g_free(settings->session_complete_sound);
-    g_free(settings->timer_finish_sound);
-    g_free(settings);
-}
-
-Settings* settings_copy(const Settings *settings) {
-    if (!settings) return NULL;
-    
-    Settings *copy = g_malloc0(sizeof(Settings));
-    
-    copy->work_duration = settings->work_duration;
-    copy->short_break_duration = settings->short_break_duration;
-    copy->long_break_duration = settings->long_break_duration;
-    copy->sessions_until_long_break = settings->sessions_until_long_break;
-    copy->auto_start_work_after_break = settings->auto_start_work_after_break;
-    copy->enable_idle_detection = settings->enable_idle_detection;
-    copy->idle_timeout_minutes = settings->idle_timeout_minutes;
-    copy->enable_sounds = settings->enable_sounds;
-    copy->sound_volume = settings->sound_volume;
-    copy->sound_type = g_strdup(settings->sound_type);
-    copy->work_start_sound = g_strdup(settings->work_start_sound);
-    copy->break_start_sound = g_strdup(settings->break_start_sound);
-    copy->session_complete_sound = g_strdup(settings->session_complete_sound);
-    copy->timer_finish_sound = g_strdup(settings->timer_finish_sound);
-    
-    return copy;
-}
-
 // Callback implementations
 static void on_restore_defaults_clicked(GtkButton *button, SettingsDialog *dialog) {
     (void)button; // Suppress unused parameter warning
@@ -304,6 +288,7 @@ static void on_restore_defaults_clicked(GtkButton *button, SettingsDialog *dialo
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(dialog->sessions_spin), defaults->sessions_until_long_break);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(dialog->auto_start_check), defaults->auto_start_work_after_break);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(dialog->enable_sounds_check), defaults->enable_sounds);
+    gtk_combo_box_set_active_id(GTK_COMBO_BOX(dialog->ambient_noise_combo), defaults->ambient_noise);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(dialog->enable_idle_detection_check), defaults->enable_idle_detection);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(dialog->idle_timeout_spin), defaults->idle_timeout_minutes);
     
@@ -0,0 +1,90 @@
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+
+#include <glib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// AVX2 is picked at run time, so it is compiled in whenever GCC/clang can
+// target it, independent of the flags the including file is built with
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL 1
+#endif
+
+G_BEGIN_DECLS
+
+// Kernel choice shared by the SIMD modules; their own kernel enums list
+// the same values in the same order
+typedef enum {
+    SIMD_KERNEL_AUTO,            // Best kernel the CPU supports
+    SIMD_KERNEL_SCALAR,
+    SIMD_KERNEL_SSE2,
+    SIMD_KERNEL_AVX2
+} SimdKernel;
+
+// Extra CPU features a module's AVX2 kernel uses
+#define SIMD_NEEDS_FMA (1 << 0)
+
+/**
+ * Checks whether a kernel can run on this CPU
+ * @param kernel Kernel to check
+ * @param needs SIMD_NEEDS_* flags of the module's AVX2 kernel
+ * @return TRUE if supported
+ */
+static inline gboolean simd_kernel_supported(SimdKernel kernel, unsigned int needs) {
+    switch (kernel) {
+        case SIMD_KERNEL_AUTO:
+        case SIMD_KERNEL_SCALAR:
+            return TRUE;
+        case SIMD_KERNEL_SSE2:
+#ifdef __SSE2__
+            return TRUE;
+#else
+            return FALSE;
+#endif
+        case SIMD_KERNEL_AVX2:
+#ifdef HAVE_AVX2_KERNEL
+            if ((needs & SIMD_NEEDS_FMA) && !__builtin_cpu_supports("fma")) return FALSE;
+            return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#else
+            (void)needs; // Suppress unused parameter warning
+            return FALSE;
+#endif
+    }
+    return FALSE;
+}
+
+/**
+ * Picks the kernel to run: the requested one if supported, else the best
+ * supported one
+ * @param kernel Requested kernel, AUTO for the best
+ * @param needs SIMD_NEEDS_* flags of the module's AVX2 kernel
+ * @return SCALAR, SSE2 or AVX2
+ */
+static inline SimdKernel simd_resolve_kernel(SimdKernel kernel, unsigned int needs) {
+    if (kernel != SIMD_KERNEL_AUTO && simd_kernel_supported(kernel, needs)) return kernel;
+    if (simd_kernel_supported(SIMD_KERNEL_AVX2, needs)) return SIMD_KERNEL_AVX2;
+    if (simd_kernel_supported(SIMD_KERNEL_SSE2, needs)) return SIMD_KERNEL_SSE2;
+    return SIMD_KERNEL_SCALAR;
+}
+
+/**
+ * Gets the name of the kernel that would run
+ * @param kernel Requested kernel, AUTO for the best
+ * @param needs SIMD_NEEDS_* flags of the module's AVX2 kernel
+ * @return "scalar", "sse2" or "avx2"
+ */
+static inline const char* simd_kernel_name(SimdKernel kernel, unsigned int needs) {
+    switch (simd_resolve_kernel(kernel, needs)) {
+        case SIMD_KERNEL_AVX2: return "avx2";
+        case SIMD_KERNEL_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+G_END_DECLS
+
+#endif // SIMD_DISPATCH_H
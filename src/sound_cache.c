@@ -0,0 +1,180 @@
+#include "sound_cache.h"
+#include "wav_file.h"
+#include <glib/gstdio.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+// Bump when the synthesizer, the decoder or the file layout changes, so
+// every key changes
+#define SOUND_CACHE_VERSION 2
+
+// Entries not used for this long are deleted when the cache is opened.
+// Keys never repeat once a sound, the device rate or the version changes,
+// so without this every old variant would stay forever.
+#define SOUND_CACHE_MAX_AGE_DAYS 30
+
+struct _SoundCache {
+    char *dir;
+};
+
+static char* get_gain_path(SoundCache *cache, guint64 key);
+static void prune(SoundCache *cache);
+static void touch(const char *path);
+
+SoundCache* sound_cache_new(void) {
+    SoundCache *cache = g_malloc0(sizeof(SoundCache));
+    cache->dir = g_build_filename(g_get_user_cache_dir(), "commodoro", "sounds", NULL);
+    
+    if (g_mkdir_with_parents(cache->dir, 0700) != 0) {
+        g_warning("Failed to create sound cache directory %s", cache->dir);
+    }
+    prune(cache);
+    
+    return cache;
+}
+
+void sound_cache_free(SoundCache *cache) {
+    if (!cache) return;
+    g_free(cache->dir);
+    g_free(cache);
+}
+
+static guint64 hash_bytes(guint64 hash, gconstpointer data, gsize size) {
+    const guchar *p = data;
+    
+    // FNV-1a, 64-bit
+    for (gsize i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+guint64 sound_cache_key(gconstpointer params, gsize size, unsigned int rate, int channels) {
+    guint32 format[] = {SOUND_CACHE_VERSION, rate, (guint32)channels, 16};
+    guint64 hash = 14695981039346656037ULL;
+    
+    hash = hash_bytes(hash, format, sizeof(format));
+    return hash_bytes(hash, params, size);
+}
+
+char* sound_cache_get_path(SoundCache *cache, guint64 key) {
+    if (!cache) return NULL;
+    
+    char name[32];
+    g_snprintf(name, sizeof(name), "%016" G_GINT64_MODIFIER "x.wav", key);
+    return g_build_filename(cache->dir, name, NULL);
+}
+
+GBytes* sound_cache_lookup(SoundCache *cache, guint64 key, unsigned int rate, int channels) {
+    if (!cache) return NULL;
+    
+    char *path = sound_cache_get_path(cache, key);
+    GBytes *samples = NULL;
+    
+    if (access(path, R_OK) == 0) {
+        WavFormat format;
+        samples = wav_file_map(path, &format);
+        
+        if (samples && (format.rate != rate || format.channels != channels || format.bits != 16)) {
+            g_bytes_unref(samples);
+            samples = NULL;
+        }
+        if (samples) touch(path);
+    }
+    
+    g_free(path);
+    return samples;
+}
+
+gboolean sound_cache_store(SoundCache *cache, guint64 key, GBytes *samples, unsigned int rate, int channels) {
+    if (!cache || !samples) return FALSE;
+    
+    gsize size = 0;
+    const gint16 *data = g_bytes_get_data(samples, &size);
+    char *path = sound_cache_get_path(cache, key);
+    
+    gboolean ok = wav_file_write(path, data, size / (channels * sizeof(gint16)), rate, channels);
+    
+    g_free(path);
+    return ok;
+}
+
+gboolean sound_cache_lookup_gain(SoundCache *cache, guint64 key, double *gain) {
+    if (!cache || !gain) return FALSE;
+    
+    char *path = get_gain_path(cache, key);
+    char *contents = NULL;
+    gboolean found = FALSE;
+    
+    if (g_file_get_contents(path, &contents, NULL, NULL)) {
+        char *end = NULL;
+        double value = g_ascii_strtod(contents, &end);
+        
+        if (end != contents && isfinite(value) && value > 0.0) {
+            *gain = value;
+            found = TRUE;
+            touch(path);
+        }
+        g_free(contents);
+    }
+    
+    g_free(path);
+    return found;
+}
+
+gboolean sound_cache_store_gain(SoundCache *cache, guint64 key, double gain) {
+    if (!cache || !isfinite(gain) || gain <= 0.0) return FALSE;
+    
+    char value[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_dtostr(value, sizeof(value), gain);
+    char *contents = g_strconcat(value, "\n", NULL);
+    char *path = get_gain_path(cache, key);
+    GError *error = NULL;
+    
+    // g_file_set_contents writes atomically, so readers never see half a value
+    gboolean ok = g_file_set_contents(path, contents, -1, &error);
+    if (!ok) {
+        g_warning("Failed to store %s: %s", path, error->message);
+        g_error_free(error);
+    }
+    
+    g_free(path);
+    g_free(contents);
+    return ok;
+}
+
+static char* get_gain_path(SoundCache *cache, guint64 key) {
+    char name[32];
+    g_snprintf(name, sizeof(name), "%016" G_GINT64_MODIFIER "x.gain", key);
+    return g_build_filename(cache->dir, name, NULL);
+}
+
+// Marks an entry as used, so pruning keeps it
+static void touch(const char *path) {
+    g_utime(path, NULL);
+}
+
+// Deletes every file not used within SOUND_CACHE_MAX_AGE_DAYS, including
+// temporary files left behind by an interrupted write
+static void prune(SoundCache *cache) {
+    GDir *dir = g_dir_open(cache->dir, 0, NULL);
+    if (!dir) return;
+    
+    time_t cutoff = time(NULL) - (time_t)SOUND_CACHE_MAX_AGE_DAYS * 24 * 60 * 60;
+    const char *name;
+    
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        char *path = g_build_filename(cache->dir, name, NULL);
+        GStatBuf st;
+        
+        if (g_stat(path, &st) == 0 && S_ISREG(st.st_mode) && st.st_mtime < cutoff) {
+            if (g_remove(path) != 0) {
+                g_warning("Failed to remove stale cached sound %s", path);
+            }
+        }
+        g_free(path);
+    }
+    
+    g_dir_close(dir);
+}
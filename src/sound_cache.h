@@ -0,0 +1,87 @@
+#ifndef SOUND_CACHE_H
+#define SOUND_CACHE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SoundCache SoundCache;
+
+/**
+ * Opens the per-user sound cache in $XDG_CACHE_HOME/commodoro/sounds,
+ * creating it (mode 0700) if needed. Sounds are stored as 16-bit PCM WAV
+ * files named after a hash of everything that produced them, so a changed
+ * input never picks up a stale file. Files not looked up for 30 days are
+ * deleted here. Safe to use from any thread.
+ * @return New SoundCache instance
+ */
+SoundCache* sound_cache_new(void);
+
+/**
+ * Frees the sound cache handle (the files stay)
+ * @param cache SoundCache instance to free
+ */
+void sound_cache_free(SoundCache *cache);
+
+/**
+ * Computes the key of a sound from the parameters that produce it and the
+ * output format. The cache format version is part of the key.
+ * @param params Parameter bytes (must not contain uninitialized padding)
+ * @param size Size of params in bytes
+ * @param rate Sample rate in Hz
+ * @param channels Number of channels
+ * @return 64-bit key
+ */
+guint64 sound_cache_key(gconstpointer params, gsize size, unsigned int rate, int channels);
+
+/**
+ * Gets the file a key is stored in (it may not exist yet)
+ * @param cache SoundCache instance
+ * @param key Sound key
+ * @return Newly allocated path
+ */
+char* sound_cache_get_path(SoundCache *cache, guint64 key);
+
+/**
+ * Maps a cached sound
+ * @param cache SoundCache instance
+ * @param key Sound key
+ * @param rate Expected sample rate
+ * @param channels Expected channel count
+ * @return Mapped samples, or NULL if missing or in another format
+ */
+GBytes* sound_cache_lookup(SoundCache *cache, guint64 key, unsigned int rate, int channels);
+
+/**
+ * Stores a sound (written to a temporary file and renamed into place)
+ * @param cache SoundCache instance
+ * @param key Sound key
+ * @param samples Interleaved signed 16-bit samples
+ * @param rate Sample rate in Hz
+ * @param channels Number of channels
+ * @return TRUE on success
+ */
+gboolean sound_cache_store(SoundCache *cache, guint64 key, GBytes *samples, unsigned int rate, int channels);
+
+/**
+ * Gets the playback gain stored next to a sound
+ * @param cache SoundCache instance
+ * @param key Sound key
+ * @param gain Filled with the linear gain if found
+ * @return TRUE if a gain is stored
+ */
+gboolean sound_cache_lookup_gain(SoundCache *cache, guint64 key, double *gain);
+
+/**
+ * Stores the playback gain of a sound, e.g. from a loudness analysis, so
+ * it is measured only once
+ * @param cache SoundCache instance
+ * @param key Sound key
+ * @param gain Linear gain
+ * @return TRUE on success
+ */
+gboolean sound_cache_store_gain(SoundCache *cache, guint64 key, double gain);
+
+G_END_DECLS
+
+#endif // SOUND_CACHE_H
@@ -0,0 +1,257 @@
+#define _GNU_SOURCE
+#include "sound_decoder.h"
+#include "wav_file.h"
+#include "audio_resampler.h"
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#ifdef HAVE_SNDFILE
+#include <sndfile.h>
+#endif
+
+// Frames decoded per step; together with the output buffer this is all the
+// memory a conversion needs
+#define DECODE_BLOCK_FRAMES 4096
+
+// Decoded parts of a mapped file are handed back in steps this big
+#define RELEASE_STEP (1 << 20)
+
+struct _SoundDecoder {
+    unsigned int rate;
+    int channels;
+    
+    // WAV: integer PCM read straight from the mapping
+    GMappedFile *mapped;
+    const guint8 *data;         // First sample
+    gsize frame_count;
+    gsize position;             // Next frame to read
+    int sample_size;            // Bytes per sample
+    gsize released;             // Bytes at the start of the mapping already released
+    
+#ifdef HAVE_SNDFILE
+    SNDFILE *sndfile;           // Everything else
+#endif
+};
+
+static gboolean open_wav(SoundDecoder *decoder, const char *path);
+static gsize read_wav(SoundDecoder *decoder, float *out, gsize frames);
+static void release_consumed(SoundDecoder *decoder);
+#ifdef HAVE_SNDFILE
+static gboolean open_sndfile(SoundDecoder *decoder, const char *path);
+#endif
+static gint16 to_s16(float value);
+
+SoundDecoder* sound_decoder_open(const char *path) {
+    if (!path) return NULL;
+    
+    SoundDecoder *decoder = g_malloc0(sizeof(SoundDecoder));
+    if (open_wav(decoder, path)) return decoder;
+#ifdef HAVE_SNDFILE
+    if (open_sndfile(decoder, path)) return decoder;
+#endif
+    
+    g_warning("Unsupported sound file: %s", path);
+    g_free(decoder);
+    return NULL;
+}
+
+void sound_decoder_free(SoundDecoder *decoder) {
+    if (!decoder) return;
+    
+    if (decoder->mapped) g_mapped_file_unref(decoder->mapped);
+#ifdef HAVE_SNDFILE
+    if (decoder->sndfile) sf_close(decoder->sndfile);
+#endif
+    g_free(decoder);
+}
+
+void sound_decoder_get_format(SoundDecoder *decoder, unsigned int *rate, int *channels) {
+    if (rate) *rate = decoder ? decoder->rate : 0;
+    if (channels) *channels = decoder ? decoder->channels : 0;
+}
+
+gsize sound_decoder_read(SoundDecoder *decoder, float *out, gsize frames) {
+    if (!decoder || !out) return 0;
+    
+    if (decoder->mapped) return read_wav(decoder, out, frames);
+#ifdef HAVE_SNDFILE
+    if (decoder->sndfile) {
+        sf_count_t count = sf_readf_float(decoder->sndfile, out, (sf_count_t)frames);
+        return count > 0 ? (gsize)count : 0;
+    }
+#endif
+    return 0;
+}
+
+gboolean sound_decoder_convert(SoundDecoder *decoder, const char *path, unsigned int rate, int channels, gsize max_frames, LoudnessMeter *meter) {
+    if (!decoder || !path || rate == 0 || channels <= 0) return FALSE;
+    
+    WavWriter *writer = wav_writer_new(path, rate, channels);
+    if (!writer) return FALSE;
+    
+    // Rate and channel conversion happen together, once, at cache time
+    AudioResampler *resampler = audio_resampler_new(decoder->rate, decoder->channels, rate, channels, AUDIO_RESAMPLER_KERNEL_AUTO);
+    gsize out_frames = audio_resampler_get_max_output(resampler, DECODE_BLOCK_FRAMES);
+    float *in = g_malloc(DECODE_BLOCK_FRAMES * decoder->channels * sizeof(float));
+    float *converted = g_malloc(out_frames * channels * sizeof(float));
+    gint16 *out = g_malloc(out_frames * channels * sizeof(gint16));
+    
+    gsize written = 0;
+    gboolean done = FALSE;
+    gboolean ok = TRUE;
+    
+    while (ok && !done && written < max_frames) {
+        gsize frames = sound_decoder_read(decoder, in, DECODE_BLOCK_FRAMES);
+        gsize count;
+        
+        if (frames > 0) {
+            count = audio_resampler_process(resampler, in, frames, converted);
+        } else {
+            // End of the file: flush what is still in the filter
+            count = audio_resampler_drain(resampler, converted);
+            done = TRUE;
+        }
+        
+        if (count > max_frames - written) {
+            g_warning("Sound is longer than %" G_GSIZE_FORMAT " s, cutting it off", max_frames / rate);
+            count = max_frames - written;
+        }
+        
+        loudness_meter_add(meter, converted, count);
+        for (gsize i = 0; i < count * channels; i++) out[i] = to_s16(converted[i]);
+        ok = wav_writer_write(writer, out, count);
+        written += count;
+    }
+    
+    audio_resampler_free(resampler);
+    g_free(in);
+    g_free(converted);
+    g_free(out);
+    
+    if (!ok || written == 0) {
+        wav_writer_abort(writer);
+        return FALSE;
+    }
+    return wav_writer_finish(writer);
+}
+
+gsize sound_decoder_measure(SoundDecoder *decoder, LoudnessMeter *meter) {
+    if (!decoder || !meter) return 0;
+    
+    float *in = g_malloc(DECODE_BLOCK_FRAMES * decoder->channels * sizeof(float));
+    gsize total = 0;
+    gsize frames;
+    
+    while ((frames = sound_decoder_read(decoder, in, DECODE_BLOCK_FRAMES)) > 0) {
+        loudness_meter_add(meter, in, frames);
+        total += frames;
+    }
+    
+    g_free(in);
+    return total;
+}
+
+static gboolean open_wav(SoundDecoder *decoder, const char *path) {
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (!mapped) return FALSE;
+    
+    const guint8 *contents = (const guint8*)g_mapped_file_get_contents(mapped);
+    gsize size = g_mapped_file_get_length(mapped);
+    WavFormat format;
+    gsize offset = 0, length = 0;
+    
+    if (!wav_file_parse(contents, size, &format, &offset, &length) || format.bits > 32) {
+        g_mapped_file_unref(mapped);
+        return FALSE;
+    }
+    
+    decoder->mapped = mapped;
+    decoder->rate = format.rate;
+    decoder->channels = format.channels;
+    decoder->sample_size = (format.bits + 7) / 8;
+    decoder->data = contents + offset;
+    decoder->frame_count = length / ((gsize)format.channels * decoder->sample_size);
+    
+    // Read once front to back: let the kernel read ahead
+    if (size > 0) madvise((void*)contents, size, MADV_SEQUENTIAL);
+    
+    return TRUE;
+}
+
+static gsize read_wav(SoundDecoder *decoder, float *out, gsize frames) {
+    gsize available = decoder->frame_count - decoder->position;
+    if (frames > available) frames = available;
+    
+    gsize samples = frames * decoder->channels;
+    const guint8 *p = decoder->data + decoder->position * decoder->channels * decoder->sample_size;
+    
+    // Samples are little-endian and left-justified, so the container size
+    // gives the full scale; 8-bit samples are unsigned
+    switch (decoder->sample_size) {
+        case 1:
+            for (gsize i = 0; i < samples; i++, p += 1) {
+                out[i] = (p[0] - 128) * (1.0f / 128.0f);
+            }
+            break;
+        case 2:
+            for (gsize i = 0; i < samples; i++, p += 2) {
+                out[i] = (gint16)(p[0] | (p[1] << 8)) * (1.0f / 32768.0f);
+            }
+            break;
+        case 3:
+            for (gsize i = 0; i < samples; i++, p += 3) {
+                out[i] = (gint32)(((guint32)p[0] << 8) | ((guint32)p[1] << 16) | ((guint32)p[2] << 24)) * (1.0f / 2147483648.0f);
+            }
+            break;
+        default:
+            for (gsize i = 0; i < samples; i++, p += 4) {
+                out[i] = (gint32)((guint32)p[0] | ((guint32)p[1] << 8) | ((guint32)p[2] << 16) | ((guint32)p[3] << 24)) * (1.0f / 2147483648.0f);
+            }
+            break;
+    }
+    
+    decoder->position += frames;
+    release_consumed(decoder);
+    return frames;
+}
+
+static void release_consumed(SoundDecoder *decoder) {
+    const guint8 *base = (const guint8*)g_mapped_file_get_contents(decoder->mapped);
+    gsize consumed = (gsize)(decoder->data - base) + decoder->position * decoder->channels * decoder->sample_size;
+    if (consumed - decoder->released < RELEASE_STEP) return;
+    
+    // The pages are clean file pages, so dropping them costs nothing unless
+    // they are read again; this keeps a long file from filling memory
+    gsize page_size = (gsize)sysconf(_SC_PAGESIZE);
+    gsize end = consumed - consumed % page_size;
+    madvise((void*)(base + decoder->released), end - decoder->released, MADV_DONTNEED);
+    decoder->released = end;
+}
+
+#ifdef HAVE_SNDFILE
+static gboolean open_sndfile(SoundDecoder *decoder, const char *path) {
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    
+    SNDFILE *file = sf_open(path, SFM_READ, &info);
+    if (!file) return FALSE;
+    
+    if (info.samplerate <= 0 || info.channels <= 0) {
+        sf_close(file);
+        return FALSE;
+    }
+    
+    decoder->sndfile = file;
+    decoder->rate = (unsigned int)info.samplerate;
+    decoder->channels = info.channels;
+    return TRUE;
+}
+#endif
+
+static gint16 to_s16(float value) {
+    float scaled = value * 32768.0f;
+    if (scaled >= 32767.0f) return G_MAXINT16;
+    if (scaled <= -32768.0f) return G_MININT16;
+    return (gint16)lrintf(scaled);
+}
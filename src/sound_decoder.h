@@ -0,0 +1,67 @@
+#ifndef SOUND_DECODER_H
+#define SOUND_DECODER_H
+
+#include <glib.h>
+#include "loudness_meter.h"
+
+G_BEGIN_DECLS
+
+typedef struct _SoundDecoder SoundDecoder;
+
+/**
+ * Opens a sound file for streaming decode. WAV is read from a memory map;
+ * FLAC, Ogg Vorbis and other formats are read through libsndfile when the
+ * build found it (HAVE_SNDFILE).
+ * @param path Sound file
+ * @return New SoundDecoder instance, or NULL if the file can't be decoded
+ */
+SoundDecoder* sound_decoder_open(const char *path);
+
+/**
+ * Frees a decoder
+ * @param decoder SoundDecoder instance to free
+ */
+void sound_decoder_free(SoundDecoder *decoder);
+
+/**
+ * Gets the format of the decoded samples
+ * @param decoder SoundDecoder instance
+ * @param rate Filled with the sample rate in Hz
+ * @param channels Filled with the number of channels
+ */
+void sound_decoder_get_format(SoundDecoder *decoder, unsigned int *rate, int *channels);
+
+/**
+ * Reads the next frames as interleaved floats in [-1, 1)
+ * @param decoder SoundDecoder instance
+ * @param out Buffer for frames * channels samples
+ * @param frames Maximum number of frames to read
+ * @return Number of frames read, 0 at the end of the file
+ */
+gsize sound_decoder_read(SoundDecoder *decoder, float *out, gsize frames);
+
+/**
+ * Decodes the rest of the file into a 16-bit PCM WAV file at another rate
+ * and channel count, converted by a polyphase resampler. Works block by
+ * block, so memory use doesn't depend on the length of the sound.
+ * @param decoder SoundDecoder instance
+ * @param path Destination file (replaced only when complete)
+ * @param rate Output sample rate in Hz
+ * @param channels Output channel count
+ * @param max_frames Output frames after which the sound is cut off
+ * @param meter Meter that measures the converted sound on the way, or NULL
+ * @return TRUE if the file was written
+ */
+gboolean sound_decoder_convert(SoundDecoder *decoder, const char *path, unsigned int rate, int channels, gsize max_frames, LoudnessMeter *meter);
+
+/**
+ * Decodes the rest of the file into a loudness meter, block by block
+ * @param decoder SoundDecoder instance
+ * @param meter Meter created for the decoder's rate and channel count
+ * @return Number of frames measured
+ */
+gsize sound_decoder_measure(SoundDecoder *decoder, LoudnessMeter *meter);
+
+G_END_DECLS
+
+#endif // SOUND_DECODER_H
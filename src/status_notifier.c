@@ -0,0 +1,356 @@
+#include "status_notifier.h"
+#include "pixel_convert.h"
+
+#define SNI_OBJECT_PATH "/StatusNotifierItem"
+#define SNI_INTERFACE "org.kde.StatusNotifierItem"
+#define SNI_WATCHER_NAME "org.kde.StatusNotifierWatcher"
+#define SNI_WATCHER_PATH "/StatusNotifierWatcher"
+
+struct _StatusNotifier {
+    GDBusConnection *connection;
+    guint registration_id;
+    guint watcher_watch_id;
+    GCancellable *register_cancellable;
+    gboolean registered;
+    
+    StatusNotifierCallback callback;
+    gpointer user_data;
+    
+    // Published state; icon_pixmap is the a(iiay) handed out on every Get
+    GVariant *icon_pixmap;
+    guint64 icon_hash;
+    gboolean has_icon_hash;
+    guint icon_count;
+    char *tooltip;
+};
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='org.kde.StatusNotifierItem'>"
+    "    <property name='Category' type='s' access='read'/>"
+    "    <property name='Id' type='s' access='read'/>"
+    "    <property name='Title' type='s' access='read'/>"
+    "    <property name='Status' type='s' access='read'/>"
+    "    <property name='WindowId' type='i' access='read'/>"
+    "    <property name='IconName' type='s' access='read'/>"
+    "    <property name='IconPixmap' type='a(iiay)' access='read'/>"
+    "    <property name='ToolTip' type='(sa(iiay)ss)' access='read'/>"
+    "    <property name='ItemIsMenu' type='b' access='read'/>"
+    "    <method name='Activate'>"
+    "      <arg type='i' name='x' direction='in'/>"
+    "      <arg type='i' name='y' direction='in'/>"
+    "    </method>"
+    "    <method name='SecondaryActivate'>"
+    "      <arg type='i' name='x' direction='in'/>"
+    "      <arg type='i' name='y' direction='in'/>"
+    "    </method>"
+    "    <method name='ContextMenu'>"
+    "      <arg type='i' name='x' direction='in'/>"
+    "      <arg type='i' name='y' direction='in'/>"
+    "    </method>"
+    "    <method name='Scroll'>"
+    "      <arg type='i' name='delta' direction='in'/>"
+    "      <arg type='s' name='orientation' direction='in'/>"
+    "    </method>"
+    "    <signal name='NewTitle'/>"
+    "    <signal name='NewIcon'/>"
+    "    <signal name='NewToolTip'/>"
+    "    <signal name='NewStatus'>"
+    "      <arg type='s' name='status'/>"
+    "    </signal>"
+    "  </interface>"
+    "</node>";
+
+static void handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *method_name, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer user_data);
+static GVariant* handle_get_property(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *property_name, GError **error, gpointer user_data);
+static void on_watcher_appeared(GDBusConnection *connection, const gchar *name, const gchar *name_owner, gpointer user_data);
+static void on_watcher_vanished(GDBusConnection *connection, const gchar *name, gpointer user_data);
+static void on_register_finished(GObject *source, GAsyncResult *result, gpointer user_data);
+static void emit_signal(StatusNotifier *notifier, const char *signal_name);
+static void set_registered(StatusNotifier *notifier, gboolean registered);
+
+static const GDBusInterfaceVTable interface_vtable = {
+    .method_call = handle_method_call,
+    .get_property = handle_get_property
+};
+
+StatusNotifier* status_notifier_new(void) {
+    StatusNotifier *notifier = g_malloc0(sizeof(StatusNotifier));
+    
+    // Hosts may ask before the first frame is rendered
+    notifier->icon_pixmap = g_variant_ref_sink(g_variant_new_array(G_VARIANT_TYPE("(iiay)"), NULL, 0));
+    notifier->tooltip = g_strdup("Commodoro Timer");
+    
+    return notifier;
+}
+
+void status_notifier_free(StatusNotifier *notifier) {
+    if (!notifier) return;
+    
+    status_notifier_detach(notifier);
+    
+    g_variant_unref(notifier->icon_pixmap);
+    g_free(notifier->tooltip);
+    g_free(notifier);
+}
+
+void status_notifier_set_callback(StatusNotifier *notifier, StatusNotifierCallback callback, gpointer user_data) {
+    if (!notifier) return;
+    
+    notifier->callback = callback;
+    notifier->user_data = user_data;
+}
+
+void status_notifier_attach(StatusNotifier *notifier, GDBusConnection *connection) {
+    if (!notifier || !connection) return;
+    
+    status_notifier_detach(notifier);
+    
+    GError *error = NULL;
+    GDBusNodeInfo *introspection_data = g_dbus_node_info_new_for_xml(introspection_xml, &error);
+    if (error) {
+        g_warning("Failed to create StatusNotifierItem introspection data: %s", error->message);
+        g_error_free(error);
+        return;
+    }
+    
+    notifier->registration_id = g_dbus_connection_register_object(connection,
+                                                                  SNI_OBJECT_PATH,
+                                                                  introspection_data->interfaces[0],
+                                                                  &interface_vtable,
+                                                                  notifier,
+                                                                  NULL, // GDestroyNotify
+                                                                  &error);
+    g_dbus_node_info_unref(introspection_data);
+    
+    if (error) {
+        g_warning("Failed to export StatusNotifierItem: %s", error->message);
+        g_error_free(error);
+        return;
+    }
+    
+    notifier->connection = g_object_ref(connection);
+    
+    // (Re-)register every time a watcher shows up, e.g. after a panel restart
+    notifier->watcher_watch_id = g_bus_watch_name_on_connection(connection,
+                                                                SNI_WATCHER_NAME,
+                                                                G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                                on_watcher_appeared,
+                                                                on_watcher_vanished,
+                                                                notifier,
+                                                                NULL);
+}
+
+void status_notifier_detach(StatusNotifier *notifier) {
+    if (!notifier) return;
+    
+    if (notifier->register_cancellable) {
+        g_cancellable_cancel(notifier->register_cancellable);
+        g_object_unref(notifier->register_cancellable);
+        notifier->register_cancellable = NULL;
+    }
+    
+    if (notifier->watcher_watch_id) {
+        g_bus_unwatch_name(notifier->watcher_watch_id);
+        notifier->watcher_watch_id = 0;
+    }
+    
+    if (notifier->connection) {
+        if (notifier->registration_id) {
+            g_dbus_connection_unregister_object(notifier->connection, notifier->registration_id);
+            notifier->registration_id = 0;
+        }
+        g_object_unref(notifier->connection);
+        notifier->connection = NULL;
+    }
+    
+    notifier->registered = FALSE;
+}
+
+void status_notifier_update(StatusNotifier *notifier, cairo_surface_t *surface, const char *tooltip) {
+    if (!notifier) return;
+    
+    if (surface) {
+        cairo_surface_flush(surface);
+        
+        int width = cairo_image_surface_get_width(surface);
+        int height = cairo_image_surface_get_height(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+        const guint8 *data = cairo_image_surface_get_data(surface);
+        
+        guint64 hash = pixel_hash(data, stride, width * 4, height) ^ ((guint64)width << 32 | (guint)height);
+        
+        if (data && !(notifier->has_icon_hash && hash == notifier->icon_hash)) {
+            gsize row_bytes = (gsize)width * 4;
+            guint8 *pixels = g_malloc(row_bytes * height);
+            pixel_convert_argb32_to_argb_be(data, stride, pixels, (int)row_bytes, width, height);
+            
+            GVariant *bytes = g_variant_new_from_data(G_VARIANT_TYPE("ay"), pixels, row_bytes * height,
+                                                      TRUE, g_free, pixels);
+            GVariantBuilder builder;
+            g_variant_builder_init(&builder, G_VARIANT_TYPE("a(iiay)"));
+            g_variant_builder_add(&builder, "(ii@ay)", width, height, bytes);
+            
+            g_variant_unref(notifier->icon_pixmap);
+            notifier->icon_pixmap = g_variant_ref_sink(g_variant_builder_end(&builder));
+            notifier->icon_hash = hash;
+            notifier->has_icon_hash = TRUE;
+            notifier->icon_count++;
+            
+            emit_signal(notifier, "NewIcon");
+        }
+    }
+    
+    if (tooltip && g_strcmp0(tooltip, notifier->tooltip) != 0) {
+        g_free(notifier->tooltip);
+        notifier->tooltip = g_strdup(tooltip);
+        emit_signal(notifier, "NewToolTip");
+    }
+}
+
+gboolean status_notifier_is_registered(StatusNotifier *notifier) {
+    if (!notifier) return FALSE;
+    
+    return notifier->registered;
+}
+
+guint status_notifier_get_icon_count(StatusNotifier *notifier) {
+    if (!notifier) return 0;
+    
+    return notifier->icon_count;
+}
+
+static void emit_signal(StatusNotifier *notifier, const char *signal_name) {
+    // Nobody to tell until a watcher has picked the item up
+    if (!notifier->connection || !notifier->registered) return;
+    
+    g_dbus_connection_emit_signal(notifier->connection, NULL, SNI_OBJECT_PATH, SNI_INTERFACE,
+                                  signal_name, NULL, NULL);
+}
+
+static void set_registered(StatusNotifier *notifier, gboolean registered) {
+    if (notifier->registered == registered) return;
+    
+    notifier->registered = registered;
+    if (notifier->callback) {
+        notifier->callback(registered ? "registered" : "unregistered", notifier->user_data);
+    }
+}
+
+static void on_watcher_appeared(GDBusConnection *connection, const gchar *name, const gchar *name_owner, gpointer user_data) {
+    (void)name;       // Suppress unused parameter warning
+    (void)name_owner; // Suppress unused parameter warning
+    StatusNotifier *notifier = (StatusNotifier*)user_data;
+    
+    if (notifier->register_cancellable) {
+        g_cancellable_cancel(notifier->register_cancellable);
+        g_object_unref(notifier->register_cancellable);
+    }
+    notifier->register_cancellable = g_cancellable_new();
+    
+    // The watcher looks up SNI_OBJECT_PATH on the bus name we pass
+    g_dbus_connection_call(connection,
+                           SNI_WATCHER_NAME,
+                           SNI_WATCHER_PATH,
+                           SNI_WATCHER_NAME,
+                           "RegisterStatusNotifierItem",
+                           g_variant_new("(s)", g_dbus_connection_get_unique_name(connection)),
+                           NULL,
+                           G_DBUS_CALL_FLAGS_NONE,
+                           -1,
+                           notifier->register_cancellable,
+                           on_register_finished,
+                           notifier);
+}
+
+static void on_watcher_vanished(GDBusConnection *connection, const gchar *name, gpointer user_data) {
+    (void)connection; // Suppress unused parameter warning
+    (void)name;       // Suppress unused parameter warning
+    StatusNotifier *notifier = (StatusNotifier*)user_data;
+    
+    set_registered(notifier, FALSE);
+}
+
+static void on_register_finished(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GError *error = NULL;
+    GVariant *reply = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
+    
+    if (!reply) {
+        // Cancelled by detach or a newer watcher; the notifier may be gone
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning("StatusNotifierWatcher refused the tray item: %s", error->message);
+        }
+        g_error_free(error);
+        return;
+    }
+    g_variant_unref(reply);
+    
+    StatusNotifier *notifier = (StatusNotifier*)user_data;
+    set_registered(notifier, TRUE);
+    
+    // The host fetches properties on registration; these catch it up on
+    // anything that changed while the call was in flight
+    emit_signal(notifier, "NewIcon");
+    emit_signal(notifier, "NewToolTip");
+}
+
+static void handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *method_name, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer user_data) {
+    (void)connection;     // Suppress unused parameter warning
+    (void)sender;         // Suppress unused parameter warning
+    (void)object_path;    // Suppress unused parameter warning
+    (void)interface_name; // Suppress unused parameter warning
+    (void)parameters;     // Suppress unused parameter warning
+    StatusNotifier *notifier = (StatusNotifier*)user_data;
+    const char *action = NULL;
+    
+    if (g_strcmp0(method_name, "Activate") == 0) {
+        action = "activate";
+    } else if (g_strcmp0(method_name, "SecondaryActivate") == 0) {
+        action = "secondary-activate";
+    } else if (g_strcmp0(method_name, "ContextMenu") == 0) {
+        action = "popup-menu";
+    } else if (g_strcmp0(method_name, "Scroll") != 0) {
+        g_dbus_method_invocation_return_dbus_error(invocation, "org.freedesktop.DBus.Error.UnknownMethod", "Method does not exist");
+        return;
+    }
+    
+    g_dbus_method_invocation_return_value(invocation, NULL);
+    
+    if (action && notifier->callback) {
+        notifier->callback(action, notifier->user_data);
+    }
+}
+
+static GVariant* handle_get_property(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *property_name, GError **error, gpointer user_data) {
+    (void)connection;     // Suppress unused parameter warning
+    (void)sender;         // Suppress unused parameter warning
+    (void)object_path;    // Suppress unused parameter warning
+    (void)interface_name; // Suppress unused parameter warning
+    StatusNotifier *notifier = (StatusNotifier*)user_data;
+    
+    if (g_strcmp0(property_name, "Category") == 0) {
+        return g_variant_new_string("ApplicationStatus");
+    } else if (g_strcmp0(property_name, "Id") == 0) {
+        return g_variant_new_string("commodoro");
+    } else if (g_strcmp0(property_name, "Title") == 0) {
+        return g_variant_new_string("Commodoro");
+    } else if (g_strcmp0(property_name, "Status") == 0) {
+        return g_variant_new_string("Active");
+    } else if (g_strcmp0(property_name, "WindowId") == 0) {
+        return g_variant_new_int32(0);
+    } else if (g_strcmp0(property_name, "IconName") == 0) {
+        return g_variant_new_string("");
+    } else if (g_strcmp0(property_name, "IconPixmap") == 0) {
+        // Shared, already encoded; no per-request conversion
+        return g_variant_ref(notifier->icon_pixmap);
+    } else if (g_strcmp0(property_name, "ToolTip") == 0) {
+        return g_variant_new("(s@a(iiay)ss)", "",
+                             g_variant_new_array(G_VARIANT_TYPE("(iiay)"), NULL, 0),
+                             "Commodoro", notifier->tooltip);
+    } else if (g_strcmp0(property_name, "ItemIsMenu") == 0) {
+        return g_variant_new_boolean(FALSE);
+    }
+    
+    g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY, "Unknown property %s", property_name);
+    return NULL;
+}
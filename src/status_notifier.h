@@ -0,0 +1,82 @@
+#ifndef STATUS_NOTIFIER_H
+#define STATUS_NOTIFIER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+typedef struct _StatusNotifier StatusNotifier;
+
+/**
+ * Callback function for status notifier events
+ * @param action Action name ("activate", "secondary-activate", "popup-menu",
+ *               "registered" once a watcher accepted the item, "unregistered"
+ *               when the watcher went away)
+ * @param user_data User data passed to callback
+ */
+typedef void (*StatusNotifierCallback)(const char *action, gpointer user_data);
+
+/**
+ * Creates a new StatusNotifierItem tray icon. Nothing is exported until it
+ * is attached to a bus connection.
+ * @return New StatusNotifier object
+ */
+StatusNotifier* status_notifier_new(void);
+
+/**
+ * Frees a status notifier, unexporting it first
+ * @param notifier StatusNotifier instance to free
+ */
+void status_notifier_free(StatusNotifier *notifier);
+
+/**
+ * Sets the callback for status notifier events
+ * @param notifier StatusNotifier instance
+ * @param callback Callback function
+ * @param user_data User data passed to callback
+ */
+void status_notifier_set_callback(StatusNotifier *notifier, StatusNotifierCallback callback, gpointer user_data);
+
+/**
+ * Exports the item on /StatusNotifierItem of the given connection and
+ * registers it with the StatusNotifierWatcher whenever one is on the bus
+ * @param notifier StatusNotifier instance
+ * @param connection Session bus connection (a reference is kept)
+ */
+void status_notifier_attach(StatusNotifier *notifier, GDBusConnection *connection);
+
+/**
+ * Unexports the item and stops watching for a StatusNotifierWatcher
+ * @param notifier StatusNotifier instance
+ */
+void status_notifier_detach(StatusNotifier *notifier);
+
+/**
+ * Updates the icon and tooltip. The pixmap is re-encoded and NewIcon emitted
+ * only when the surface content changed; NewToolTip only when the text did.
+ * @param notifier StatusNotifier instance
+ * @param surface Cairo ARGB32 surface with the rendered icon, or NULL to only
+ *                update the tooltip
+ * @param tooltip Tooltip text, or NULL to keep the current one
+ */
+void status_notifier_update(StatusNotifier *notifier, cairo_surface_t *surface, const char *tooltip);
+
+/**
+ * Checks whether a StatusNotifierWatcher accepted the item
+ * @param notifier StatusNotifier instance
+ * @return TRUE if registered with a watcher, FALSE otherwise
+ */
+gboolean status_notifier_is_registered(StatusNotifier *notifier);
+
+/**
+ * Gets the number of NewIcon signals emitted so far
+ * @param notifier StatusNotifier instance
+ * @return Number of icon changes published
+ */
+guint status_notifier_get_icon_count(StatusNotifier *notifier);
+
+G_END_DECLS
+
+#endif // STATUS_NOTIFIER_H
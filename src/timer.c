@@ -1,4 +1,10 @@
+#define _GNU_SOURCE
 #include "timer.h"
+#include <time.h>
+
+// Dispatches later than this past the deadline are treated as a resume from
+// suspend (or a stalled process) and go through the catch-up path
+#define TIMER_CATCH_UP_THRESHOLD_US (2 * G_USEC_PER_SEC)
 
 struct _Timer {
     TimerState state;
@@ -11,8 +17,11 @@ struct _Timer {
     int long_break_duration;
     int sessions_until_long;
     
-    // Current timer state
-    int remaining_seconds;
+    // Current timer state. While a phase runs, the remaining time is derived
+    // from an absolute monotonic deadline so late main loop dispatches never
+    // accumulate drift; otherwise remaining_us holds the frozen value.
+    gint64 deadline_us;      // timer_now_us() deadline, 0 when not running
+    gint64 remaining_us;     // Remaining time while idle or paused
     int total_seconds;
     guint timer_id;
     
@@ -23,21 +32,67 @@ struct _Timer {
     // Track what should start next when in IDLE
     gboolean work_session_just_finished;
     
+    // TRUE while callbacks for a coalesced catch-up are being delivered
+    gboolean catching_up;
+    
+    // Tick resolutions requested by consumers; ticks fire on the nearest
+    // boundary any of them needs, otherwise only at the deadline
+    GArray *subscriptions;   // TimerSubscription
+    guint next_subscription_id;
+    guint wakeup_count;
+    
+    // Time source and scheduler (real clock and GLib main loop by default)
+    const TimerClock *clock;
+    gpointer clock_data;
+    
     // Callbacks
     TimerStateCallback state_callback;
     TimerTickCallback tick_callback;
     TimerSessionCompleteCallback session_complete_callback;
     gpointer user_data;
+    TimerCatchUpCallback catch_up_callback;
+    gpointer catch_up_user_data;
 };
 
+typedef struct {
+    guint id;
+    gint64 resolution_us;
+} TimerSubscription;
+
 static gboolean timer_tick_internal(gpointer user_data);
 static void timer_transition_to_next_state(Timer *timer);
 static void timer_set_state(Timer *timer, TimerState new_state);
+static void timer_apply_state(Timer *timer, TimerState new_state);
+static TimerState timer_get_break_type(Timer *timer);
+static void timer_fast_forward(Timer *timer, gint64 now_us);
+static gint64 timer_now_us(Timer *timer);
+static void timer_remove_source(Timer *timer);
+static gint64 default_clock_now_us(gpointer clock_data);
+static guint default_clock_add_timeout(guint interval_ms, GSourceFunc func, gpointer data, gpointer clock_data);
+static void default_clock_remove_timeout(guint source_id, gpointer clock_data);
+
+static const TimerClock default_clock = {
+    .now_us = default_clock_now_us,
+    .add_timeout = default_clock_add_timeout,
+    .remove_timeout = default_clock_remove_timeout
+};
 static int timer_get_duration_for_state(Timer *timer, TimerState state);
+static gint64 timer_get_remaining_us(Timer *timer);
+static int timer_get_remaining_seconds(Timer *timer);
+static void timer_run(Timer *timer, gint64 phase_start_us);
+static void timer_stop(Timer *timer);
+static void timer_schedule_tick(Timer *timer);
 
 Timer* timer_new(void) {
+    return timer_new_with_clock(NULL, NULL);
+}
+
+Timer* timer_new_with_clock(const TimerClock *clock, gpointer clock_data) {
     Timer *timer = g_malloc0(sizeof(Timer));
     
+    timer->clock = clock ? clock : &default_clock;
+    timer->clock_data = clock ? clock_data : NULL;
+    
     // Set default durations (25/5/15 minute Pomodoro)
     timer->work_duration = 25;
     timer->short_break_duration = 5;
@@ -55,8 +110,12 @@ Timer* timer_new(void) {
     timer->use_seconds_mode = FALSE;  // Default to minutes
     
     // Set initial time to work duration
-    timer->remaining_seconds = timer_get_duration_for_state(timer, TIMER_STATE_WORK);
-    timer->total_seconds = timer->remaining_seconds;
+    timer->total_seconds = timer_get_duration_for_state(timer, TIMER_STATE_WORK);
+    timer->remaining_us = (gint64)timer->total_seconds * G_USEC_PER_SEC;
+    timer->deadline_us = 0;
+    
+    timer->subscriptions = g_array_new(FALSE, FALSE, sizeof(TimerSubscription));
+    timer->next_subscription_id = 1;
     
     return timer;
 }
@@ -65,9 +124,10 @@ void timer_free(Timer *timer) {
     if (!timer) return;
     
     if (timer->timer_id > 0) {
-        g_source_remove(timer->timer_id);
+        timer_remove_source(timer);
     }
     
+    g_array_free(timer->subscriptions, TRUE);
     g_free(timer);
 }
 
@@ -92,6 +152,13 @@ void timer_set_callbacks(Timer *timer, TimerStateCallback state_cb,
     timer->user_data = user_data;
 }
 
+void timer_set_catch_up_callback(Timer *timer, TimerCatchUpCallback catch_up_cb, gpointer user_data) {
+    if (!timer) return;
+    
+    timer->catch_up_callback = catch_up_cb;
+    timer->catch_up_user_data = user_data;
+}
+
 void timer_start(Timer *timer) {
     if (!timer) return;
     
@@ -110,19 +177,16 @@ void timer_start(Timer *timer) {
         }
     }
     
-    if (timer->timer_id == 0) {
-        timer->timer_id = g_timeout_add(1000, timer_tick_internal, timer);
-    } else {
+    if (timer->deadline_us == 0 && timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
+        timer_run(timer, timer_now_us(timer));
     }
 }
 
 void timer_pause(Timer *timer) {
     if (!timer) return;
     
-    if (timer->timer_id > 0) {
-        g_source_remove(timer->timer_id);
-        timer->timer_id = 0;
-    }
+    // Freeze the remaining time at the moment of pausing
+    timer_stop(timer);
     
     if (timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
         // Save current state before pausing
@@ -139,10 +203,7 @@ void timer_pause(Timer *timer) {
 void timer_reset(Timer *timer) {
     if (!timer) return;
     
-    if (timer->timer_id > 0) {
-        g_source_remove(timer->timer_id);
-        timer->timer_id = 0;
-    }
+    timer_stop(timer);
     
     timer->session_count = 1;
     timer->previous_state = TIMER_STATE_IDLE;
@@ -167,8 +228,17 @@ void timer_get_remaining(Timer *timer, int *minutes, int *seconds) {
         return;
     }
     
-    if (minutes) *minutes = timer->remaining_seconds / 60;
-    if (seconds) *seconds = timer->remaining_seconds % 60;
+    int remaining_seconds = timer_get_remaining_seconds(timer);
+    if (minutes) *minutes = remaining_seconds / 60;
+    if (seconds) *seconds = remaining_seconds % 60;
+}
+
+gint64 timer_get_remaining_ms(Timer *timer) {
+    if (!timer) return 0;
+    
+    // Rounded up like the seconds, so waiting this long minus a whole number
+    // of seconds lands exactly on a displayed-second boundary
+    return (timer_get_remaining_us(timer) + 999) / 1000;
 }
 
 int timer_get_total_duration(Timer *timer) {
@@ -176,32 +246,135 @@ int timer_get_total_duration(Timer *timer) {
     return timer->total_seconds;
 }
 
+const TimerClock* timer_clock_get_default(void) {
+    return &default_clock;
+}
+
+static gint64 timer_now_us(Timer *timer) {
+    return timer->clock->now_us(timer->clock_data);
+}
+
+static void timer_remove_source(Timer *timer) {
+    timer->clock->remove_timeout(timer->timer_id, timer->clock_data);
+    timer->timer_id = 0;
+}
+
+static gint64 default_clock_now_us(gpointer clock_data) {
+    (void)clock_data;
+#ifdef CLOCK_BOOTTIME
+    // Unlike CLOCK_MONOTONIC (and g_get_monotonic_time()), CLOCK_BOOTTIME
+    // keeps counting while the machine is suspended, so deadlines stay
+    // anchored to wall time across sleep
+    struct timespec ts;
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) == 0) {
+        return (gint64)ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+    }
+#endif
+    return g_get_monotonic_time();
+}
+
+static guint default_clock_add_timeout(guint interval_ms, GSourceFunc func, gpointer data, gpointer clock_data) {
+    (void)clock_data;
+    return g_timeout_add(interval_ms, func, data);
+}
+
+static void default_clock_remove_timeout(guint source_id, gpointer clock_data) {
+    (void)clock_data;
+    g_source_remove(source_id);
+}
+
+static gint64 timer_get_remaining_us(Timer *timer) {
+    if (timer->deadline_us == 0) {
+        return timer->remaining_us;
+    }
+    
+    gint64 remaining = timer->deadline_us - timer_now_us(timer);
+    return remaining > 0 ? remaining : 0;
+}
+
+static int timer_get_remaining_seconds(Timer *timer) {
+    // Round up so the display shows 25:00 for the whole first second and
+    // reaches 00:00 exactly at the deadline
+    return (int)((timer_get_remaining_us(timer) + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC);
+}
+
+static void timer_run(Timer *timer, gint64 phase_start_us) {
+    timer->deadline_us = phase_start_us + timer->remaining_us;
+    timer_schedule_tick(timer);
+}
+
+static void timer_stop(Timer *timer) {
+    if (timer->timer_id > 0) {
+        timer_remove_source(timer);
+    }
+    
+    if (timer->deadline_us > 0) {
+        timer->remaining_us = timer_get_remaining_us(timer);
+        timer->deadline_us = 0;
+    }
+}
+
+static void timer_schedule_tick(Timer *timer) {
+    if (timer->timer_id > 0) {
+        timer_remove_source(timer);
+    }
+    
+    // Wake up at the nearest boundary any subscriber cares about (e.g. the
+    // displayed second changing for a 1 s subscriber), and never later than
+    // the deadline itself. With no subscribers only the deadline wakes us.
+    gint64 remaining = timer_get_remaining_us(timer);
+    gint64 wait_us = remaining;
+    for (guint i = 0; i < timer->subscriptions->len; i++) {
+        gint64 resolution_us = g_array_index(timer->subscriptions, TimerSubscription, i).resolution_us;
+        gint64 boundary_us = remaining % resolution_us;
+        if (boundary_us == 0) {
+            boundary_us = resolution_us;
+        }
+        if (boundary_us < wait_us) {
+            wait_us = boundary_us;
+        }
+    }
+    
+    guint wait_ms = (guint)((wait_us + 999) / 1000);
+    timer->timer_id = timer->clock->add_timeout(wait_ms, timer_tick_internal, timer, timer->clock_data);
+}
+
 static gboolean timer_tick_internal(gpointer user_data) {
     Timer *timer = (Timer*)user_data;
+    timer->timer_id = 0;
+    timer->wakeup_count++;
     
-    
-    if (timer->remaining_seconds > 0) {
-        timer->remaining_seconds--;
-        
+    gint64 now_us = timer_now_us(timer);
+    if (now_us - timer->deadline_us >= TIMER_CATCH_UP_THRESHOLD_US) {
+        // We slept through the deadline, possibly several phases of it
+        timer_fast_forward(timer, now_us);
+    } else if (timer_get_remaining_us(timer) > 0) {
         // Call tick callback
         if (timer->tick_callback) {
-            int minutes = timer->remaining_seconds / 60;
-            int seconds = timer->remaining_seconds % 60;
-            timer->tick_callback(timer, minutes, seconds, timer->user_data);
+            int remaining_seconds = timer_get_remaining_seconds(timer);
+            timer->tick_callback(timer, remaining_seconds / 60, remaining_seconds % 60, timer->user_data);
         }
         
-        return G_SOURCE_CONTINUE;
+        // The callback may have paused or reset the timer
+        if (timer->deadline_us > 0 && timer->timer_id == 0) {
+            timer_schedule_tick(timer);
+        }
     } else {
         // Timer finished, transition to next state
-        timer->timer_id = 0;
         timer_transition_to_next_state(timer);
-        return G_SOURCE_REMOVE;
     }
+    
+    return G_SOURCE_REMOVE;
 }
 
 static void timer_transition_to_next_state(Timer *timer) {
     gboolean should_auto_start = TRUE;
     
+    // Chain the next phase off the old deadline rather than the (possibly
+    // late) dispatch time so consecutive phases don't accumulate drift
+    gint64 phase_start_us = timer->deadline_us > 0 ? timer->deadline_us : timer_now_us(timer);
+    timer->deadline_us = 0;
+    
     switch (timer->state) {
         case TIMER_STATE_WORK:
             // Work session finished - signal completion then start appropriate break
@@ -214,14 +387,7 @@ static void timer_transition_to_next_state(Timer *timer) {
             }
             
             // Determine which type of break to start
-            TimerState break_type;
-            if ((timer->session_count - 1) % timer->sessions_until_long == 0) {
-                break_type = TIMER_STATE_LONG_BREAK;
-            } else {
-                break_type = TIMER_STATE_SHORT_BREAK;
-            }
-            
-            timer_set_state(timer, break_type);
+            timer_set_state(timer, timer_get_break_type(timer));
             should_auto_start = TRUE;  // Auto-start the break
             break;
             
@@ -247,21 +413,93 @@ static void timer_transition_to_next_state(Timer *timer) {
     }
     
     // Auto-start the next phase if appropriate
-    if (should_auto_start && timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
-        timer->timer_id = g_timeout_add(1000, timer_tick_internal, timer);
+    if (should_auto_start && timer->deadline_us == 0 &&
+        timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
+        timer_run(timer, phase_start_us);
     }
 }
 
-static void timer_set_state(Timer *timer, TimerState new_state) {
+static TimerState timer_get_break_type(Timer *timer) {
+    if ((timer->session_count - 1) % timer->sessions_until_long == 0) {
+        return TIMER_STATE_LONG_BREAK;
+    }
+    return TIMER_STATE_SHORT_BREAK;
+}
+
+static void timer_fast_forward(Timer *timer, gint64 now_us) {
+    GArray *completed = g_array_new(FALSE, FALSE, sizeof(TimerState));
+    
+    // Jump straight across every phase boundary that passed, one step per
+    // phase and without callbacks. Each phase starts at the previous deadline.
+    while (timer->deadline_us > 0 && now_us >= timer->deadline_us) {
+        TimerState finished = timer->state;
+        gint64 phase_start_us = timer->deadline_us;
+        g_array_append_val(completed, finished);
+        
+        switch (finished) {
+            case TIMER_STATE_WORK:
+                timer->session_count++;
+                timer->work_session_just_finished = TRUE;
+                timer_apply_state(timer, timer_get_break_type(timer));
+                timer->deadline_us = phase_start_us + timer->remaining_us;
+                break;
+            case TIMER_STATE_SHORT_BREAK:
+            case TIMER_STATE_LONG_BREAK:
+                // Breaks never auto-start work, so this ends the walk
+                timer->work_session_just_finished = FALSE;
+                timer_apply_state(timer, TIMER_STATE_IDLE);
+                break;
+            case TIMER_STATE_IDLE:
+            case TIMER_STATE_PAUSED:
+                timer->deadline_us = 0;
+                break;
+        }
+    }
+    
+    if (timer->deadline_us > 0) {
+        timer_schedule_tick(timer);
+    }
+    
+    // Deliver one coalesced batch instead of a callback burst per phase
+    timer->catching_up = TRUE;
+    
+    if (completed->len > 0) {
+        if (timer->catch_up_callback) {
+            timer->catch_up_callback(timer, (const TimerState*)completed->data, completed->len,
+                                     timer->catch_up_user_data);
+        } else if (timer->session_complete_callback) {
+            TimerState last = g_array_index(completed, TimerState, completed->len - 1);
+            timer->session_complete_callback(timer, last, timer->user_data);
+        }
+        
+        if (timer->state_callback) {
+            timer->state_callback(timer, timer->state, timer->user_data);
+        }
+    }
+    
+    if (timer->tick_callback) {
+        int remaining_seconds = timer_get_remaining_seconds(timer);
+        timer->tick_callback(timer, remaining_seconds / 60, remaining_seconds % 60, timer->user_data);
+    }
+    
+    timer->catching_up = FALSE;
+    g_array_free(completed, TRUE);
+}
+
+static void timer_apply_state(Timer *timer, TimerState new_state) {
     timer->state = new_state;
     
     if (new_state == TIMER_STATE_IDLE) {
-        timer->remaining_seconds = timer_get_duration_for_state(timer, TIMER_STATE_WORK);
-        timer->total_seconds = timer->remaining_seconds;
+        timer->total_seconds = timer_get_duration_for_state(timer, TIMER_STATE_WORK);
     } else {
-        timer->remaining_seconds = timer_get_duration_for_state(timer, new_state);
-        timer->total_seconds = timer->remaining_seconds;
+        timer->total_seconds = timer_get_duration_for_state(timer, new_state);
     }
+    timer->remaining_us = (gint64)timer->total_seconds * G_USEC_PER_SEC;
+    timer->deadline_us = 0;
+}
+
+static void timer_set_state(Timer *timer, TimerState new_state) {
+    timer_apply_state(timer, new_state);
     
     // Call state callback
     if (timer->state_callback) {
@@ -270,9 +508,8 @@ static void timer_set_state(Timer *timer, TimerState new_state) {
     
     // Call tick callback to update display
     if (timer->tick_callback) {
-        int minutes = timer->remaining_seconds / 60;
-        int seconds = timer->remaining_seconds % 60;
-        timer->tick_callback(timer, minutes, seconds, timer->user_data);
+        int remaining_seconds = timer_get_remaining_seconds(timer);
+        timer->tick_callback(timer, remaining_seconds / 60, remaining_seconds % 60, timer->user_data);
     }
 }
 
@@ -284,20 +521,119 @@ void timer_extend_break(Timer *timer, int additional_seconds) {
         return;
     }
     
-    // Add the additional seconds to remaining time
-    timer->remaining_seconds += additional_seconds;
+    // Push the deadline out (or the frozen remaining time if not running)
+    gint64 additional_us = (gint64)additional_seconds * G_USEC_PER_SEC;
+    if (timer->deadline_us > 0) {
+        timer->deadline_us += additional_us;
+        timer_schedule_tick(timer);
+    } else {
+        timer->remaining_us += additional_us;
+    }
     
     // Update total duration to reflect the extension
     timer->total_seconds += additional_seconds;
     
     // Call tick callback to update display immediately
     if (timer->tick_callback) {
-        int minutes = timer->remaining_seconds / 60;
-        int seconds = timer->remaining_seconds % 60;
-        timer->tick_callback(timer, minutes, seconds, timer->user_data);
+        int remaining_seconds = timer_get_remaining_seconds(timer);
+        timer->tick_callback(timer, remaining_seconds / 60, remaining_seconds % 60, timer->user_data);
     }
 }
 
+void timer_resync(Timer *timer) {
+    if (!timer || timer->deadline_us == 0) return;
+    
+    gint64 now_us = timer_now_us(timer);
+    if (now_us >= timer->deadline_us) {
+        if (timer->timer_id > 0) {
+            timer_remove_source(timer);
+        }
+        timer_fast_forward(timer, now_us);
+    } else {
+        // Pending timeouts were computed before the clock jumped; re-arm them
+        // and refresh the display right away
+        timer_schedule_tick(timer);
+        if (timer->tick_callback) {
+            int remaining_seconds = timer_get_remaining_seconds(timer);
+            timer->tick_callback(timer, remaining_seconds / 60, remaining_seconds % 60, timer->user_data);
+        }
+    }
+}
+
+guint timer_subscribe_resolution(Timer *timer, int resolution_seconds) {
+    if (!timer || resolution_seconds <= 0) return 0;
+    
+    TimerSubscription subscription = {
+        .id = timer->next_subscription_id++,
+        .resolution_us = (gint64)resolution_seconds * G_USEC_PER_SEC
+    };
+    g_array_append_val(timer->subscriptions, subscription);
+    
+    // A finer resolution may need an earlier wakeup than the one pending
+    if (timer->deadline_us > 0) {
+        timer_schedule_tick(timer);
+    }
+    
+    return subscription.id;
+}
+
+void timer_unsubscribe_resolution(Timer *timer, guint subscription_id) {
+    if (!timer || subscription_id == 0) return;
+    
+    for (guint i = 0; i < timer->subscriptions->len; i++) {
+        if (g_array_index(timer->subscriptions, TimerSubscription, i).id == subscription_id) {
+            g_array_remove_index_fast(timer->subscriptions, i);
+            break;
+        }
+    }
+    
+    // Let a pending fine-grained wakeup be replaced by a coarser one
+    if (timer->deadline_us > 0) {
+        timer_schedule_tick(timer);
+    }
+}
+
+guint timer_get_wakeup_count(Timer *timer) {
+    if (!timer) return 0;
+    return timer->wakeup_count;
+}
+
+void timer_get_persistent_state(Timer *timer, TimerPersistentState *out_state) {
+    if (!timer || !out_state) return;
+    
+    out_state->state = timer->state;
+    out_state->previous_state = timer->previous_state;
+    out_state->session_count = timer->session_count;
+    out_state->total_seconds = timer->total_seconds;
+    out_state->remaining_us = timer_get_remaining_us(timer);
+    out_state->work_session_just_finished = timer->work_session_just_finished;
+}
+
+void timer_restore_persistent_state(Timer *timer, const TimerPersistentState *state, gint64 elapsed_us) {
+    if (!timer || !state) return;
+    if (state->state < TIMER_STATE_IDLE || state->state > TIMER_STATE_PAUSED) return;
+    
+    timer_stop(timer);
+    
+    timer->state = state->state;
+    timer->previous_state = state->previous_state;
+    timer->session_count = MAX(1, state->session_count);
+    timer->total_seconds = state->total_seconds;
+    timer->remaining_us = CLAMP(state->remaining_us, 0, (gint64)state->total_seconds * G_USEC_PER_SEC);
+    timer->work_session_just_finished = state->work_session_just_finished;
+    
+    if (timer->state == TIMER_STATE_WORK || timer->state == TIMER_STATE_SHORT_BREAK ||
+        timer->state == TIMER_STATE_LONG_BREAK) {
+        // Anchor the deadline in the past by the time we were gone
+        timer_run(timer, timer_now_us(timer) - MAX(0, elapsed_us));
+    }
+}
+
+gboolean timer_is_catching_up(Timer *timer) {
+    if (!timer) return FALSE;
+    return timer->catching_up;
+}
+
 void timer_set_auto_start_work(Timer *timer, gboolean auto_start) {
     if (!timer) return;
     timer->auto_start_work_after_break = auto_start;
@@ -338,10 +674,7 @@ static int timer_get_duration_for_state(Timer *timer, TimerState state) {
 void timer_skip_phase(Timer *timer) {
     if (!timer) return;
 
-    if (timer->timer_id > 0) {
-        g_source_remove(timer->timer_id);
-        timer->timer_id = 0;
-    }
+    timer_stop(timer);
 
     switch (timer->state) {
         case TIMER_STATE_WORK:
@@ -351,8 +684,9 @@ void timer_skip_phase(Timer *timer) {
         case TIMER_STATE_LONG_BREAK:
             timer->work_session_just_finished = FALSE;
             timer_set_state(timer, TIMER_STATE_WORK);
-            if (timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
-                timer->timer_id = g_timeout_add(1000, timer_tick_internal, timer);
+            if (timer->deadline_us == 0 &&
+                timer->state != TIMER_STATE_IDLE && timer->state != TIMER_STATE_PAUSED) {
+                timer_run(timer, timer_now_us(timer));
             }
             break;
         case TIMER_STATE_IDLE:
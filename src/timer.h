@@ -40,12 +40,64 @@ typedef void (*TimerTickCallback)(Timer *timer, int minutes, int seconds, gpoint
  */
 typedef void (*TimerSessionCompleteCallback)(Timer *timer, TimerState completed_state, gpointer user_data);
 
+/**
+ * Callback function for phases completed while the process was suspended
+ * @param timer Timer instance
+ * @param completed_states States that completed, oldest first
+ * @param n_completed Number of entries in completed_states
+ * @param user_data User data passed to callback
+ */
+typedef void (*TimerCatchUpCallback)(Timer *timer, const TimerState *completed_states, 
+                                     int n_completed, gpointer user_data);
+
+/**
+ * Everything needed to resume a timer in a new process. Durations are not
+ * included; they come from the settings as usual.
+ */
+typedef struct {
+    TimerState state;
+    TimerState previous_state;     // State before pausing
+    int session_count;
+    int total_seconds;             // Total duration of the current phase
+    gint64 remaining_us;           // Remaining time of the current phase
+    gboolean work_session_just_finished;
+} TimerPersistentState;
+
+/**
+ * Time source and scheduler used by a timer. The default implementation
+ * reads CLOCK_BOOTTIME and schedules with g_timeout_add(); simulations and
+ * shared schedulers can substitute their own.
+ */
+typedef struct {
+    /** Returns the current time in microseconds */
+    gint64 (*now_us)(gpointer clock_data);
+    /** Schedules a one-shot call of func after interval_ms; returns an id > 0 */
+    guint (*add_timeout)(guint interval_ms, GSourceFunc func, gpointer data, gpointer clock_data);
+    /** Cancels a timeout returned by add_timeout that has not fired yet */
+    void (*remove_timeout)(guint source_id, gpointer clock_data);
+} TimerClock;
+
+/**
+ * Gets the default clock (CLOCK_BOOTTIME and the GLib main loop)
+ * @return Default clock interface; its clock_data is unused
+ */
+const TimerClock* timer_clock_get_default(void);
+
 /**
  * Creates a new timer instance
  * @return New Timer object
  */
 Timer* timer_new(void);
 
+/**
+ * Creates a new timer instance driven by a custom clock
+ * @param clock Clock and scheduler to use (NULL for the default clock);
+ *              must outlive the timer
+ * @param clock_data User data passed to the clock functions
+ * @return New Timer object
+ */
+Timer* timer_new_with_clock(const TimerClock *clock, gpointer clock_data);
+
 /**
  * Frees a timer instance
  * @param timer Timer instance to free
@@ -75,6 +127,19 @@ void timer_set_callbacks(Timer *timer, TimerStateCallback state_cb,
                         TimerTickCallback tick_cb, TimerSessionCompleteCallback session_complete_cb,
                         gpointer user_data);
 
+/**
+ * Sets the callback for phases skipped over on resume from suspend. When a
+ * deadline passes while the machine sleeps, the timer jumps straight to the
+ * current phase and reports all completed phases in one batch, followed by a
+ * single state callback, instead of one session-complete/state pair per phase.
+ * Without this callback, only the last completed phase is reported through
+ * the session complete callback.
+ * @param timer Timer instance
+ * @param catch_up_cb Callback for coalesced completions (can be NULL)
+ * @param user_data User data passed to callback
+ */
+void timer_set_catch_up_callback(Timer *timer, TimerCatchUpCallback catch_up_cb, gpointer user_data);
+
 /**
  * Starts the timer
  * @param timer Timer instance
@@ -115,6 +180,14 @@ int timer_get_session(Timer *timer);
  */
 void timer_get_remaining(Timer *timer, int *minutes, int *seconds);
 
+/**
+ * Gets the remaining time with millisecond precision, for scheduling work
+ * at the moment the displayed seconds change
+ * @param timer Timer instance
+ * @return Remaining milliseconds, rounded up
+ */
+gint64 timer_get_remaining_ms(Timer *timer);
+
 /**
  * Gets the total duration for current timer state
  * @param timer Timer instance
@@ -129,6 +202,63 @@ int timer_get_total_duration(Timer *timer);
  */
 void timer_extend_break(Timer *timer, int additional_seconds);
 
+/**
+ * Re-evaluates the running phase against the boot clock, e.g. after resume
+ * from suspend. Fast-forwards over any phase boundaries that passed.
+ * @param timer Timer instance
+ */
+void timer_resync(Timer *timer);
+
+/**
+ * Registers a consumer that needs tick callbacks at a given resolution.
+ * The timer wakes at the nearest boundary required by any subscriber (and
+ * at phase deadlines), so with only coarse subscribers it stays asleep for
+ * most of a phase. Ticks land when the remaining time crosses a multiple of
+ * the resolution.
+ * @param timer Timer instance
+ * @param resolution_seconds Required tick resolution in seconds (> 0)
+ * @return Subscription id for timer_unsubscribe_resolution, or 0 on error
+ */
+guint timer_subscribe_resolution(Timer *timer, int resolution_seconds);
+
+/**
+ * Removes a tick resolution subscription
+ * @param timer Timer instance
+ * @param subscription_id Id returned by timer_subscribe_resolution
+ */
+void timer_unsubscribe_resolution(Timer *timer, guint subscription_id);
+
+/**
+ * Gets the number of times the timer has woken the main loop
+ * @param timer Timer instance
+ * @return Number of timer wakeups since creation
+ */
+guint timer_get_wakeup_count(Timer *timer);
+
+/**
+ * Checks whether callbacks are being delivered for a coalesced catch-up
+ * @param timer Timer instance
+ * @return TRUE inside callbacks fired by a catch-up, FALSE otherwise
+ */
+gboolean timer_is_catching_up(Timer *timer);
+
+/**
+ * Captures the timer's state for persistence
+ * @param timer Timer instance
+ * @param out_state Filled with the current state
+ */
+void timer_get_persistent_state(Timer *timer, TimerPersistentState *out_state);
+
+/**
+ * Restores a captured state without firing callbacks. A phase that was
+ * running continues with elapsed_us taken off its remaining time; if it
+ * would already have ended, the timer catches up on its first dispatch.
+ * @param timer Timer instance
+ * @param state State captured by timer_get_persistent_state()
+ * @param elapsed_us Time passed since the state was captured
+ */
+void timer_restore_persistent_state(Timer *timer, const TimerPersistentState *state, gint64 elapsed_us);
+
 /**
  * Sets the auto-start work after break setting
  * @param timer Timer instance
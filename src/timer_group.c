@@ -0,0 +1,101 @@
+#include "timer_group.h"
+
+typedef struct {
+    char *name;
+    Timer *timer;
+} TimerGroupEntry;
+
+struct _TimerGroup {
+    TimerWheel *wheel;
+    GPtrArray *entries;   // TimerGroupEntry, in insertion order
+};
+
+static void timer_group_entry_free(gpointer data) {
+    TimerGroupEntry *entry = (TimerGroupEntry*)data;
+    timer_free(entry->timer);
+    g_free(entry->name);
+    g_free(entry);
+}
+
+static int timer_group_find(TimerGroup *group, const char *name) {
+    for (guint i = 0; i < group->entries->len; i++) {
+        TimerGroupEntry *entry = g_ptr_array_index(group->entries, i);
+        if (g_strcmp0(entry->name, name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+TimerGroup* timer_group_new(void) {
+    TimerGroup *group = g_malloc0(sizeof(TimerGroup));
+    group->wheel = timer_wheel_new(NULL, NULL);
+    group->entries = g_ptr_array_new_with_free_func(timer_group_entry_free);
+    return group;
+}
+
+void timer_group_free(TimerGroup *group) {
+    if (!group) return;
+    
+    // Timers cancel their timeouts on the wheel, so they go first
+    g_ptr_array_free(group->entries, TRUE);
+    timer_wheel_free(group->wheel);
+    g_free(group);
+}
+
+Timer* timer_group_add(TimerGroup *group, const char *name) {
+    if (!group || !name || !*name) return NULL;
+    if (timer_group_find(group, name) >= 0) return NULL;
+    
+    TimerGroupEntry *entry = g_malloc0(sizeof(TimerGroupEntry));
+    entry->name = g_strdup(name);
+    entry->timer = timer_new_with_clock(timer_wheel_get_clock(), group->wheel);
+    g_ptr_array_add(group->entries, entry);
+    
+    return entry->timer;
+}
+
+gboolean timer_group_remove(TimerGroup *group, const char *name) {
+    if (!group) return FALSE;
+    
+    int index = timer_group_find(group, name);
+    if (index < 0) return FALSE;
+    
+    g_ptr_array_remove_index(group->entries, index);
+    return TRUE;
+}
+
+Timer* timer_group_lookup(TimerGroup *group, const char *name) {
+    if (!group) return NULL;
+    
+    int index = timer_group_find(group, name);
+    return index >= 0 ? timer_group_get_timer(group, index) : NULL;
+}
+
+guint timer_group_get_count(TimerGroup *group) {
+    if (!group) return 0;
+    return group->entries->len;
+}
+
+Timer* timer_group_get_timer(TimerGroup *group, guint index) {
+    if (!group || index >= group->entries->len) return NULL;
+    return ((TimerGroupEntry*)g_ptr_array_index(group->entries, index))->timer;
+}
+
+const char* timer_group_get_name(TimerGroup *group, guint index) {
+    if (!group || index >= group->entries->len) return NULL;
+    return ((TimerGroupEntry*)g_ptr_array_index(group->entries, index))->name;
+}
+
+void timer_group_resync(TimerGroup *group) {
+    if (!group) return;
+    
+    for (guint i = 0; i < group->entries->len; i++) {
+        timer_resync(timer_group_get_timer(group, i));
+    }
+}
+
+TimerWheel* timer_group_get_wheel(TimerGroup *group) {
+    if (!group) return NULL;
+    return group->wheel;
+}
@@ -0,0 +1,86 @@
+#ifndef TIMER_GROUP_H
+#define TIMER_GROUP_H
+
+#include <glib.h>
+#include "timer.h"
+#include "timer_wheel.h"
+
+G_BEGIN_DECLS
+
+typedef struct _TimerGroup TimerGroup;
+
+/**
+ * Creates a group of named timers that all run on one shared TimerWheel
+ * @return New TimerGroup object
+ */
+TimerGroup* timer_group_new(void);
+
+/**
+ * Frees a timer group and every timer in it
+ * @param group TimerGroup instance to free
+ */
+void timer_group_free(TimerGroup *group);
+
+/**
+ * Adds a new idle timer with default durations. The group owns the timer.
+ * @param group TimerGroup instance
+ * @param name Unique, non-empty timer name
+ * @return New Timer, or NULL if the name is empty or already taken
+ */
+Timer* timer_group_add(TimerGroup *group, const char *name);
+
+/**
+ * Removes and frees a named timer
+ * @param group TimerGroup instance
+ * @param name Timer name
+ * @return TRUE if a timer was removed
+ */
+gboolean timer_group_remove(TimerGroup *group, const char *name);
+
+/**
+ * Looks up a timer by name
+ * @param group TimerGroup instance
+ * @param name Timer name
+ * @return Timer, or NULL if there is none with that name
+ */
+Timer* timer_group_lookup(TimerGroup *group, const char *name);
+
+/**
+ * Gets the number of timers in the group
+ * @param group TimerGroup instance
+ * @return Number of timers
+ */
+guint timer_group_get_count(TimerGroup *group);
+
+/**
+ * Gets a timer by position (timers keep the order they were added in)
+ * @param group TimerGroup instance
+ * @param index Position, less than timer_group_get_count()
+ * @return Timer at index
+ */
+Timer* timer_group_get_timer(TimerGroup *group, guint index);
+
+/**
+ * Gets a timer's name by position
+ * @param group TimerGroup instance
+ * @param index Position, less than timer_group_get_count()
+ * @return Name owned by the group
+ */
+const char* timer_group_get_name(TimerGroup *group, guint index);
+
+/**
+ * Re-evaluates every timer against the boot clock, e.g. after resume
+ * @param group TimerGroup instance
+ */
+void timer_group_resync(TimerGroup *group);
+
+/**
+ * Gets the wheel that schedules the group's timers
+ * @param group TimerGroup instance
+ * @return Shared TimerWheel
+ */
+TimerWheel* timer_group_get_wheel(TimerGroup *group);
+
+G_END_DECLS
+
+#endif // TIMER_GROUP_H
@@ -0,0 +1,224 @@
+#define _GNU_SOURCE
+#include "timer_snapshot.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SNAPSHOT_FILENAME "commodoro-timer.snapshot"
+#define SNAPSHOT_MAGIC 0x534d4443u    // "CDMS"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BOOT_ID_LENGTH 40
+
+// Fixed-width fields so the layout doesn't depend on enum or gboolean size
+typedef struct {
+    guint32 state;
+    guint32 previous_state;
+    gint32 session_count;
+    gint32 total_seconds;
+    gint32 work_session_just_finished;
+    gint32 reserved;
+    gint64 remaining_us;        // Frozen remaining time (idle or paused)
+    gint64 deadline_us;         // Absolute boot clock deadline while running, else 0
+    gint64 captured_us;         // Boot clock when captured
+    gint64 captured_real_us;    // Wall clock when captured, used across reboots
+    char boot_id[SNAPSHOT_BOOT_ID_LENGTH];
+} SnapshotRecord;
+
+typedef struct {
+    gint sequence;              // Odd while the slot is being written
+    guint32 reserved;
+    guint64 generation;         // Newest valid slot wins
+    SnapshotRecord record;
+} SnapshotSlot;
+
+typedef struct {
+    guint32 magic;
+    guint32 version;
+    SnapshotSlot slots[2];
+} SnapshotFile;
+
+struct _TimerSnapshot {
+    SnapshotFile *file;         // MAP_SHARED mapping
+    guint64 generation;         // Generation of the last slot written
+    char boot_id[SNAPSHOT_BOOT_ID_LENGTH];
+};
+
+static void timer_snapshot_read_boot_id(char *boot_id) {
+    memset(boot_id, 0, SNAPSHOT_BOOT_ID_LENGTH);
+    
+    int fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    
+    ssize_t n = read(fd, boot_id, SNAPSHOT_BOOT_ID_LENGTH - 1);
+    close(fd);
+    if (n > 0 && boot_id[n - 1] == '\n') {
+        boot_id[n - 1] = '\0';
+    }
+}
+
+// Copies a slot out under its seqlock; FALSE if it is torn or empty
+static gboolean timer_snapshot_read_slot(SnapshotSlot *slot, SnapshotRecord *record, guint64 *generation) {
+    for (int attempt = 0; attempt < 4; attempt++) {
+        gint begin = g_atomic_int_get(&slot->sequence);
+        if (begin & 1) {
+            // A writer died mid-update (or is still writing); retry briefly
+            continue;
+        }
+        
+        memcpy(record, &slot->record, sizeof(SnapshotRecord));
+        *generation = slot->generation;
+        
+        if (g_atomic_int_get(&slot->sequence) == begin) {
+            return *generation > 0;
+        }
+    }
+    return FALSE;
+}
+
+TimerSnapshot* timer_snapshot_open(const char *path) {
+    char *default_path = NULL;
+    if (!path) {
+        default_path = g_build_filename(g_get_user_runtime_dir(), SNAPSHOT_FILENAME, NULL);
+        path = default_path;
+    }
+    
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        g_warning("Failed to open timer snapshot %s", path);
+        g_free(default_path);
+        return NULL;
+    }
+    
+    struct stat st;
+    gboolean fresh = fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(SnapshotFile);
+    if (fresh && ftruncate(fd, sizeof(SnapshotFile)) != 0) {
+        g_warning("Failed to size timer snapshot %s", path);
+        close(fd);
+        g_free(default_path);
+        return NULL;
+    }
+    
+    void *map = mmap(NULL, sizeof(SnapshotFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    g_free(default_path);
+    if (map == MAP_FAILED) {
+        g_warning("Failed to map timer snapshot");
+        return NULL;
+    }
+    
+    TimerSnapshot *snapshot = g_malloc0(sizeof(TimerSnapshot));
+    snapshot->file = (SnapshotFile*)map;
+    timer_snapshot_read_boot_id(snapshot->boot_id);
+    
+    // Anything from another layout version is ignored and overwritten
+    if (fresh || snapshot->file->magic != SNAPSHOT_MAGIC || snapshot->file->version != SNAPSHOT_VERSION) {
+        memset(snapshot->file, 0, sizeof(SnapshotFile));
+        snapshot->file->magic = SNAPSHOT_MAGIC;
+        snapshot->file->version = SNAPSHOT_VERSION;
+    }
+    
+    snapshot->generation = MAX(snapshot->file->slots[0].generation, snapshot->file->slots[1].generation);
+    return snapshot;
+}
+
+void timer_snapshot_close(TimerSnapshot *snapshot) {
+    if (!snapshot) return;
+    
+    munmap(snapshot->file, sizeof(SnapshotFile));
+    g_free(snapshot);
+}
+
+void timer_snapshot_save(TimerSnapshot *snapshot, Timer *timer) {
+    if (!snapshot || !timer) return;
+    
+    TimerPersistentState state;
+    timer_get_persistent_state(timer, &state);
+    
+    SnapshotRecord record = {0};
+    record.state = state.state;
+    record.previous_state = state.previous_state;
+    record.session_count = state.session_count;
+    record.total_seconds = state.total_seconds;
+    record.work_session_just_finished = state.work_session_just_finished;
+    record.remaining_us = state.remaining_us;
+    record.captured_us = timer_clock_get_default()->now_us(NULL);
+    record.captured_real_us = g_get_real_time();
+    if (state.state == TIMER_STATE_WORK || state.state == TIMER_STATE_SHORT_BREAK ||
+        state.state == TIMER_STATE_LONG_BREAK) {
+        record.deadline_us = record.captured_us + state.remaining_us;
+    }
+    memcpy(record.boot_id, snapshot->boot_id, SNAPSHOT_BOOT_ID_LENGTH);
+    
+    // Write the older slot so the newer one survives a crash mid-write
+    guint64 generation = snapshot->generation + 1;
+    SnapshotSlot *slot = &snapshot->file->slots[generation & 1];
+    
+    // Force the sequence odd even if a crashed writer left it odd already
+    gint sequence = slot->sequence | 1;
+    g_atomic_int_set(&slot->sequence, sequence);
+    memcpy(&slot->record, &record, sizeof(SnapshotRecord));
+    slot->generation = generation;
+    g_atomic_int_set(&slot->sequence, sequence + 1);
+    
+    snapshot->generation = generation;
+}
+
+gboolean timer_snapshot_restore(TimerSnapshot *snapshot, Timer *timer) {
+    if (!snapshot || !timer) return FALSE;
+    
+    SnapshotRecord records[2];
+    guint64 generations[2] = {0, 0};
+    gboolean valid[2];
+    for (int i = 0; i < 2; i++) {
+        valid[i] = timer_snapshot_read_slot(&snapshot->file->slots[i], &records[i], &generations[i]);
+    }
+    
+    int newest = -1;
+    for (int i = 0; i < 2; i++) {
+        if (valid[i] && (newest < 0 || generations[i] > generations[newest])) {
+            newest = i;
+        }
+    }
+    if (newest < 0) return FALSE;
+    
+    const SnapshotRecord *record = &records[newest];
+    if (record->state > TIMER_STATE_PAUSED || record->previous_state > TIMER_STATE_PAUSED) {
+        return FALSE;
+    }
+    
+    // Elapsed time since capture: the boot clock is exact (and counts
+    // suspend) within one boot; after a reboot only the wall clock is left
+    gint64 elapsed_us;
+    if (snapshot->boot_id[0] && strncmp(record->boot_id, snapshot->boot_id, SNAPSHOT_BOOT_ID_LENGTH) == 0) {
+        elapsed_us = timer_clock_get_default()->now_us(NULL) - record->captured_us;
+    } else {
+        elapsed_us = g_get_real_time() - record->captured_real_us;
+    }
+    
+    TimerPersistentState state = {
+        .state = (TimerState)record->state,
+        .previous_state = (TimerState)record->previous_state,
+        .session_count = record->session_count,
+        .total_seconds = record->total_seconds,
+        .remaining_us = record->deadline_us > 0 ? record->deadline_us - record->captured_us : record->remaining_us,
+        .work_session_just_finished = record->work_session_just_finished != 0
+    };
+    timer_restore_persistent_state(timer, &state, MAX(0, elapsed_us));
+    
+    return TRUE;
+}
+
+void timer_snapshot_discard(TimerSnapshot *snapshot) {
+    if (!snapshot) return;
+    
+    for (int i = 0; i < 2; i++) {
+        SnapshotSlot *slot = &snapshot->file->slots[i];
+        gint sequence = slot->sequence | 1;
+        g_atomic_int_set(&slot->sequence, sequence);
+        slot->generation = 0;
+        g_atomic_int_set(&slot->sequence, sequence + 1);
+    }
+    snapshot->generation = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef TIMER_SNAPSHOT_H
+#define TIMER_SNAPSHOT_H
+
+#include <glib.h>
+#include "timer.h"
+
+G_BEGIN_DECLS
+
+typedef struct _TimerSnapshot TimerSnapshot;
+
+/**
+ * Opens (creating if needed) a memory-mapped timer snapshot file. Saves are
+ * crash-safe: the file holds two seqlock-protected slots and a save only
+ * ever overwrites the older one, so a process dying mid-write leaves the
+ * previous snapshot intact.
+ * @param path Snapshot file path, or NULL for commodoro-timer.snapshot in
+ *             $XDG_RUNTIME_DIR
+ * @return New TimerSnapshot object, or NULL if the file can't be mapped
+ */
+TimerSnapshot* timer_snapshot_open(const char *path);
+
+/**
+ * Unmaps and closes a snapshot file, keeping its contents
+ * @param snapshot TimerSnapshot instance to close
+ */
+void timer_snapshot_close(TimerSnapshot *snapshot);
+
+/**
+ * Records the timer's current state. Cheap enough to call on every state
+ * transition (a memcpy into shared memory, no syscalls).
+ * @param snapshot TimerSnapshot instance
+ * @param timer Timer to capture
+ */
+void timer_snapshot_save(TimerSnapshot *snapshot, Timer *timer);
+
+/**
+ * Restores the most recent valid snapshot into a timer without firing
+ * callbacks. Time that passed while no process was running (including
+ * across a reboot, via the wall clock) is taken off the running phase.
+ * @param snapshot TimerSnapshot instance
+ * @param timer Timer to restore into
+ * @return TRUE if a snapshot was restored, FALSE if none was valid
+ */
+gboolean timer_snapshot_restore(TimerSnapshot *snapshot, Timer *timer);
+
+/**
+ * Invalidates the stored snapshot so the next start begins fresh
+ * @param snapshot TimerSnapshot instance
+ */
+void timer_snapshot_discard(TimerSnapshot *snapshot);
+
+G_END_DECLS
+
+#endif // TIMER_SNAPSHOT_H
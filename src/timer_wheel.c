@@ -0,0 +1,339 @@
+#include "timer_wheel.h"
+
+// Four levels of 64 one-millisecond slots cover 64^4 ms (~4.6 hours) ahead
+// of the wheel's current time; anything later waits in an overflow list
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+
+#define WHEEL_LIST_DUE (-1)
+#define WHEEL_LIST_OVERFLOW WHEEL_LEVELS
+
+typedef struct _WheelEntry WheelEntry;
+
+struct _WheelEntry {
+    guint id;
+    gint64 expires_ms;
+    guint interval_ms;
+    GSourceFunc func;
+    gpointer data;
+    
+    // Position in the wheel
+    int level;               // WHEEL_LIST_DUE, 0..WHEEL_LEVELS-1 or WHEEL_LIST_OVERFLOW
+    int slot;
+    WheelEntry *prev;
+    WheelEntry *next;
+};
+
+struct _TimerWheel {
+    const TimerClock *base_clock;
+    gpointer base_clock_data;
+    
+    // Entries expiring within the current level-(n+1) block live in level n,
+    // in the slot of their level-n digit. Every occupied slot therefore lies
+    // strictly ahead of current_ms's digit on that level.
+    WheelEntry *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    guint64 occupied[WHEEL_LEVELS];   // Bit per non-empty slot
+    WheelEntry *overflow;
+    WheelEntry *due;                  // expires_ms <= current_ms, fire next
+    gint64 current_ms;
+    
+    GHashTable *entries;              // id -> WheelEntry
+    guint next_id;
+    
+    // The one armed base clock timeout
+    guint source_id;
+    gint64 armed_ms;
+    gboolean dispatching;
+    guint wakeup_count;
+};
+
+static gint64 wheel_clock_now_us(gpointer clock_data);
+static guint wheel_clock_add_timeout(guint interval_ms, GSourceFunc func, gpointer data, gpointer clock_data);
+static void wheel_clock_remove_timeout(guint source_id, gpointer clock_data);
+
+static const TimerClock wheel_clock = {
+    .now_us = wheel_clock_now_us,
+    .add_timeout = wheel_clock_add_timeout,
+    .remove_timeout = wheel_clock_remove_timeout
+};
+
+static gint64 timer_wheel_now_us(TimerWheel *wheel);
+static void timer_wheel_insert(TimerWheel *wheel, WheelEntry *entry);
+static void timer_wheel_unlink(TimerWheel *wheel, WheelEntry *entry);
+static WheelEntry* timer_wheel_pop_expired(TimerWheel *wheel, gint64 now_ms);
+static gint64 timer_wheel_next_expiry(TimerWheel *wheel);
+static void timer_wheel_arm(TimerWheel *wheel);
+static gboolean timer_wheel_dispatch(gpointer user_data);
+
+TimerWheel* timer_wheel_new(const TimerClock *base_clock, gpointer base_clock_data) {
+    TimerWheel *wheel = g_malloc0(sizeof(TimerWheel));
+    
+    wheel->base_clock = base_clock ? base_clock : timer_clock_get_default();
+    wheel->base_clock_data = base_clock ? base_clock_data : NULL;
+    wheel->entries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    wheel->next_id = 1;
+    wheel->current_ms = timer_wheel_now_us(wheel) / 1000;
+    wheel->armed_ms = G_MAXINT64;
+    
+    return wheel;
+}
+
+void timer_wheel_free(TimerWheel *wheel) {
+    if (!wheel) return;
+    
+    if (g_hash_table_size(wheel->entries) > 0) {
+        g_warning("Freeing timer wheel with %u pending timeouts", g_hash_table_size(wheel->entries));
+    }
+    
+    if (wheel->source_id > 0) {
+        wheel->base_clock->remove_timeout(wheel->source_id, wheel->base_clock_data);
+    }
+    
+    g_hash_table_destroy(wheel->entries);
+    g_free(wheel);
+}
+
+const TimerClock* timer_wheel_get_clock(void) {
+    return &wheel_clock;
+}
+
+guint timer_wheel_get_pending_count(TimerWheel *wheel) {
+    if (!wheel) return 0;
+    return g_hash_table_size(wheel->entries);
+}
+
+guint timer_wheel_get_wakeup_count(TimerWheel *wheel) {
+    if (!wheel) return 0;
+    return wheel->wakeup_count;
+}
+
+static gint64 timer_wheel_now_us(TimerWheel *wheel) {
+    return wheel->base_clock->now_us(wheel->base_clock_data);
+}
+
+static gint64 wheel_clock_now_us(gpointer clock_data) {
+    return timer_wheel_now_us((TimerWheel*)clock_data);
+}
+
+static guint wheel_clock_add_timeout(guint interval_ms, GSourceFunc func, gpointer data, gpointer clock_data) {
+    TimerWheel *wheel = (TimerWheel*)clock_data;
+    WheelEntry *entry = g_malloc0(sizeof(WheelEntry));
+    
+    // Round the absolute expiry up so a timeout never fires before
+    // now + interval on the microsecond clock
+    gint64 target_us = timer_wheel_now_us(wheel) + (gint64)interval_ms * 1000;
+    
+    entry->id = wheel->next_id++;
+    if (wheel->next_id == 0) wheel->next_id = 1;
+    entry->expires_ms = (target_us + 999) / 1000;
+    entry->interval_ms = interval_ms;
+    entry->func = func;
+    entry->data = data;
+    
+    g_hash_table_insert(wheel->entries, GUINT_TO_POINTER(entry->id), entry);
+    timer_wheel_insert(wheel, entry);
+    timer_wheel_arm(wheel);
+    
+    return entry->id;
+}
+
+static void wheel_clock_remove_timeout(guint source_id, gpointer clock_data) {
+    TimerWheel *wheel = (TimerWheel*)clock_data;
+    WheelEntry *entry = g_hash_table_lookup(wheel->entries, GUINT_TO_POINTER(source_id));
+    
+    if (!entry) {
+        g_warning("Timer wheel has no timeout %u", source_id);
+        return;
+    }
+    
+    timer_wheel_unlink(wheel, entry);
+    g_hash_table_remove(wheel->entries, GUINT_TO_POINTER(source_id));
+    timer_wheel_arm(wheel);
+}
+
+static WheelEntry** timer_wheel_list_head(TimerWheel *wheel, WheelEntry *entry) {
+    if (entry->level == WHEEL_LIST_DUE) return &wheel->due;
+    if (entry->level == WHEEL_LIST_OVERFLOW) return &wheel->overflow;
+    return &wheel->slots[entry->level][entry->slot];
+}
+
+static void timer_wheel_insert(TimerWheel *wheel, WheelEntry *entry) {
+    if (entry->expires_ms <= wheel->current_ms) {
+        entry->level = WHEEL_LIST_DUE;
+    } else {
+        // The level is that of the highest digit where expiry and current
+        // time differ, which keeps the slot ahead of the current position
+        guint64 diff = (guint64)(entry->expires_ms ^ wheel->current_ms);
+        entry->level = 0;
+        while (entry->level < WHEEL_LEVELS && (diff >> (WHEEL_SLOT_BITS * (entry->level + 1))) != 0) {
+            entry->level++;
+        }
+        if (entry->level < WHEEL_LEVELS) {
+            entry->slot = (int)((entry->expires_ms >> (WHEEL_SLOT_BITS * entry->level)) & WHEEL_SLOT_MASK);
+            wheel->occupied[entry->level] |= G_GUINT64_CONSTANT(1) << entry->slot;
+        }
+    }
+    
+    WheelEntry **head = timer_wheel_list_head(wheel, entry);
+    entry->prev = NULL;
+    entry->next = *head;
+    if (*head) (*head)->prev = entry;
+    *head = entry;
+}
+
+static void timer_wheel_unlink(TimerWheel *wheel, WheelEntry *entry) {
+    WheelEntry **head = timer_wheel_list_head(wheel, entry);
+    
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        *head = entry->next;
+    }
+    if (entry->next) entry->next->prev = entry->prev;
+    entry->prev = entry->next = NULL;
+    
+    if (entry->level >= 0 && entry->level < WHEEL_LEVELS && !*head) {
+        wheel->occupied[entry->level] &= ~(G_GUINT64_CONSTANT(1) << entry->slot);
+    }
+}
+
+// Moves every entry of a list back through timer_wheel_insert, relative to
+// the (advanced) current time
+static void timer_wheel_cascade(TimerWheel *wheel, WheelEntry **head, int level, int slot) {
+    WheelEntry *entry = *head;
+    *head = NULL;
+    if (level >= 0 && level < WHEEL_LEVELS) {
+        wheel->occupied[level] &= ~(G_GUINT64_CONSTANT(1) << slot);
+    }
+    
+    while (entry) {
+        WheelEntry *next = entry->next;
+        timer_wheel_insert(wheel, entry);
+        entry = next;
+    }
+}
+
+static int timer_wheel_lowest_level(TimerWheel *wheel) {
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        if (wheel->occupied[level]) return level;
+    }
+    return -1;
+}
+
+static gint64 timer_wheel_list_min(WheelEntry *entry) {
+    gint64 min_ms = G_MAXINT64;
+    for (; entry; entry = entry->next) {
+        if (entry->expires_ms < min_ms) min_ms = entry->expires_ms;
+    }
+    return min_ms;
+}
+
+static gint64 timer_wheel_block_start(TimerWheel *wheel, int level, int slot) {
+    int shift = WHEEL_SLOT_BITS * level;
+    gint64 parent = wheel->current_ms >> (shift + WHEEL_SLOT_BITS);
+    return (parent << (shift + WHEEL_SLOT_BITS)) | ((gint64)slot << shift);
+}
+
+// Returns the next entry due at or before now_ms, advancing the wheel's
+// current time and cascading higher levels down as it goes. Popping one
+// entry at a time keeps callbacks free to add and remove timeouts.
+static WheelEntry* timer_wheel_pop_expired(TimerWheel *wheel, gint64 now_ms) {
+    for (;;) {
+        if (wheel->due) {
+            WheelEntry *entry = wheel->due;
+            timer_wheel_unlink(wheel, entry);
+            return entry;
+        }
+        
+        int level = timer_wheel_lowest_level(wheel);
+        if (level < 0) {
+            if (!wheel->overflow) {
+                if (now_ms > wheel->current_ms) wheel->current_ms = now_ms;
+                return NULL;
+            }
+            // Wheel drained: move time to the earliest far-future entry and
+            // bring everything that now fits back into the levels
+            gint64 min_ms = timer_wheel_list_min(wheel->overflow);
+            if (min_ms > now_ms) return NULL;
+            wheel->current_ms = min_ms;
+            timer_wheel_cascade(wheel, &wheel->overflow, WHEEL_LIST_OVERFLOW, 0);
+            continue;
+        }
+        
+        // Lower levels are empty, so the first occupied slot here holds the
+        // earliest entries of the whole wheel
+        int slot = __builtin_ctzll(wheel->occupied[level]);
+        gint64 block_start_ms = timer_wheel_block_start(wheel, level, slot);
+        if (block_start_ms > now_ms) return NULL;
+        
+        wheel->current_ms = block_start_ms;
+        timer_wheel_cascade(wheel, &wheel->slots[level][slot], level, slot);
+    }
+}
+
+static gint64 timer_wheel_next_expiry(TimerWheel *wheel) {
+    if (wheel->due) return wheel->current_ms;
+    
+    int level = timer_wheel_lowest_level(wheel);
+    if (level < 0) {
+        return timer_wheel_list_min(wheel->overflow);
+    }
+    
+    int slot = __builtin_ctzll(wheel->occupied[level]);
+    if (level == 0) {
+        return timer_wheel_block_start(wheel, 0, slot);
+    }
+    return timer_wheel_list_min(wheel->slots[level][slot]);
+}
+
+// Keeps exactly one base clock timeout armed for the earliest expiry
+static void timer_wheel_arm(TimerWheel *wheel) {
+    if (wheel->dispatching) return;
+    
+    gint64 next_ms = timer_wheel_next_expiry(wheel);
+    if (next_ms == wheel->armed_ms && (wheel->source_id > 0 || next_ms == G_MAXINT64)) {
+        return;
+    }
+    
+    if (wheel->source_id > 0) {
+        wheel->base_clock->remove_timeout(wheel->source_id, wheel->base_clock_data);
+        wheel->source_id = 0;
+    }
+    
+    wheel->armed_ms = next_ms;
+    if (next_ms == G_MAXINT64) return;
+    
+    gint64 wait_us = next_ms * 1000 - timer_wheel_now_us(wheel);
+    guint wait_ms = wait_us > 0 ? (guint)((wait_us + 999) / 1000) : 0;
+    wheel->source_id = wheel->base_clock->add_timeout(wait_ms, timer_wheel_dispatch, wheel, wheel->base_clock_data);
+}
+
+static gboolean timer_wheel_dispatch(gpointer user_data) {
+    TimerWheel *wheel = (TimerWheel*)user_data;
+    wheel->source_id = 0;
+    wheel->wakeup_count++;
+    wheel->dispatching = TRUE;
+    
+    gint64 now_ms = timer_wheel_now_us(wheel) / 1000;
+    WheelEntry *entry;
+    while ((entry = timer_wheel_pop_expired(wheel, now_ms)) != NULL) {
+        // Like a one-shot GLib source, a timeout is gone once it fires
+        g_hash_table_steal(wheel->entries, GUINT_TO_POINTER(entry->id));
+        
+        if (entry->func(entry->data) == G_SOURCE_CONTINUE) {
+            entry->expires_ms = now_ms + entry->interval_ms;
+            g_hash_table_insert(wheel->entries, GUINT_TO_POINTER(entry->id), entry);
+            timer_wheel_insert(wheel, entry);
+        } else {
+            g_free(entry);
+        }
+    }
+    
+    wheel->dispatching = FALSE;
+    wheel->armed_ms = G_MAXINT64;
+    timer_wheel_arm(wheel);
+    
+    return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,52 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <glib.h>
+#include "timer.h"
+
+G_BEGIN_DECLS
+
+typedef struct _TimerWheel TimerWheel;
+
+/**
+ * Creates a hierarchical timing wheel that multiplexes any number of timer
+ * timeouts onto a single main loop source. Only the earliest pending
+ * deadline is ever armed, so N timers cost one wakeup per distinct deadline
+ * rather than one source each.
+ * @param base_clock Clock used to read time and arm the shared source
+ *                   (NULL for the default clock); must outlive the wheel
+ * @param base_clock_data User data passed to the base clock functions
+ * @return New TimerWheel object
+ */
+TimerWheel* timer_wheel_new(const TimerClock *base_clock, gpointer base_clock_data);
+
+/**
+ * Frees a timing wheel. Timers using it must be freed first.
+ * @param wheel TimerWheel instance to free
+ */
+void timer_wheel_free(TimerWheel *wheel);
+
+/**
+ * Gets the clock interface that schedules timeouts on a wheel. Pass it to
+ * timer_new_with_clock() together with the wheel as clock_data.
+ * @return Clock interface backed by a TimerWheel
+ */
+const TimerClock* timer_wheel_get_clock(void);
+
+/**
+ * Gets the number of timeouts currently scheduled on the wheel
+ * @param wheel TimerWheel instance
+ * @return Number of pending timeouts
+ */
+guint timer_wheel_get_pending_count(TimerWheel *wheel);
+
+/**
+ * Gets the number of times the wheel's shared source has woken the main loop
+ * @param wheel TimerWheel instance
+ * @return Number of wakeups since creation
+ */
+guint timer_wheel_get_wakeup_count(TimerWheel *wheel);
+
+G_END_DECLS
+
+#endif // TIMER_WHEEL_H
@@ -1,15 +1,55 @@
 #include "tray_icon.h"
+#include "glyph_cache.h"
 #include <cairo.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+
+// Frames kept for reuse. A phase only ever moves forward, so besides the
+// current frame this mostly holds the idle and paused icons for quick
+// toggling; evicted frames hand their surface to the next render.
+#define TRAY_FRAME_CACHE_SIZE 8
+
+// Icon sizes with their own frame cache, e.g. a panel at 1x and 2x scale or
+// an XEmbed tray and a StatusNotifierItem host
+#define TRAY_SIZE_CACHE_COUNT 3
+
+// Everything that affects the rendered pixels
+typedef struct {
+    TimerState state;
+    int minutes;                 // Displayed rounded minutes, -1 if no number
+    int arc_step;                // Quantized arc length, 0 if no arc
+} TrayFrameKey;
+
+typedef struct {
+    TrayFrameKey key;
+    cairo_surface_t *surface;
+    guint64 last_used;
+    gboolean valid;
+} TrayFrame;
+
+// Frames rendered at one pixel size
+typedef struct {
+    int size;                    // 0 if unused
+    guint64 last_used;
+    TrayFrame frames[TRAY_FRAME_CACHE_SIZE];
+} TraySizeCache;
 
 struct _TrayIcon {
-    cairo_surface_t *icon_surface;
+    cairo_surface_t *icon_surface;   // Surface of the current frame (owned by frames)
     int size;
     TimerState state;
     int remaining_seconds;
     int total_seconds;
     char *tooltip_text;
+    GlyphCache *glyphs;              // Label font, resolved and rasterized once
+    
+    TraySizeCache size_caches[TRAY_SIZE_CACHE_COUNT];
+    TraySizeCache *cache;            // Cache for the current size
+    TrayFrame *current_frame;
+    guint64 use_counter;
+    guint cache_hits;
+    guint cache_misses;
 };
 
 // State colors matching Python implementation
@@ -25,18 +65,87 @@ static const StateColor state_colors[] = {
     [TIMER_STATE_PAUSED] = {0.71, 0.54, 0.0}        // Yellow
 };
 
-static void update_icon_surface(TrayIcon *self);
+static gboolean update_icon_surface(TrayIcon *self);
+static void render_frame(TrayIcon *self, cairo_surface_t *surface, const TrayFrameKey *key);
 static int get_rounded_minutes(int remaining_seconds);
 static double get_progress(int remaining_seconds, int total_seconds);
+static int get_arc_steps(int size);
+static TraySizeCache* select_size_cache(TrayIcon *self, int size);
+static void clear_size_cache(TraySizeCache *cache);
 
-static void update_icon_surface(TrayIcon *self) {
-    if (self->icon_surface) {
-        cairo_surface_destroy(self->icon_surface);
+static TrayFrameKey make_frame_key_at(TrayIcon *self, int remaining_seconds) {
+    TrayFrameKey key = {self->state, -1, 0};
+    
+    if (self->state == TIMER_STATE_IDLE || self->state == TIMER_STATE_PAUSED) {
+        return key;
     }
     
-    // Create new surface (64x64 like Python version)
-    self->icon_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, self->size, self->size);
-    cairo_t *cr = cairo_create(self->icon_surface);
+    key.minutes = get_rounded_minutes(remaining_seconds);
+    if (self->total_seconds > 0) {
+        // One step per pixel of arc length: finer steps wouldn't change
+        // the rendered footprint
+        int steps = get_arc_steps(self->size);
+        key.arc_step = (int)(get_progress(remaining_seconds, self->total_seconds) * steps);
+        key.arc_step = CLAMP(key.arc_step, 0, steps);
+    }
+    return key;
+}
+
+static TrayFrameKey make_frame_key(TrayIcon *self) {
+    return make_frame_key_at(self, self->remaining_seconds);
+}
+
+static gboolean frame_key_equal(const TrayFrameKey *a, const TrayFrameKey *b) {
+    return a->state == b->state && a->minutes == b->minutes && a->arc_step == b->arc_step;
+}
+
+// Points icon_surface at the frame for the current state, rendering only on
+// a cache miss. Returns TRUE if the visible frame changed.
+static gboolean update_icon_surface(TrayIcon *self) {
+    TrayFrameKey key = make_frame_key(self);
+    
+    if (self->current_frame && frame_key_equal(&self->current_frame->key, &key)) {
+        self->cache_hits++;
+        return FALSE;
+    }
+    
+    TrayFrame *frame = NULL;
+    TrayFrame *victim = NULL;
+    for (int i = 0; i < TRAY_FRAME_CACHE_SIZE; i++) {
+        TrayFrame *candidate = &self->cache->frames[i];
+        if (candidate->valid && frame_key_equal(&candidate->key, &key)) {
+            frame = candidate;
+            break;
+        }
+        if (!victim || !candidate->valid || (victim->valid && candidate->last_used < victim->last_used)) {
+            victim = candidate;
+        }
+    }
+    
+    if (frame) {
+        self->cache_hits++;
+    } else {
+        // Reuse the least recently used frame's surface instead of
+        // allocating a new one
+        self->cache_misses++;
+        frame = victim;
+        if (!frame->surface) {
+            frame->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, self->size, self->size);
+        }
+        render_frame(self, frame->surface, &key);
+        frame->key = key;
+        frame->valid = TRUE;
+    }
+    
+    frame->last_used = ++self->use_counter;
+    self->cache->last_used = self->use_counter;
+    self->current_frame = frame;
+    self->icon_surface = frame->surface;
+    return TRUE;
+}
+
+static void render_frame(TrayIcon *self, cairo_surface_t *surface, const TrayFrameKey *key) {
+    cairo_t *cr = cairo_create(surface);
     
     // Clear background with transparent
     cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
@@ -48,7 +157,7 @@ static void update_icon_surface(TrayIcon *self) {
     double radius = (self->size - 4) / 2.0; // Leave 2px margin
     
     // Get state color
-    StateColor color = state_colors[self->state];
+    StateColor color = state_colors[key->state];
     
     // Draw colored circle background
     cairo_set_source_rgba(cr, color.r, color.g, color.b, 1.0);
@@ -56,58 +165,48 @@ static void update_icon_surface(TrayIcon *self) {
     cairo_fill(cr);
     
     // Draw progress arc if there's remaining time
-    if (self->state != TIMER_STATE_IDLE && self->state != TIMER_STATE_PAUSED && self->total_seconds > 0) {
-        double progress = get_progress(self->remaining_seconds, self->total_seconds);
-        if (progress > 0.0) {
-            cairo_set_line_width(cr, self->size * 0.15); // 15% of icon size for border
-            
-            // Set progress arc color based on state (inverse colors)
-            if (self->state == TIMER_STATE_WORK) {
-                cairo_set_source_rgba(cr, 0.18, 0.49, 0.20, 1.0); // Green border for work (red bg)
-            } else { // Break states
-                cairo_set_source_rgba(cr, 0.86, 0.20, 0.18, 1.0); // Red border for breaks (green bg)
-            }
-            
-            // Draw arc from top, clockwise
-            double start_angle = -G_PI / 2; // Start at top (90 degrees)
-            double span_angle = progress * 2 * G_PI; // Positive for clockwise
-            
-            double margin = self->size * 0.1; // 10% margin
-            double arc_radius = (self->size - 2 * margin) / 2.0;
-            
-            cairo_arc(cr, center_x, center_y, arc_radius, start_angle, start_angle + span_angle);
-            cairo_stroke(cr);
+    if (key->arc_step > 0) {
+        // Render the quantized progress so every frame with this key is identical
+        double progress = (double)key->arc_step / get_arc_steps(self->size);
+        cairo_set_line_width(cr, self->size * 0.15); // 15% of icon size for border
+        
+        // Set progress arc color based on state (inverse colors)
+        if (key->state == TIMER_STATE_WORK) {
+            cairo_set_source_rgba(cr, 0.18, 0.49, 0.20, 1.0); // Green border for work (red bg)
+        } else { // Break states
+            cairo_set_source_rgba(cr, 0.86, 0.20, 0.18, 1.0); // Red border for breaks (green bg)
         }
+        
+        // Draw arc from top, clockwise
+        double start_angle = -G_PI / 2; // Start at top (90 degrees)
+        double span_angle = progress * 2 * G_PI; // Positive for clockwise
+        
+        double margin = self->size * 0.1; // 10% margin
+        double arc_radius = (self->size - 2 * margin) / 2.0;
+        
+        cairo_arc(cr, center_x, center_y, arc_radius, start_angle, start_angle + span_angle);
+        cairo_stroke(cr);
     }
     
     // Draw text based on state
     cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0); // White text
     
     char text[16];
-    if (self->state == TIMER_STATE_IDLE) {
+    if (key->state == TIMER_STATE_IDLE) {
         strcpy(text, "●");
-    } else if (self->state == TIMER_STATE_PAUSED) {
+    } else if (key->state == TIMER_STATE_PAUSED) {
         strcpy(text, "||");
     } else {
         // Show rounded minutes
-        int minutes = get_rounded_minutes(self->remaining_seconds);
-        snprintf(text, sizeof(text), "%d", minutes);
+        snprintf(text, sizeof(text), "%d", key->minutes);
     }
     
-    // Set font (bold, larger text for better visibility)
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, self->size * 0.4); // 40% of icon size (twice as big)
-    
-    // Center the text
-    cairo_text_extents_t extents;
-    cairo_text_extents(cr, text, &extents);
-    double text_x = center_x - (extents.width / 2.0 + extents.x_bearing);
-    double text_y = center_y - (extents.height / 2.0 + extents.y_bearing);
-    
-    cairo_move_to(cr, text_x, text_y);
-    cairo_show_text(cr, text);
+    // Bold, 40% of icon size (twice as big) for better visibility; composed
+    // from cached glyph masks and centered
+    glyph_cache_draw_centered(self->glyphs, cr, text, self->size * 0.4, center_x, center_y);
     
     cairo_destroy(cr);
+    cairo_surface_flush(surface);
 }
 
 static int get_rounded_minutes(int remaining_seconds) {
@@ -132,14 +231,52 @@ static double get_progress(int remaining_seconds, int total_seconds) {
     return (double)elapsed / (double)total_seconds;
 }
 
+static int get_arc_steps(int size) {
+    // Circumference of the arc's centre line in pixels
+    double margin = size * 0.1;
+    double arc_radius = (size - 2 * margin) / 2.0;
+    return (int)ceil(2 * G_PI * arc_radius);
+}
+
+static void clear_size_cache(TraySizeCache *cache) {
+    for (int i = 0; i < TRAY_FRAME_CACHE_SIZE; i++) {
+        if (cache->frames[i].surface) {
+            cairo_surface_destroy(cache->frames[i].surface);
+        }
+    }
+    memset(cache, 0, sizeof(TraySizeCache));
+}
+
+// Returns the cache for the given size, recycling the least recently used
+// size's cache if none matches
+static TraySizeCache* select_size_cache(TrayIcon *self, int size) {
+    TraySizeCache *victim = NULL;
+    
+    for (int i = 0; i < TRAY_SIZE_CACHE_COUNT; i++) {
+        TraySizeCache *cache = &self->size_caches[i];
+        if (cache->size == size) {
+            return cache;
+        }
+        if (!victim || cache->size == 0 || (victim->size != 0 && cache->last_used < victim->last_used)) {
+            victim = cache;
+        }
+    }
+    
+    clear_size_cache(victim);
+    victim->size = size;
+    return victim;
+}
+
 TrayIcon* tray_icon_new(void) {
     TrayIcon *self = g_malloc0(sizeof(TrayIcon));
-    self->size = 64; // Use 64x64 like Python version
+    self->size = TRAY_ICON_DEFAULT_SIZE;
+    self->cache = select_size_cache(self, self->size);
     self->state = TIMER_STATE_IDLE;
     self->remaining_seconds = 0;
     self->total_seconds = 0;
     self->icon_surface = NULL;
     self->tooltip_text = g_strdup("Commodoro Timer");
+    self->glyphs = glyph_cache_new("Sans", CAIRO_FONT_WEIGHT_BOLD);
     
     update_icon_surface(self);
     return self;
@@ -148,22 +285,75 @@ TrayIcon* tray_icon_new(void) {
 void tray_icon_free(TrayIcon *self) {
     if (!self) return;
     
-    if (self->icon_surface) {
-        cairo_surface_destroy(self->icon_surface);
+    for (int i = 0; i < TRAY_SIZE_CACHE_COUNT; i++) {
+        clear_size_cache(&self->size_caches[i]);
     }
     
+    glyph_cache_free(self->glyphs);
     g_free(self->tooltip_text);
     g_free(self);
 }
 
-void tray_icon_update(TrayIcon *self, TimerState state, int remaining_seconds, int total_seconds) {
-    if (!self) return;
+gboolean tray_icon_update(TrayIcon *self, TimerState state, int remaining_seconds, int total_seconds) {
+    if (!self) return FALSE;
     
     self->state = state;
     self->remaining_seconds = remaining_seconds;
     self->total_seconds = total_seconds;
     
-    update_icon_surface(self);
+    return update_icon_surface(self);
+}
+
+gboolean tray_icon_set_size(TrayIcon *self, int size) {
+    if (!self || size <= 0 || size == self->size) return FALSE;
+    
+    self->size = size;
+    self->cache = select_size_cache(self, size);
+    self->current_frame = NULL;
+    
+    return update_icon_surface(self);
+}
+
+int tray_icon_get_size(TrayIcon *self) {
+    if (!self) return 0;
+    
+    return self->size;
+}
+
+int tray_icon_get_seconds_until_change(TrayIcon *self) {
+    if (!self || self->remaining_seconds <= 0) return -1;
+    
+    TrayFrameKey key = make_frame_key(self);
+    if (key.minutes < 0) return -1;
+    
+    // Remaining seconds at which the next frame starts; counting down, so
+    // the larger of the two candidates comes first
+    int next = -1;
+    
+    // The rounded minutes drop once fewer than 60m - 30 seconds remain
+    if (key.minutes > 0) {
+        next = 60 * key.minutes - 31;
+    }
+    
+    // The arc reaches step s + 1 after ceil((s + 1) * total / steps)
+    // elapsed seconds. Nudge the estimate against the exact key so floating
+    // point rounding can't make it land a second early or late.
+    int steps = get_arc_steps(self->size);
+    if (self->total_seconds > 0 && key.arc_step < steps) {
+        int elapsed = (int)ceil((double)(key.arc_step + 1) * self->total_seconds / steps);
+        int arc_next = self->total_seconds - elapsed;
+        
+        while (arc_next + 1 < self->remaining_seconds &&
+               make_frame_key_at(self, arc_next + 1).arc_step != key.arc_step) {
+            arc_next++;
+        }
+        while (arc_next >= 0 && make_frame_key_at(self, arc_next).arc_step == key.arc_step) {
+            arc_next--;
+        }
+        next = MAX(next, arc_next);
+    }
+    
+    return next >= 0 ? self->remaining_seconds - next : -1;
 }
 
 void tray_icon_set_tooltip(TrayIcon *self, const char *tooltip) {
@@ -185,4 +375,9 @@ cairo_surface_t* tray_icon_get_surface(TrayIcon *self) {
     if (!self) return NULL;
     
     return self->icon_surface;
-}
\ No newline at end of file
+}
+
+void tray_icon_get_cache_stats(TrayIcon *self, guint *hits, guint *misses) {
+    if (hits) *hits = self ? self->cache_hits : 0;
+    if (misses) *misses = self ? self->cache_misses : 0;
+}
@@ -1,12 +1,15 @@
 #ifndef TRAY_ICON_H
 #define TRAY_ICON_H
 
-#include <gtk/gtk.h>
+#include <glib.h>
 #include <cairo.h>
 #include "timer.h"
 
 G_BEGIN_DECLS
 
+// Pixel size used until a tray backend reports the size it displays at
+#define TRAY_ICON_DEFAULT_SIZE 64
+
 typedef struct _TrayIcon TrayIcon;
 
 /**
@@ -27,8 +30,36 @@ void tray_icon_free(TrayIcon *self);
  * @param state Current timer state
  * @param remaining_seconds Seconds remaining in current timer
  * @param total_seconds Total seconds for current timer state
+ * @return TRUE if the rendered icon changed, FALSE if it looks the same
+ */
+gboolean tray_icon_update(TrayIcon *self, TimerState state, int remaining_seconds, int total_seconds);
+
+/**
+ * Works out how far ahead the icon will next look different: the rounded
+ * minutes label or the progress arc moving by a pixel step. Lets callers
+ * redraw exactly then instead of on every tick.
+ * @param self TrayIcon instance
+ * @return Seconds of countdown until the frame changes (relative to the last
+ *         tray_icon_update), or -1 if it won't change before the phase ends
+ */
+int tray_icon_get_seconds_until_change(TrayIcon *self);
+
+/**
+ * Sets the pixel size the icon is rendered at (the tray's icon size times
+ * its scale factor). Every size keeps its own frame cache, so switching back
+ * and forth does not re-render known frames.
+ * @param self TrayIcon instance
+ * @param size Icon width and height in device pixels
+ * @return TRUE if the current frame changed, FALSE if the size is unchanged
  */
-void tray_icon_update(TrayIcon *self, TimerState state, int remaining_seconds, int total_seconds);
+gboolean tray_icon_set_size(TrayIcon *self, int size);
+
+/**
+ * Gets the pixel size the icon is rendered at
+ * @param self TrayIcon instance
+ * @return Icon width and height in device pixels
+ */
+int tray_icon_get_size(TrayIcon *self);
 
 /**
  * Sets the tooltip text for the tray icon
@@ -51,6 +82,15 @@ gboolean tray_icon_is_embedded(TrayIcon *self);
  */
 cairo_surface_t* tray_icon_get_surface(TrayIcon *self);
 
+/**
+ * Gets frame cache statistics for profiling. A hit is an update that needed
+ * no rendering (unchanged or cached frame), a miss rendered a new frame.
+ * @param self TrayIcon instance
+ * @param hits Pointer to store the hit count (can be NULL)
+ * @param misses Pointer to store the miss count (can be NULL)
+ */
+void tray_icon_get_cache_stats(TrayIcon *self, guint *hits, guint *misses);
+
 G_END_DECLS
 
 #endif // TRAY_ICON_H
\ No newline at end of file
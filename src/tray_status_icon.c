@@ -3,18 +3,35 @@
 // GTK3-only includes - this file compiles separately with GTK3 flags
 #include <gtk/gtk.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include "pixel_convert.h"
+
+// The pixbuf handed to GtkStatusIcon is drawn from until it is given the
+// next one, so keep a few around and render into one that isn't shown
+#define TRAY_PIXBUF_POOL_SIZE 3
 
 struct _TrayStatusIcon {
     GtkStatusIcon *status_icon;
     TrayStatusIconCallback callback;
     gpointer user_data;
+    
+    GdkPixbuf *pixbuf_pool[TRAY_PIXBUF_POOL_SIZE];
+    guint pool_next;
+    int shown_slot;              // Pool slot last given to the status icon, -1 if none
+    guint64 last_hash;
+    gboolean has_last_hash;
+    
+    int pixel_size;              // Icon size reported by the tray, 0 until known
 };
 
+static int acquire_pixbuf(TrayStatusIcon *tray, int width, int height);
+
 static void on_tray_activate(GtkStatusIcon *status_icon, TrayStatusIcon *tray);
 static void on_tray_popup_menu(GtkStatusIcon *status_icon, guint button, guint activate_time, TrayStatusIcon *tray);
+static gboolean on_tray_size_changed(GtkStatusIcon *status_icon, gint size, TrayStatusIcon *tray);
 
 TrayStatusIcon* tray_status_icon_new(void) {
     TrayStatusIcon *tray = g_malloc0(sizeof(TrayStatusIcon));
+    tray->shown_slot = -1;
     
     // Create GTK3 status icon
     tray->status_icon = gtk_status_icon_new();
@@ -27,6 +44,7 @@ TrayStatusIcon* tray_status_icon_new(void) {
     // Connect signals
     g_signal_connect(tray->status_icon, "activate", G_CALLBACK(on_tray_activate), tray);
     g_signal_connect(tray->status_icon, "popup-menu", G_CALLBACK(on_tray_popup_menu), tray);
+    g_signal_connect(tray->status_icon, "size-changed", G_CALLBACK(on_tray_size_changed), tray);
     
     return tray;
 }
@@ -38,6 +56,12 @@ void tray_status_icon_free(TrayStatusIcon *tray) {
         g_object_unref(tray->status_icon);
     }
     
+    for (int i = 0; i < TRAY_PIXBUF_POOL_SIZE; i++) {
+        if (tray->pixbuf_pool[i]) {
+            g_object_unref(tray->pixbuf_pool[i]);
+        }
+    }
+    
     g_free(tray);
 }
 
@@ -49,17 +73,33 @@ void tray_status_icon_set_callback(TrayStatusIcon *tray, TrayStatusIconCallback
 }
 
 void tray_status_icon_update(TrayStatusIcon *tray, cairo_surface_t *surface, const char *tooltip) {
-    if (!tray || !surface) return;
-    
-    // Convert Cairo surface to GdkPixbuf
-    int width = cairo_image_surface_get_width(surface);
-    int height = cairo_image_surface_get_height(surface);
+    if (!tray) return;
     
-    GdkPixbuf *pixbuf = gdk_pixbuf_get_from_surface(surface, 0, 0, width, height);
-    if (pixbuf) {
-        // Update icon
-        gtk_status_icon_set_from_pixbuf(tray->status_icon, pixbuf);
-        g_object_unref(pixbuf);
+    if (surface) {
+        cairo_surface_flush(surface);
+        
+        int width = cairo_image_surface_get_width(surface);
+        int height = cairo_image_surface_get_height(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+        const guint8 *data = cairo_image_surface_get_data(surface);
+        
+        // Identical content would still make the tray repaint the icon
+        guint64 hash = pixel_hash(data, stride, width * 4, height) ^ ((guint64)width << 32 | (guint)height);
+        
+        if (data && !(tray->has_last_hash && hash == tray->last_hash)) {
+            int slot = acquire_pixbuf(tray, width, height);
+            GdkPixbuf *pixbuf = tray->pixbuf_pool[slot];
+            
+            // Un-premultiply straight into the pixbuf's pixels
+            pixel_convert_argb32_to_rgba(data, stride,
+                                         gdk_pixbuf_get_pixels(pixbuf), gdk_pixbuf_get_rowstride(pixbuf),
+                                         width, height);
+            gtk_status_icon_set_from_pixbuf(tray->status_icon, pixbuf);
+            tray->shown_slot = slot;
+            
+            tray->last_hash = hash;
+            tray->has_last_hash = TRUE;
+        }
     }
     
     // Update tooltip
@@ -74,12 +114,40 @@ void tray_status_icon_set_visible(TrayStatusIcon *tray, gboolean visible) {
     gtk_status_icon_set_visible(tray->status_icon, visible);
 }
 
+int tray_status_icon_get_pixel_size(TrayStatusIcon *tray) {
+    if (!tray) return 0;
+    
+    return tray->pixel_size;
+}
+
 gboolean tray_status_icon_is_embedded(TrayStatusIcon *tray) {
     if (!tray) return FALSE;
     
     return gtk_status_icon_is_embedded(tray->status_icon);
 }
 
+static int acquire_pixbuf(TrayStatusIcon *tray, int width, int height) {
+    // Prefer a pooled pixbuf of the right size that isn't on screen
+    for (int i = 0; i < TRAY_PIXBUF_POOL_SIZE; i++) {
+        GdkPixbuf *pixbuf = tray->pixbuf_pool[i];
+        if (pixbuf && i != tray->shown_slot &&
+            gdk_pixbuf_get_width(pixbuf) == width && gdk_pixbuf_get_height(pixbuf) == height) {
+            return i;
+        }
+    }
+    
+    // Otherwise replace slots round-robin, skipping the shown one
+    int slot = (int)tray->pool_next;
+    if (slot == tray->shown_slot) slot = (slot + 1) % TRAY_PIXBUF_POOL_SIZE;
+    tray->pool_next = (slot + 1) % TRAY_PIXBUF_POOL_SIZE;
+    
+    if (tray->pixbuf_pool[slot]) {
+        g_object_unref(tray->pixbuf_pool[slot]);
+    }
+    tray->pixbuf_pool[slot] = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+    return slot;
+}
+
 static void on_tray_activate(GtkStatusIcon *status_icon, TrayStatusIcon *tray) {
     (void)status_icon; // Suppress unused parameter warning
     
@@ -96,4 +164,20 @@ static void on_tray_popup_menu(GtkStatusIcon *status_icon, guint button, guint a
     if (tray->callback) {
         tray->callback("popup-menu", tray->user_data);
     }
+}
+
+static gboolean on_tray_size_changed(GtkStatusIcon *status_icon, gint size, TrayStatusIcon *tray) {
+    (void)status_icon; // Suppress unused parameter warning
+    
+    if (size <= 0) return FALSE;
+    
+    // GtkStatusIcon scales any pixbuf larger than this down to it, so the
+    // scale factor doesn't apply: rendering at 2x would only be thrown away
+    tray->pixel_size = size;
+    if (tray->callback) {
+        tray->callback("size-changed", tray->user_data);
+    }
+    
+    // TRUE: the icon was re-rendered for the new size, no need to scale it
+    return tray->callback != NULL;
 }
\ No newline at end of file
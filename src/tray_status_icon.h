@@ -10,7 +10,7 @@ typedef struct _TrayStatusIcon TrayStatusIcon;
 
 /**
  * Callback function for tray icon events
- * @param action Action name (e.g., "activate", "popup-menu")
+ * @param action Action name (e.g., "activate", "popup-menu", "size-changed")
  * @param user_data User data passed to callback
  */
 typedef void (*TrayStatusIconCallback)(const char *action, gpointer user_data);
@@ -36,9 +36,12 @@ void tray_status_icon_free(TrayStatusIcon *tray);
 void tray_status_icon_set_callback(TrayStatusIcon *tray, TrayStatusIconCallback callback, gpointer user_data);
 
 /**
- * Updates the tray icon with new surface and tooltip
+ * Updates the tray icon with new surface and tooltip. The surface is
+ * converted into a pooled pixbuf; content identical to the last icon set is
+ * not pushed to the tray again.
  * @param tray TrayStatusIcon instance
- * @param surface Cairo surface with rendered icon (32x32)
+ * @param surface Cairo surface with rendered icon, or NULL to only
+ *                update the tooltip
  * @param tooltip Tooltip text
  */
 void tray_status_icon_update(TrayStatusIcon *tray, cairo_surface_t *surface, const char *tooltip);
@@ -50,6 +53,14 @@ void tray_status_icon_update(TrayStatusIcon *tray, cairo_surface_t *surface, con
  */
 void tray_status_icon_set_visible(TrayStatusIcon *tray, gboolean visible);
 
+/**
+ * Gets the icon size the tray displays at. Updated before the
+ * "size-changed" action is sent to the callback.
+ * @param tray TrayStatusIcon instance
+ * @return Icon width and height in pixels, or 0 if not embedded yet
+ */
+int tray_status_icon_get_pixel_size(TrayStatusIcon *tray);
+
 /**
  * Checks if the tray icon is embedded in a system tray
  * @param tray TrayStatusIcon instance
@@ -0,0 +1,237 @@
+#define _GNU_SOURCE
+#include "wav_file.h"
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+// Canonical 44-byte header written for generated sounds
+typedef struct {
+    char riff[4];           // "RIFF"
+    guint32 size;           // File size - 8
+    char wave[4];           // "WAVE"
+    char fmt[4];            // "fmt "
+    guint32 fmt_size;       // Format chunk size (16)
+    guint16 format;         // Audio format (1 = PCM)
+    guint16 channels;       // Number of channels
+    guint32 sample_rate;    // Sample rate
+    guint32 byte_rate;      // Bytes per second
+    guint16 block_align;    // Bytes per sample * channels
+    guint16 bits_per_sample; // Bits per sample
+    char data[4];           // "data"
+    guint32 data_size;      // Data size
+} WavHeader;
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_EXTENSIBLE 0xfffe
+
+// The RIFF size fields are 32-bit
+#define WAV_MAX_DATA_SIZE (G_MAXUINT32 - sizeof(WavHeader))
+
+struct _WavWriter {
+    FILE *file;
+    char *path;
+    char *temp_path;
+    unsigned int rate;
+    int channels;
+    gsize data_size;
+    gboolean failed;
+};
+
+static void fill_header(WavHeader *header, unsigned int rate, int channels, gsize data_size);
+
+static guint16 read_le16(const guint8 *p) {
+    return (guint16)(p[0] | (p[1] << 8));
+}
+
+static guint32 read_le32(const guint8 *p) {
+    return (guint32)p[0] | ((guint32)p[1] << 8) | ((guint32)p[2] << 16) | ((guint32)p[3] << 24);
+}
+
+gboolean wav_file_parse(const guint8 *data, gsize size, WavFormat *format, gsize *data_offset, gsize *data_size) {
+    if (!data || size < 12) return FALSE;
+    if (memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return FALSE;
+    
+    gboolean have_format = FALSE;
+    gsize pos = 12;
+    
+    while (pos + 8 <= size) {
+        const guint8 *chunk = data + pos;
+        guint32 chunk_size = read_le32(chunk + 4);
+        gsize body = pos + 8;
+        
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (chunk_size < 16 || body + 16 > size) return FALSE;
+            
+            guint16 tag = read_le16(data + body);
+            // Extensible headers carry the real tag in the sub-format GUID
+            if (tag == WAV_FORMAT_EXTENSIBLE && chunk_size >= 40 && body + 40 <= size) {
+                tag = read_le16(data + body + 24);
+            }
+            if (tag != WAV_FORMAT_PCM) return FALSE;
+            
+            format->channels = read_le16(data + body + 2);
+            format->rate = read_le32(data + body + 4);
+            format->bits = read_le16(data + body + 14);
+            if (format->channels <= 0 || format->rate == 0 || format->bits <= 0) return FALSE;
+            have_format = TRUE;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) return FALSE;
+            
+            // Streaming writers leave the size at 0 or 0xffffffff
+            gsize available = size - body;
+            *data_offset = body;
+            *data_size = (chunk_size == 0 || chunk_size > available) ? available : chunk_size;
+            return TRUE;
+        }
+        
+        // Chunks are padded to an even size
+        pos = body + chunk_size + (chunk_size & 1);
+    }
+    
+    return FALSE;
+}
+
+GBytes* wav_file_map(const char *path, WavFormat *format) {
+    if (!path || !format) return NULL;
+    
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+    if (!mapped) return NULL;
+    
+    const guint8 *data = (const guint8*)g_mapped_file_get_contents(mapped);
+    gsize size = g_mapped_file_get_length(mapped);
+    gsize offset = 0, length = 0;
+    
+    if (!wav_file_parse(data, size, format, &offset, &length)) {
+        g_warning("Not a PCM WAV file: %s", path);
+        g_mapped_file_unref(mapped);
+        return NULL;
+    }
+    
+    // Whole frames only
+    gsize frame_size = (gsize)format->channels * ((format->bits + 7) / 8);
+    length -= length % frame_size;
+    
+    // The bytes own the mapping
+    return g_bytes_new_with_free_func(data + offset, length, (GDestroyNotify)g_mapped_file_unref, mapped);
+}
+
+gboolean wav_file_write(const char *path, const gint16 *samples, gsize frames, unsigned int rate, int channels) {
+    gsize data_size = frames * channels * sizeof(gint16);
+    gchar *contents = g_malloc(sizeof(WavHeader) + data_size);
+    
+    WavHeader header;
+    fill_header(&header, rate, channels, data_size);
+    
+    memcpy(contents, &header, sizeof(WavHeader));
+    memcpy(contents + sizeof(WavHeader), samples, data_size);
+    
+    // Written to a temporary file and renamed into place
+    GError *error = NULL;
+    gboolean ok = g_file_set_contents(path, contents, sizeof(WavHeader) + data_size, &error);
+    if (!ok) {
+        g_warning("Failed to create WAV file %s: %s", path, error->message);
+        g_error_free(error);
+    }
+    
+    g_free(contents);
+    return ok;
+}
+
+WavWriter* wav_writer_new(const char *path, unsigned int rate, int channels) {
+    if (!path) return NULL;
+    
+    char *temp_path = g_strdup_printf("%s.XXXXXX", path);
+    int fd = g_mkstemp(temp_path);
+    if (fd < 0) {
+        g_warning("Failed to create WAV file %s: %s", path, g_strerror(errno));
+        g_free(temp_path);
+        return NULL;
+    }
+    
+    WavWriter *writer = g_malloc0(sizeof(WavWriter));
+    writer->file = fdopen(fd, "wb");
+    writer->path = g_strdup(path);
+    writer->temp_path = temp_path;
+    writer->rate = rate;
+    writer->channels = channels;
+    
+    // Placeholder header, completed once the data size is known
+    WavHeader header;
+    fill_header(&header, rate, channels, 0);
+    if (!writer->file || fwrite(&header, sizeof(header), 1, writer->file) != 1) {
+        if (!writer->file) close(fd);
+        writer->failed = TRUE;
+    }
+    
+    return writer;
+}
+
+gboolean wav_writer_write(WavWriter *writer, const gint16 *samples, gsize frames) {
+    if (!writer || writer->failed) return FALSE;
+    
+    gsize size = frames * writer->channels * sizeof(gint16);
+    if (size > WAV_MAX_DATA_SIZE - writer->data_size ||
+        fwrite(samples, 1, size, writer->file) != size) {
+        writer->failed = TRUE;
+        return FALSE;
+    }
+    
+    writer->data_size += size;
+    return TRUE;
+}
+
+gboolean wav_writer_finish(WavWriter *writer) {
+    if (!writer) return FALSE;
+    
+    WavHeader header;
+    fill_header(&header, writer->rate, writer->channels, writer->data_size);
+    
+    gboolean ok = !writer->failed &&
+                  fseek(writer->file, 0, SEEK_SET) == 0 &&
+                  fwrite(&header, sizeof(header), 1, writer->file) == 1 &&
+                  fflush(writer->file) == 0 &&
+                  fsync(fileno(writer->file)) == 0;
+    
+    if (writer->file && fclose(writer->file) != 0) ok = FALSE;
+    writer->file = NULL;
+    
+    // Readers see either the old file or the complete new one
+    if (ok && g_rename(writer->temp_path, writer->path) != 0) ok = FALSE;
+    if (!ok) {
+        g_warning("Failed to write WAV file %s", writer->path);
+        g_unlink(writer->temp_path);
+    }
+    
+    g_free(writer->path);
+    g_free(writer->temp_path);
+    g_free(writer);
+    return ok;
+}
+
+void wav_writer_abort(WavWriter *writer) {
+    if (!writer) return;
+    
+    if (writer->file) fclose(writer->file);
+    g_unlink(writer->temp_path);
+    g_free(writer->path);
+    g_free(writer->temp_path);
+    g_free(writer);
+}
+
+static void fill_header(WavHeader *header, unsigned int rate, int channels, gsize data_size) {
+    memcpy(header->riff, "RIFF", 4);
+    header->size = GUINT32_TO_LE(36 + data_size);
+    memcpy(header->wave, "WAVE", 4);
+    memcpy(header->fmt, "fmt ", 4);
+    header->fmt_size = GUINT32_TO_LE(16);
+    header->format = GUINT16_TO_LE(WAV_FORMAT_PCM);
+    header->channels = GUINT16_TO_LE(channels);
+    header->sample_rate = GUINT32_TO_LE(rate);
+    header->bits_per_sample = GUINT16_TO_LE(16);
+    header->byte_rate = GUINT32_TO_LE(rate * channels * sizeof(gint16));
+    header->block_align = GUINT16_TO_LE(channels * sizeof(gint16));
+    memcpy(header->data, "data", 4);
+    header->data_size = GUINT32_TO_LE(data_size);
+}
@@ -0,0 +1,84 @@
+#ifndef WAV_FILE_H
+#define WAV_FILE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct {
+    unsigned int rate;           // Frames per second
+    int channels;
+    int bits;                    // Bits per sample
+} WavFormat;
+
+/**
+ * Locates the PCM data in a RIFF/WAVE image, skipping chunks other than
+ * "fmt " and "data". Accepts plain and extensible integer PCM.
+ * @param data File contents
+ * @param size Size of data in bytes
+ * @param format Filled with the sample format
+ * @param data_offset Filled with the offset of the first sample
+ * @param data_size Filled with the size of the sample data (clamped to the file)
+ * @return TRUE if the image is integer PCM WAV, FALSE otherwise
+ */
+gboolean wav_file_parse(const guint8 *data, gsize size, WavFormat *format, gsize *data_offset, gsize *data_size);
+
+/**
+ * Maps a WAV file and returns its sample data without copying. The mapping
+ * stays alive as long as the returned bytes.
+ * @param path File to map
+ * @param format Filled with the sample format
+ * @return Sample data, or NULL if the file can't be mapped or isn't PCM WAV
+ */
+GBytes* wav_file_map(const char *path, WavFormat *format);
+
+/**
+ * Writes samples as a 16-bit PCM WAV file. The file is written under a
+ * temporary name and renamed, so readers never map a partial file.
+ * @param path Destination file
+ * @param samples Interleaved signed 16-bit samples
+ * @param frames Number of frames
+ * @param rate Sample rate in Hz
+ * @param channels Number of channels
+ * @return TRUE on success
+ */
+gboolean wav_file_write(const char *path, const gint16 *samples, gsize frames, unsigned int rate, int channels);
+
+typedef struct _WavWriter WavWriter;
+
+/**
+ * Starts writing a 16-bit PCM WAV file incrementally, for sounds too long to
+ * hold in memory. Like wav_file_write, the data goes to a temporary file
+ * that only replaces path once wav_writer_finish succeeds.
+ * @param path Destination file
+ * @param rate Sample rate in Hz
+ * @param channels Number of channels
+ * @return New WavWriter instance, or NULL if the file can't be created
+ */
+WavWriter* wav_writer_new(const char *path, unsigned int rate, int channels);
+
+/**
+ * Appends samples
+ * @param writer WavWriter instance
+ * @param samples Interleaved signed 16-bit samples
+ * @param frames Number of frames
+ * @return TRUE on success
+ */
+gboolean wav_writer_write(WavWriter *writer, const gint16 *samples, gsize frames);
+
+/**
+ * Completes the header, moves the file into place and frees the writer
+ * @param writer WavWriter instance
+ * @return TRUE if the file was written
+ */
+gboolean wav_writer_finish(WavWriter *writer);
+
+/**
+ * Removes the partial file and frees the writer
+ * @param writer WavWriter instance
+ */
+void wav_writer_abort(WavWriter *writer);
+
+G_END_DECLS
+
+#endif // WAV_FILE_H
@@ -0,0 +1,13 @@
+#!/bin/bash
+
+echo "Testing the StatusNotifierItem tray on a private session bus..."
+echo "1. A stub StatusNotifierWatcher takes the watcher name"
+echo "2. Commodoro registers its tray item and publishes IconPixmap"
+echo "3. After 30s the watcher reports NewIcon signals and pixmap fetches"
+echo "   (expect roughly one distinct icon per arc step, not one per second)"
+echo ""
+
+make build/sni_watcher || exit 1
+
+# Run with test intervals: 20s work, 5s break
+dbus-run-session -- bash -c './build/sni_watcher 30 & watcher=$!; sleep 1; timeout 28 ./commodoro 20s 5s 2 10s; wait $watcher'